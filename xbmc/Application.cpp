@@ -43,6 +43,7 @@
 #include "guilib/GUIFontManager.h"
 #include "guilib/GUIColorManager.h"
 #include "guilib/GUITextLayout.h"
+#include "utils/StartupTasks.h"
 #include "addons/Skin.h"
 #ifdef HAS_PYTHON
 #include "interfaces/python/XBPython.h"
@@ -335,6 +336,38 @@ using namespace XbmcThreads;
 
 #define MAX_FFWD_SPEED 5
 
+// stages of the startup and skin loading that run on the job manager
+class CAddonScanJob : public CJob
+{
+public:
+  virtual bool DoWork() { return CAddonMgr::Get().Init(); }
+};
+
+class CSkinIncludesJob : public CJob
+{
+public:
+  CSkinIncludesJob(const SkinPtr &skin) : m_skin(skin) {}
+  virtual bool DoWork() { m_skin->LoadIncludes(); return true; }
+private:
+  SkinPtr m_skin;
+};
+
+class CSkinStringsJob : public CJob
+{
+public:
+  CSkinStringsJob(const CStdString &path, const CStdString &fallbackPath) : m_path(path), m_fallbackPath(fallbackPath) {}
+  virtual bool DoWork() { return g_localizeStrings.LoadSkinStrings(m_path, m_fallbackPath); }
+private:
+  CStdString m_path;
+  CStdString m_fallbackPath;
+};
+
+class CTextureBundlesJob : public CJob
+{
+public:
+  virtual bool DoWork() { g_TextureManager.OpenBundles(); return true; }
+};
+
 //extern IDirectSoundRenderer* m_pAudioDecoder;
 CApplication::CApplication(void) : m_itemCurrentFile(new CFileItem), m_progressTrackingItem(new CFileItem)
 {
@@ -636,10 +669,12 @@ bool CApplication::Create()
 
   CLog::Log(LOGNOTICE, "load settings...");
 
+  CStartupTasks::Get().BeginSpan("settings");
   g_guiSettings.Initialize();  // Initialize default Settings - don't move
   g_powerManager.SetDefaults();
   if (!g_settings.Load())
     FatalErrorHandler(true, true, true);
+  CStartupTasks::Get().EndSpan("settings");
 
   CLog::Log(LOGINFO, "creating subdirectories");
   CLog::Log(LOGINFO, "userdata folder: %s", g_settings.GetProfileUserDataFolder().c_str());
@@ -664,20 +699,19 @@ bool CApplication::Create()
   CLog::Log(LOGINFO, "load language info file: %s", strLangInfoPath.c_str());
   g_langInfo.Load(strLangInfoPath);
 
+  // start-up Addons Framework
+  // the addon scan only needs the settings and language info, so it runs while
+  // the strings are loaded and the window is created.  Initialize() waits for it.
+  CStartupTasks::Get().Run("addons", new CAddonScanJob);
+
   CStdString strLanguagePath;
   strLanguagePath.Format("special://xbmc/language/%s/strings.xml", strLanguage.c_str());
 
   CLog::Log(LOGINFO, "load language file:%s", strLanguagePath.c_str());
+  CStartupTasks::Get().BeginSpan("strings");
   if (!g_localizeStrings.Load(strLanguagePath))
     FatalErrorHandler(false, false, true);
-
-  // start-up Addons Framework
-  // currently bails out if either cpluff Dll is unavailable or system dir can not be scanned
-  if (!CAddonMgr::Get().Init())
-  {
-    CLog::Log(LOGFATAL, "CApplication::Create: Unable to start CAddonMgr");
-    FatalErrorHandler(true, true, true);
-  }
+  CStartupTasks::Get().EndSpan("strings");
 
   // Create the Mouse, Keyboard, Remote, and Joystick devices
   // Initialize after loading settings to get joystick deadzone setting
@@ -697,6 +731,8 @@ bool CApplication::Create()
   XBMCHelper::GetInstance().Configure();
 #endif
 
+  CStartupTasks::Get().BeginSpan("window");
+
   // update the window resolution
   g_Windowing.SetWindowResolution(g_guiSettings.GetInt("window.width"), g_guiSettings.GetInt("window.height"));
 
@@ -768,9 +804,18 @@ bool CApplication::Create()
 
   g_mediaManager.Initialize();
 
+  CStartupTasks::Get().EndSpan("window");
+
   m_lastFrameTime = XbmcThreads::SystemClockMillis();
   m_lastRenderTime = m_lastFrameTime;
 
+  // currently bails out if either cpluff Dll is unavailable or system dir can not be scanned
+  if (!CStartupTasks::Get().Wait("addons"))
+  {
+    CLog::Log(LOGFATAL, "CApplication::Create: Unable to start CAddonMgr");
+    FatalErrorHandler(true, true, true);
+  }
+
   return Initialize();
 }
 
@@ -1063,7 +1108,9 @@ bool CApplication::Initialize()
     CDirectory::Create("special://xbmc/sounds");
   }
 
+  CStartupTasks::Get().BeginSpan("services");
   StartServices();
+  CStartupTasks::Get().EndSpan("services");
 
   // Init DPMS, before creating the corresponding setting control.
   m_dpms = new DPMSSupport();
@@ -1180,11 +1227,13 @@ bool CApplication::Initialize()
   /* window id's 3000 - 3100 are reserved for python */
 
   // Make sure we have at least the default skin
+  CStartupTasks::Get().BeginSpan("skin");
   if (!LoadSkin(g_guiSettings.GetString("lookandfeel.skin")) && !LoadSkin(DEFAULT_SKIN))
   {
       CLog::Log(LOGERROR, "Default skin '%s' not found! Terminating..", DEFAULT_SKIN);
       FatalErrorHandler(true, true, true);
   }
+  CStartupTasks::Get().EndSpan("skin");
 
   StartEPGManager();
   StartPVRManager();
@@ -1242,6 +1291,7 @@ bool CApplication::Initialize()
   CAddonMgr::Get().StartServices(false);
 
   CLog::Log(LOGNOTICE, "initialize done");
+  CStartupTasks::Get().Dump();
 
   m_bInitializing = false;
 
@@ -1695,11 +1745,33 @@ void CApplication::LoadSkin(const SkinPtr& skin)
 
   CLog::Log(LOGINFO, "  load skin from:%s", skin->Path().c_str());
   g_SkinInfo = skin;
-  g_SkinInfo->Start();
-
-  CLog::Log(LOGINFO, "  load fonts for skin...");
+  g_SkinInfo->Start("", false);
   g_graphicsContext.SetMediaDir(skin->Path());
   g_directoryCache.ClearSubPaths(skin->Path());
+
+  // the includes, the skin strings and the texture bundles are independent of
+  // the fonts and colors, so they are loaded concurrently at startup.  All of
+  // them are needed before the first window is loaded below.  On a reload the
+  // job manager's workers may be busy with jobs that need the graphics lock we
+  // hold, so the stages are run right here instead.
+  bool background = m_bInitializing;
+  CStartupTasks::Get().Run("skin includes", new CSkinIncludesJob(skin), background);
+  CStartupTasks::Get().Run("skin textures", new CTextureBundlesJob, background);
+
+  // load in the skin strings
+  CStdString langPath, skinEnglishPath;
+  URIUtils::AddFileToFolder(skin->Path(), "language", langPath);
+  URIUtils::AddFileToFolder(langPath, g_guiSettings.GetString("locale.language"), langPath);
+  URIUtils::AddFileToFolder(langPath, "strings.xml", langPath);
+
+  URIUtils::AddFileToFolder(skin->Path(), "language", skinEnglishPath);
+  URIUtils::AddFileToFolder(skinEnglishPath, "English", skinEnglishPath);
+  URIUtils::AddFileToFolder(skinEnglishPath, "strings.xml", skinEnglishPath);
+
+  CStartupTasks::Get().Run("skin strings", new CSkinStringsJob(langPath, skinEnglishPath), background);
+
+  CLog::Log(LOGINFO, "  load fonts for skin...");
+  CStartupTasks::Get().BeginSpan("skin fonts");
   if (g_langInfo.ForceUnicodeFont() && !g_fontManager.IsFontSetUnicode(g_guiSettings.GetString("lookandfeel.font")))
   {
     CLog::Log(LOGINFO, "    language needs a ttf font, loading first ttf font available");
@@ -1716,18 +1788,11 @@ void CApplication::LoadSkin(const SkinPtr& skin)
   g_colorManager.Load(g_guiSettings.GetString("lookandfeel.skincolors"));
 
   g_fontManager.LoadFonts(g_guiSettings.GetString("lookandfeel.font"));
+  CStartupTasks::Get().EndSpan("skin fonts");
 
-  // load in the skin strings
-  CStdString langPath, skinEnglishPath;
-  URIUtils::AddFileToFolder(skin->Path(), "language", langPath);
-  URIUtils::AddFileToFolder(langPath, g_guiSettings.GetString("locale.language"), langPath);
-  URIUtils::AddFileToFolder(langPath, "strings.xml", langPath);
-
-  URIUtils::AddFileToFolder(skin->Path(), "language", skinEnglishPath);
-  URIUtils::AddFileToFolder(skinEnglishPath, "English", skinEnglishPath);
-  URIUtils::AddFileToFolder(skinEnglishPath, "strings.xml", skinEnglishPath);
-
-  g_localizeStrings.LoadSkinStrings(langPath, skinEnglishPath);
+  CStartupTasks::Get().Wait("skin includes");
+  CStartupTasks::Get().Wait("skin textures");
+  CStartupTasks::Get().Wait("skin strings");
 
   int64_t start;
   start = CurrentHostCounter();
@@ -1777,6 +1842,8 @@ void CApplication::LoadSkin(const SkinPtr& skin)
   }
 
   CLog::Log(LOGINFO, "  skin loaded...");
+  if (!m_bInitializing)
+    CStartupTasks::Get().Dump();
 
   // leave the graphics lock
   lock.Leave();
@@ -3336,11 +3403,16 @@ void CApplication::Stop(int exitCode)
     if (videoScan)
       videoScan->StopScanning();
 
+#ifdef HAVE_INOTIFY
+    m_fileStateWatcher.Stop();
+#endif
+
     m_applicationMessenger.Cleanup();
 
     StopPVRManager();
     StopEPGManager();
     StopServices();
+    CAnnouncementManager::Deinitialize();
     //Sleep(5000);
 
 #if defined(__APPLE__) && !defined(__arm__)
@@ -4599,6 +4671,15 @@ bool CApplication::OnMessage(CGUIMessage& message)
       }
       return true;
     }
+
+  case GUI_MSG_PREFETCH_NEXT_ITEM:
+    {
+      int iNext = g_playlistPlayer.GetNextSong();
+      CPlayList& playlist = g_playlistPlayer.GetPlaylist(g_playlistPlayer.GetCurrentPlaylist());
+      if (m_pPlayer && iNext >= 0 && iNext < playlist.size())
+        m_pPlayer->PrefetchNextFile(*playlist[iNext]);
+      return true;
+    }
     break;
 
   case GUI_MSG_PLAYBACK_STOPPED:
@@ -4867,6 +4948,23 @@ void CApplication::ProcessSlow()
   if(CUPnP::IsInstantiated())
     CUPnP::GetInstance()->UpdateState();
 
+#ifdef HAVE_INOTIFY
+  // update libraries for local sources that changed on disk
+  CStdString changedPath;
+  CGUIDialogVideoScan *videoScan = (CGUIDialogVideoScan *)g_windowManager.GetWindow(WINDOW_DIALOG_VIDEO_SCAN);
+  if (videoScan && !videoScan->IsScanning() && m_fileStateWatcher.GetNextChange(true, changedPath))
+  {
+    CLog::Log(LOGDEBUG, "%s - Updating video library for changed path %s", __FUNCTION__, changedPath.c_str());
+    videoScan->StartScanning(changedPath);
+  }
+  CGUIDialogMusicScan *musicScan = (CGUIDialogMusicScan *)g_windowManager.GetWindow(WINDOW_DIALOG_MUSIC_SCAN);
+  if (musicScan && !musicScan->IsScanning() && m_fileStateWatcher.GetNextChange(false, changedPath))
+  {
+    CLog::Log(LOGDEBUG, "%s - Updating music library for changed path %s", __FUNCTION__, changedPath.c_str());
+    musicScan->StartScanning(changedPath);
+  }
+#endif
+
   //Check to see if current playing Title has changed and whether we should broadcast the fact
   CheckForTitleChange();
 
@@ -5324,6 +5422,11 @@ void CApplication::RestoreMusicScanSettings()
 
 void CApplication::UpdateLibraries()
 {
+#ifdef HAVE_INOTIFY
+  if (g_advancedSettings.m_bFileStateIndex && g_advancedSettings.m_bFileStateWatchLocal)
+    m_fileStateWatcher.Start();
+#endif
+
   if (g_guiSettings.GetBool("videolibrary.updateonstartup"))
   {
     CLog::Log(LOGNOTICE, "%s - Starting video library startup scan", __FUNCTION__);
@@ -62,6 +62,9 @@ namespace ADDON
 #ifdef HAS_WEB_SERVER
 #include "network/WebServer.h"
 #endif
+#ifdef HAVE_INOTIFY
+#include "linux/FileStateWatcher.h"
+#endif
 
 class CKaraokeLyricsManager;
 class CInertialScrollingHandler;
@@ -228,6 +231,10 @@ public:
   CWebServer m_WebServer;
 #endif
 
+#ifdef HAVE_INOTIFY
+  CFileStateWatcher m_fileStateWatcher;
+#endif
+
   IPlayer* m_pPlayer;
 
   inline bool IsInScreenSaver() { return m_bScreenSave; };
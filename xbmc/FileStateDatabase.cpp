@@ -0,0 +1,268 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "FileStateDatabase.h"
+#include "FileItem.h"
+#include "filesystem/File.h"
+#include "filesystem/Directory.h"
+#include "utils/log.h"
+#include "utils/Crc32.h"
+#include "utils/URIUtils.h"
+#include "dbwrappers/dataset.h"
+
+using namespace XFILE;
+
+// directory stamps this close to the time of listing are not trusted
+#define FILESTATE_RACY_SECONDS 2
+
+// options stored alongside a listing
+#define FILESTATE_OPTION_FILEDIRECTORIES 1
+
+CFileStateDatabase::CFileStateDatabase()
+{
+}
+
+CFileStateDatabase::~CFileStateDatabase()
+{
+}
+
+bool CFileStateDatabase::Open()
+{
+  return CDatabase::Open();
+}
+
+bool CFileStateDatabase::CreateTables()
+{
+  try
+  {
+    CDatabase::CreateTables();
+
+    CLog::Log(LOGINFO, "create dirstate table");
+    m_pDS->exec("CREATE TABLE dirstate (idDir integer primary key, pathhash integer, strPath text, strMask text, options integer, mtime integer, inode integer)\n");
+
+    CLog::Log(LOGINFO, "create dirstate index");
+    m_pDS->exec("CREATE INDEX idxDirState ON dirstate(pathhash)");
+
+    CLog::Log(LOGINFO, "create filestate table");
+    m_pDS->exec("CREATE TABLE filestate (idFile integer primary key, idDir integer, strPath text, strLabel text, isFolder bool, size integer, filetime integer)\n");
+
+    CLog::Log(LOGINFO, "create filestate index");
+    m_pDS->exec("CREATE INDEX idxFileState ON filestate(idDir)");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s unable to create tables", __FUNCTION__);
+    return false;
+  }
+
+  return true;
+}
+
+bool CFileStateDatabase::UpdateOldVersion(int version)
+{
+  return true;
+}
+
+bool CFileStateDatabase::GetDirectoryStamp(const CStdString &path, int64_t &mtime, int64_t &inode)
+{
+  struct __stat64 buffer;
+  if (CFile::Stat(path, &buffer) != 0)
+    return false;
+
+  mtime = buffer.st_mtime;
+  if (!mtime)
+    mtime = buffer.st_ctime;
+  inode = buffer.st_ino;
+  return mtime != 0;
+}
+
+bool CFileStateDatabase::GetDirectory(const CStdString &path, CFileItemList &items, const CStdString &mask, bool useFileDirectories)
+{
+  int options = useFileDirectories ? FILESTATE_OPTION_FILEDIRECTORIES : 0;
+  int64_t mtime = 0, inode = 0;
+  bool haveStamp = NULL != m_pDB.get() && GetDirectoryStamp(path, mtime, inode);
+
+  if (haveStamp && GetIndexedDirectory(path, mask, options, mtime, inode, items))
+    return true;
+
+  if (!CDirectory::GetDirectory(path, items, mask, useFileDirectories))
+    return false;
+
+  if (haveStamp && (int64_t)time(NULL) - mtime > FILESTATE_RACY_SECONDS)
+    SetIndexedDirectory(path, mask, options, mtime, inode, items);
+  else if (haveStamp)
+    InvalidatePath(path);
+
+  return true;
+}
+
+void CFileStateDatabase::GetRecursiveListing(const CStdString &path, CFileItemList &items, const CStdString &mask, bool useFileDirectories)
+{
+  CFileItemList myItems;
+  GetDirectory(path, myItems, mask, useFileDirectories);
+  for (int i = 0; i < myItems.Size(); ++i)
+  {
+    if (myItems[i]->m_bIsFolder)
+      GetRecursiveListing(myItems[i]->GetPath(), items, mask, useFileDirectories);
+    else
+      items.Add(myItems[i]);
+  }
+}
+
+bool CFileStateDatabase::GetIndexedDirectory(const CStdString &path, const CStdString &mask, int options, int64_t mtime, int64_t inode, CFileItemList &items)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString sql = PrepareSQL("select idDir, mtime, inode from dirstate where pathhash=%u and strPath='%s' and strMask='%s' and options=%i",
+                                GetPathHash(path), path.c_str(), mask.c_str(), options);
+    m_pDS->query(sql.c_str());
+    if (m_pDS->eof())
+    {
+      m_pDS->close();
+      return false;
+    }
+
+    int idDir = m_pDS->fv(0).get_asInt();
+    bool unchanged = m_pDS->fv(1).get_asInt64() == mtime && m_pDS->fv(2).get_asInt64() == inode;
+    m_pDS->close();
+    if (!unchanged)
+      return false;
+
+    sql = PrepareSQL("select strPath, strLabel, isFolder, size, filetime from filestate where idDir=%i order by idFile", idDir);
+    m_pDS->query(sql.c_str());
+    while (!m_pDS->eof())
+    {
+      CFileItemPtr item(new CFileItem(m_pDS->fv(1).get_asString()));
+      item->SetPath(m_pDS->fv(0).get_asString());
+      item->m_bIsFolder = m_pDS->fv(2).get_asBool();
+      item->m_dwSize = m_pDS->fv(3).get_asInt64();
+
+      ULARGE_INTEGER time;
+      time.QuadPart = (uint64_t)m_pDS->fv(4).get_asInt64();
+      if (time.QuadPart)
+      {
+        FILETIME fileTime;
+        fileTime.dwLowDateTime = time.u.LowPart;
+        fileTime.dwHighDateTime = time.u.HighPart;
+        item->m_dateTime = fileTime;
+      }
+      items.Add(item);
+      m_pDS->next();
+    }
+    m_pDS->close();
+    items.SetPath(path);
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on path '%s'", __FUNCTION__, path.c_str());
+  }
+  items.Clear();
+  return false;
+}
+
+void CFileStateDatabase::SetIndexedDirectory(const CStdString &path, const CStdString &mask, int options, int64_t mtime, int64_t inode, const CFileItemList &items)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    unsigned int hash = GetPathHash(path);
+
+    BeginTransaction();
+    CStdString sql = PrepareSQL("select idDir from dirstate where pathhash=%u and strPath='%s' and strMask='%s' and options=%i",
+                                hash, path.c_str(), mask.c_str(), options);
+    m_pDS->query(sql.c_str());
+    int idDir = -1;
+    if (!m_pDS->eof())
+      idDir = m_pDS->fv(0).get_asInt();
+    m_pDS->close();
+
+    if (idDir >= 0)
+    {
+      m_pDS->exec(PrepareSQL("delete from filestate where idDir=%i", idDir).c_str());
+      m_pDS->exec(PrepareSQL("update dirstate set mtime=%I64d, inode=%I64d where idDir=%i", mtime, inode, idDir).c_str());
+    }
+    else
+    {
+      m_pDS->exec(PrepareSQL("insert into dirstate (idDir, pathhash, strPath, strMask, options, mtime, inode) values(NULL, %u, '%s', '%s', %i, %I64d, %I64d)",
+                             hash, path.c_str(), mask.c_str(), options, mtime, inode).c_str());
+      idDir = (int)m_pDS->lastinsertid();
+    }
+
+    for (int i = 0; i < items.Size(); ++i)
+    {
+      const CFileItemPtr item = items[i];
+      FILETIME fileTime = item->m_dateTime;
+      ULARGE_INTEGER time;
+      time.u.LowPart = fileTime.dwLowDateTime;
+      time.u.HighPart = fileTime.dwHighDateTime;
+      QueueInsertQuery(PrepareSQL("insert into filestate (idFile, idDir, strPath, strLabel, isFolder, size, filetime) values(NULL, %i, '%s', '%s', %i, %I64d, %I64d)",
+                                  idDir, item->GetPath().c_str(), item->GetLabel().c_str(), item->m_bIsFolder ? 1 : 0, item->m_dwSize, (int64_t)time.QuadPart));
+    }
+    CommitInsertQueries();
+    CommitTransaction();
+  }
+  catch (...)
+  {
+    RollbackTransaction();
+    CLog::Log(LOGERROR, "%s failed on path '%s'", __FUNCTION__, path.c_str());
+  }
+}
+
+void CFileStateDatabase::InvalidatePath(const CStdString &path, bool recursive)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    CStdString where;
+    if (recursive)
+    { // wildcards in the path itself must match literally
+      CStdString pattern(path);
+      pattern.Replace("!", "!!");
+      pattern.Replace("%", "!%");
+      pattern.Replace("_", "!_");
+      where = PrepareSQL("strPath like '%s%%' escape '!'", pattern.c_str());
+    }
+    else
+      where = PrepareSQL("pathhash=%u and strPath='%s'", GetPathHash(path), path.c_str());
+
+    m_pDS->exec(("delete from filestate where idDir in (select idDir from dirstate where " + where + ")").c_str());
+    m_pDS->exec(("delete from dirstate where " + where).c_str());
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on path '%s'", __FUNCTION__, path.c_str());
+  }
+}
+
+unsigned int CFileStateDatabase::GetPathHash(const CStdString &path) const
+{
+  Crc32 crc;
+  crc.Compute(path);
+  return (unsigned int)crc;
+}
@@ -0,0 +1,88 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "dbwrappers/Database.h"
+
+class CFileItemList;
+
+/*! \brief Persistent index of directory listings used by the library scanners
+ Each listed directory is stored together with the modification time and inode
+ of the directory itself, and the path, size and date of every entry.  As long
+ as the directory stamp is unchanged the listing is served from the index, so an
+ update cycle on an unchanged library only needs a stat() per directory instead
+ of a full listing.  Stamps within a couple of seconds of the listing are not
+ trusted, as filesystems with coarse timestamps may not reflect changes made in
+ the same second.
+
+ Note that in-place modifications of a file do not update the mtime of the
+ directory it lives in on most filesystems.  Such changes are only picked up by
+ the inotify watcher for local sources, or by a forced rescan, which is why the
+ index is off unless enabled in advancedsettings.xml.
+ */
+class CFileStateDatabase : public CDatabase
+{
+public:
+  CFileStateDatabase();
+  virtual ~CFileStateDatabase();
+  virtual bool Open();
+
+  /*! \brief Retrieve a directory listing, using the index when the directory is unchanged
+   Falls back to (and updates the index from) XFILE::CDirectory::GetDirectory()
+   when the directory has changed, is not indexed or can't be stat'ed.
+   \param path the directory to list
+   \param items [out] the listing
+   \param mask the file mask to apply, as for CDirectory::GetDirectory()
+   \param useFileDirectories whether to expand files that act as directories, as for CDirectory::GetDirectory()
+   \return true if the listing was retrieved, false otherwise
+   */
+  bool GetDirectory(const CStdString &path, CFileItemList &items, const CStdString &mask = "", bool useFileDirectories = true);
+
+  /*! \brief Recursive counterpart of GetDirectory(), returning files only
+   \sa CUtil::GetRecursiveListing()
+   */
+  void GetRecursiveListing(const CStdString &path, CFileItemList &items, const CStdString &mask = "", bool useFileDirectories = true);
+
+  /*! \brief Remove the indexed listing(s) of a directory
+   \param path the directory whose listing is no longer valid
+   \param recursive whether listings of subdirectories should be removed as well
+   */
+  void InvalidatePath(const CStdString &path, bool recursive = false);
+
+  /*! \brief Retrieve the stamp used to detect changes of a directory
+   \param path the directory to stat
+   \param mtime [out] modification time of the directory
+   \param inode [out] inode (or file id) of the directory, 0 if the filesystem has none
+   \return true if the directory could be stat'ed, false otherwise
+   */
+  static bool GetDirectoryStamp(const CStdString &path, int64_t &mtime, int64_t &inode);
+
+protected:
+  bool GetIndexedDirectory(const CStdString &path, const CStdString &mask, int options, int64_t mtime, int64_t inode, CFileItemList &items);
+  void SetIndexedDirectory(const CStdString &path, const CStdString &mask, int options, int64_t mtime, int64_t inode, const CFileItemList &items);
+  unsigned int GetPathHash(const CStdString &path) const;
+
+  virtual bool CreateTables();
+  virtual bool UpdateOldVersion(int version);
+  virtual int GetMinVersion() const { return 1; };
+  const char *GetBaseDBName() const { return "FileState"; };
+};
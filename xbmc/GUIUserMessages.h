@@ -76,6 +76,9 @@
 //  Player has requested the next item for caching purposes (PAPlayer)
 #define GUI_MSG_QUEUE_NEXT_ITEM         GUI_MSG_USER + 16
 
+//  Player would like the next item to be read ahead, without queuing it yet (PAPlayer)
+#define GUI_MSG_PREFETCH_NEXT_ITEM      GUI_MSG_USER + 34
+
 // Visualisation messages when loading/unloading
 #define GUI_MSG_VISUALISATION_UNLOADING GUI_MSG_USER + 117 // sent by vis
 #define GUI_MSG_VISUALISATION_LOADED    GUI_MSG_USER + 118 // sent by vis
@@ -32,6 +32,7 @@
 #include "guilib/TextureManager.h"
 #include "TextureCache.h"
 #include "utils/log.h"
+#include "utils/CPUInfo.h"
 #include "programs/Shortcut.h"
 #include "video/VideoInfoTag.h"
 #include "video/VideoDatabase.h"
@@ -155,8 +156,10 @@ bool CThumbExtractor::DoWork()
   return result;
 }
 
+// extraction decodes keyframes only and is mostly bound by I/O, so a couple of
+// files can be handled at once without starving the GUI
 CVideoThumbLoader::CVideoThumbLoader() :
-  CThumbLoader(1), CJobQueue(true), m_pStreamDetailsObs(NULL)
+  CThumbLoader(1), CJobQueue(true, std::min(2, std::max(1, g_cpuInfo.getCPUCount()))), m_pStreamDetailsObs(NULL)
 {
 }
 
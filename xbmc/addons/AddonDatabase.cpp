@@ -28,6 +28,7 @@
 
 using namespace ADDON;
 using namespace std;
+using namespace dbiplus;
 
 CAddonDatabase::CAddonDatabase()
 {
@@ -262,15 +263,7 @@ bool CAddonDatabase::GetAddon(int id, AddonPtr& addon)
                        TranslateType(m_pDS2->fv("type").get_asString()),
                        m_pDS2->fv("version").get_asString(),
                        m_pDS2->fv("minversion").get_asString());
-      props.name = m_pDS2->fv("name").get_asString();
-      props.summary = m_pDS2->fv("summary").get_asString();
-      props.description = m_pDS2->fv("description").get_asString();
-      props.changelog = m_pDS2->fv("changelog").get_asString();
-      props.path = m_pDS2->fv("path").get_asString();
-      props.icon = m_pDS2->fv("icon").get_asString();
-      props.fanart = m_pDS2->fv("fanart").get_asString();
-      props.author = m_pDS2->fv("author").get_asString();
-      props.disclaimer = m_pDS2->fv("disclaimer").get_asString();
+      GetAddonProps(m_pDS2, props);
       sql = PrepareSQL("select reason from broken where addonID='%s'",props.id.c_str());
       m_pDS2->query(sql.c_str());
       if (!m_pDS2->eof())
@@ -304,6 +297,19 @@ bool CAddonDatabase::GetAddon(int id, AddonPtr& addon)
   return false;
 }
 
+void CAddonDatabase::GetAddonProps(auto_ptr<Dataset> &pDS, AddonProps &props)
+{
+  props.name = pDS->fv("name").get_asString();
+  props.summary = pDS->fv("summary").get_asString();
+  props.description = pDS->fv("description").get_asString();
+  props.changelog = pDS->fv("changelog").get_asString();
+  props.path = pDS->fv("path").get_asString();
+  props.icon = pDS->fv("icon").get_asString();
+  props.fanart = pDS->fv("fanart").get_asString();
+  props.author = pDS->fv("author").get_asString();
+  props.disclaimer = pDS->fv("disclaimer").get_asString();
+}
+
 bool CAddonDatabase::GetAddons(VECADDONS& addons)
 {
   try
@@ -479,15 +485,63 @@ bool CAddonDatabase::GetRepository(int id, VECADDONS& addons)
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL = PrepareSQL("select * from addonlinkrepo where idRepo=%i",id);
+    // grab the extra info, dependencies and broken state of all addons in the
+    // repository up front, indexed by addon, rather than querying them per addon
+    map<int, InfoMap> extrainfo;
+    CStdString strSQL = PrepareSQL("select addonextra.id,key,value from addonextra "
+                                   "join addonlinkrepo on addonextra.id=addonlinkrepo.idAddon "
+                                   "where addonlinkrepo.idRepo=%i", id);
     m_pDS->query(strSQL.c_str());
     while (!m_pDS->eof())
     {
-      AddonPtr addon;
-      if (GetAddon(m_pDS->fv("idAddon").get_asInt(),addon))
+      extrainfo[m_pDS->fv(0).get_asInt()].insert(make_pair(m_pDS->fv(1).get_asString(), m_pDS->fv(2).get_asString()));
+      m_pDS->next();
+    }
+    m_pDS->close();
+
+    map<int, ADDONDEPS> dependencies;
+    strSQL = PrepareSQL("select dependencies.id,addon,version,optional from dependencies "
+                        "join addonlinkrepo on dependencies.id=addonlinkrepo.idAddon "
+                        "where addonlinkrepo.idRepo=%i", id);
+    m_pDS->query(strSQL.c_str());
+    while (!m_pDS->eof())
+    {
+      dependencies[m_pDS->fv(0).get_asInt()].insert(make_pair(m_pDS->fv(1).get_asString(), make_pair(AddonVersion(m_pDS->fv(2).get_asString()), m_pDS->fv(3).get_asBool())));
+      m_pDS->next();
+    }
+    m_pDS->close();
+
+    map<CStdString, CStdString> broken;
+    GetBrokenAddons(broken);
+
+    strSQL = PrepareSQL("select addon.* from addon join addonlinkrepo on addon.id=addonlinkrepo.idAddon "
+                        "where addonlinkrepo.idRepo=%i", id);
+    m_pDS->query(strSQL.c_str());
+    while (!m_pDS->eof())
+    {
+      int idAddon = m_pDS->fv("id").get_asInt();
+      AddonProps props(m_pDS->fv("addonID").get_asString(),
+                       TranslateType(m_pDS->fv("type").get_asString()),
+                       m_pDS->fv("version").get_asString(),
+                       m_pDS->fv("minversion").get_asString());
+      GetAddonProps(m_pDS, props);
+
+      map<CStdString, CStdString>::const_iterator reason = broken.find(props.id);
+      if (reason != broken.end())
+        props.broken = reason->second;
+      map<int, InfoMap>::const_iterator info = extrainfo.find(idAddon);
+      if (info != extrainfo.end())
+        props.extrainfo = info->second;
+      map<int, ADDONDEPS>::const_iterator deps = dependencies.find(idAddon);
+      if (deps != dependencies.end())
+        props.dependencies = deps->second;
+
+      AddonPtr addon = CAddonMgr::AddonFromProps(props);
+      if (addon)
         addons.push_back(addon);
       m_pDS->next();
     }
+    m_pDS->close();
     return true;
   }
   catch (...)
@@ -715,6 +769,29 @@ CStdString CAddonDatabase::IsAddonBroken(const CStdString &addonID)
   return "";
 }
 
+bool CAddonDatabase::GetBrokenAddons(map<CStdString, CStdString> &broken)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->query("select addonID,reason from broken");
+    while (!m_pDS->eof())
+    {
+      broken.insert(make_pair(m_pDS->fv(0).get_asString(), m_pDS->fv(1).get_asString()));
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
 bool CAddonDatabase::HasDisabledAddons()
 {
   try
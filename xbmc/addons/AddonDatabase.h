@@ -47,6 +47,14 @@ public:
   void DeleteRepository(const CStdString& id);
   void DeleteRepository(int id);
   int GetRepoChecksum(const CStdString& id, CStdString& checksum);
+
+  /*! \brief Retrieve the addons of a repository, as stored by AddRepository()
+   The details of all addons are fetched with a handful of queries, so this is the
+   cheap alternative to parsing the repository index again while it is unchanged.
+   \param id the id (or database id) of the repository
+   \param addons [out] the addons of the repository
+   \return true if the repository was found, false otherwise
+   */
   bool GetRepository(const CStdString& id, ADDON::VECADDONS& addons);
   bool GetRepository(int id, ADDON::VECADDONS& addons);
   bool SetRepoTimestamp(const CStdString& id, const CStdString& timestamp);
@@ -109,12 +117,21 @@ public:
    \sa BreakAddon */
   CStdString IsAddonBroken(const CStdString &addonID);
 
+  /*! \brief Retrieve all addons marked as broken via BreakAddon, in a single query
+   \param broken [out] the reasons the addons are broken, indexed by addon id
+   \return true on success, false on failure
+   \sa IsAddonBroken */
+  bool GetBrokenAddons(std::map<CStdString, CStdString> &broken);
+
   bool BlacklistAddon(const CStdString& addonID, const CStdString& version);
   bool IsAddonBlacklisted(const CStdString& addonID, const CStdString& version);
   bool RemoveAddonFromBlacklist(const CStdString& addonID,
                                 const CStdString& version);
 
 protected:
+  /*! \brief Fill in the properties of an addon from the current record of an addon query */
+  void GetAddonProps(std::auto_ptr<dbiplus::Dataset> &pDS, ADDON::AddonProps &props);
+
   virtual bool CreateTables();
   virtual bool UpdateOldVersion(int version);
   virtual int GetMinVersion() const { return 15; }
@@ -193,6 +193,11 @@ bool CRepositoryUpdateJob::DoWork()
   // check for updates
   CAddonDatabase database;
   database.Open();
+
+  // the broken state of all addons at once, rather than a query per addon
+  std::map<CStdString, CStdString> brokenAddons;
+  database.GetBrokenAddons(brokenAddons);
+
   for (unsigned int i=0;i<addons.size();++i)
   {
     if (!CAddonInstaller::Get().CheckDependencies(addons[i]))
@@ -218,18 +223,21 @@ bool CRepositoryUpdateJob::DoWork()
                                               addon->Name(),TOAST_DISPLAY_TIME,false,TOAST_DISPLAY_TIME);
       }
     }
-    if (!addons[i]->Props().broken.IsEmpty())
+    CStdString broken;
+    std::map<CStdString, CStdString>::const_iterator reason = brokenAddons.find(addons[i]->ID());
+    if (reason != brokenAddons.end())
+      broken = reason->second;
+    if (!addons[i]->Props().broken.IsEmpty() && broken.IsEmpty())
     {
-      if (database.IsAddonBroken(addons[i]->ID()).IsEmpty())
-      {
-        if (addon && CGUIDialogYesNo::ShowAndGetInput(addons[i]->Name(),
-                                             g_localizeStrings.Get(24096),
-                                             g_localizeStrings.Get(24097),
-                                             ""))
-          database.DisableAddon(addons[i]->ID());
-      }
+      if (addon && CGUIDialogYesNo::ShowAndGetInput(addons[i]->Name(),
+                                           g_localizeStrings.Get(24096),
+                                           g_localizeStrings.Get(24097),
+                                           ""))
+        database.DisableAddon(addons[i]->ID());
     }
-    database.BreakAddon(addons[i]->ID(), addons[i]->Props().broken);
+    // only touch the database when the state changes, as each write is a commit of its own
+    if (!broken.Equals(addons[i]->Props().broken))
+      database.BreakAddon(addons[i]->ID(), addons[i]->Props().broken);
   }
 
   return true;
@@ -100,7 +100,7 @@ CSkinInfo::~CSkinInfo()
 {
 }
 
-void CSkinInfo::Start(const CStdString &strBaseDir)
+void CSkinInfo::Start(const CStdString &strBaseDir, bool loadIncludes)
 {
   if (!m_resolutions.size())
   { // try falling back to whatever resolutions exist in the directory
@@ -113,7 +113,8 @@ void CSkinInfo::Start(const CStdString &strBaseDir)
         m_resolutions.push_back(res);
     }
   }
-  LoadIncludes();
+  if (loadIncludes)
+    LoadIncludes();
 }
 
 struct closestRes
@@ -52,8 +52,14 @@ public:
 
   /*! \brief Load information regarding the skin from the given skin directory
    \param skinDir folder of the skin to load (defaults to this skin's basedir)
+   \param loadIncludes whether to load the includes as well, see LoadIncludes()
    */
-  void Start(const CStdString& skinDir = "");
+  void Start(const CStdString& skinDir = "", bool loadIncludes = true);
+
+  /*! \brief Load (or reload) the includes of the skin
+   Needs to be done before any window of the skin is loaded.
+   */
+  void LoadIncludes();
 
   bool HasSkinFile(const CStdString &strFile) const;
 
@@ -123,7 +129,6 @@ protected:
    */
   void GetDefaultResolution(const cp_extension_t *ext, const char *tag, RESOLUTION &res, const RESOLUTION &def) const;
 
-  void LoadIncludes();
   bool LoadStartupWindows(const cp_extension_t *ext);
 
   RESOLUTION_INFO m_defaultRes;
@@ -49,54 +49,176 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "utils/URIUtils.h"
+#include "utils/JobManager.h"
+#include "utils/CPUInfo.h"
+#include "threads/SingleLock.h"
 
 using namespace std;
 using namespace XFILE;
 using namespace MUSIC_INFO;
 
-CCDDARipper::CCDDARipper()
-{
-  m_pEncoder = NULL;
-}
+// encoder jobs running at the same time, which also bounds the number of
+// tracks held in memory to one more than this
+#define CDDARIP_MAX_ENCODERS 3
 
-CCDDARipper::~CCDDARipper()
-{
-  delete m_pEncoder;
-}
+// bytes of audio held in memory by the encoders and the track being read,
+// about 25 minutes of CD audio. a longer track is still ripped on its own
+#define CDDARIP_MAX_BUFFERED ((int64_t)256 * 1024 * 1024)
 
-bool CCDDARipper::Init(const CStdString& strTrackFile, const CStdString& strFile, const MUSIC_INFO::CMusicInfoTag& infoTag)
-{
-  m_cdReader.Init(strTrackFile);
+// the chunks the encoders are fed with, the same 52 raw sectors CCDDAReader reads
+#define CDDARIP_ENCODE_CHUNK (2352 * 52)
 
+static CEncoder* CreateEncoder(const CStdString& strTrack, int iTrackLength, const MUSIC_INFO::CMusicInfoTag& infoTag)
+{
+  CEncoder* pEncoder;
   switch (g_guiSettings.GetInt("audiocds.encoder"))
   {
   case CDDARIP_ENCODER_WAV:
-    m_pEncoder = new CEncoderWav();
+    pEncoder = new CEncoderWav();
     break;
   case CDDARIP_ENCODER_VORBIS:
-    m_pEncoder = new CEncoderVorbis();
+    pEncoder = new CEncoderVorbis();
     break;
   case CDDARIP_ENCODER_FLAC:
-    m_pEncoder = new CEncoderFlac();
+    pEncoder = new CEncoderFlac();
     break;
   default:
-    m_pEncoder = new CEncoderLame();
+    pEncoder = new CEncoderLame();
     break;
   }
 
   // we have to set the tags before we init the Encoder
+  pEncoder->SetComment("Ripped with XBMC");
+  pEncoder->SetArtist(infoTag.GetArtist().c_str());
+  pEncoder->SetTitle(infoTag.GetTitle().c_str());
+  pEncoder->SetAlbum(infoTag.GetAlbum().c_str());
+  pEncoder->SetAlbumArtist(infoTag.GetAlbumArtist().c_str());
+  pEncoder->SetGenre(infoTag.GetGenre().c_str());
+  pEncoder->SetTrack(strTrack.c_str());
+  pEncoder->SetTrackLength(iTrackLength);
+  pEncoder->SetYear(infoTag.GetYearString().c_str());
+  return pEncoder;
+}
+
+// tracks ripped to a share are encoded to a local file first and copied afterwards
+static CStdString GetTempRipFile()
+{
+  char tmp[MAX_PATH];
+#ifndef _LINUX
+  GetTempFileName(_P("special://temp/"), "riptrack", 0, tmp);
+#else
+  int fd;
+  strncpy(tmp, _P("special://temp/riptrackXXXXXX"), MAX_PATH);
+  if ((fd = mkstemp(tmp)) == -1)
+    return "";
+  close(fd);
+#endif
+  return tmp;
+}
+
+/*! \brief Encodes a track that has been read into memory */
+class CCDDAEncodeJob : public CJob
+{
+public:
+  CCDDAEncodeJob(int iTrack, const CStdString& strFile, const MUSIC_INFO::CMusicInfoTag& infoTag, const volatile bool& abort)
+    : m_iTrack(iTrack), m_strFile(strFile), m_infoTag(infoTag), m_abort(abort)
+  {
+  }
+
+  virtual const char *GetType() const { return "cddaencode"; }
+
+  std::vector<BYTE> m_data;
+  int               m_iTrack;
+
+  virtual bool DoWork()
+  {
+    bool success = Encode();
+    // give back the memory as early as possible, the reader is waiting for it
+    std::vector<BYTE>().swap(m_data);
+    return success;
+  }
+
+private:
+  bool Encode()
+  {
+    CStdString strFilename(m_strFile);
+    CFileItem file(m_strFile, false);
+    if (file.IsRemote())
+      strFilename = GetTempRipFile();
+
+    if (strFilename.IsEmpty())
+    {
+      CLog::Log(LOGERROR, "CCDDARipper: Error opening file");
+      return false;
+    }
+
+    CStdString strTrack;
+    strTrack.Format("%i", m_iTrack);
+    auto_ptr<CEncoder> encoder(CreateEncoder(strTrack, (int)m_data.size(), m_infoTag));
+    if (!encoder->Init(CUtil::MakeLegalPath(strFilename).c_str(), 2, 44100, 16))
+    {
+      CLog::Log(LOGERROR, "Error: CCDDARipper::Init failed");
+      return false;
+    }
+
+    unsigned int size = m_data.size();
+    bool cancelled = false;
+    for (unsigned int pos = 0; pos < size; pos += CDDARIP_ENCODE_CHUNK)
+    {
+      if (m_abort || ShouldCancel(pos, size))
+      {
+        cancelled = true;
+        break;
+      }
+      encoder->Encode(std::min<unsigned int>(CDDARIP_ENCODE_CHUNK, size - pos), &m_data[pos]);
+    }
+    encoder->Close();
+
+    if (cancelled)
+    {
+      CFile::Delete(strFilename);
+      return false;
+    }
+
+    if (file.IsRemote())
+    {
+      // copy the ripped track to the share
+      bool copied = CFile::Cache(strFilename, m_strFile);
+      CFile::Delete(strFilename);
+      if (!copied)
+      {
+        CLog::Log(LOGERROR, "Error copying file from %s to %s", strFilename.c_str(), m_strFile.c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  CStdString                m_strFile;
+  MUSIC_INFO::CMusicInfoTag m_infoTag;
+  const volatile bool&      m_abort;
+};
+
+CCDDARipper::CCDDARipper()
+{
+  m_pEncoder = NULL;
+  m_encodedBytes = 0;
+  m_encodeFailed = false;
+  m_abort = false;
+}
+
+CCDDARipper::~CCDDARipper()
+{
+  delete m_pEncoder;
+}
+
+bool CCDDARipper::Init(const CStdString& strTrackFile, const CStdString& strFile, const MUSIC_INFO::CMusicInfoTag& infoTag)
+{
+  m_cdReader.Init(strTrackFile);
+
   CStdString strTrack;
   strTrack.Format("%i", atoi(strTrackFile.substr(13, strTrackFile.size() - 13 - 5).c_str()));
-
-  m_pEncoder->SetComment("Ripped with XBMC");
-  m_pEncoder->SetArtist(infoTag.GetArtist().c_str());
-  m_pEncoder->SetTitle(infoTag.GetTitle().c_str());
-  m_pEncoder->SetAlbum(infoTag.GetAlbum().c_str());
-  m_pEncoder->SetAlbumArtist(infoTag.GetAlbumArtist().c_str());
-  m_pEncoder->SetGenre(infoTag.GetGenre().c_str());
-  m_pEncoder->SetTrack(strTrack.c_str());
-  m_pEncoder->SetTrackLength(m_cdReader.GetTrackLength());
-  m_pEncoder->SetYear(infoTag.GetYearString().c_str());
+  m_pEncoder = CreateEncoder(strTrack, m_cdReader.GetTrackLength(), infoTag);
 
   // init encoder
   CStdString strFile2=CUtil::MakeLegalPath(strFile);
@@ -157,19 +279,7 @@ bool CCDDARipper::Rip(const CStdString& strTrackFile, const CStdString& strFile,
   // if we are ripping to a samba share, rip it to hd first and then copy it it the share
   CFileItem file(strFile, false);
   if (file.IsRemote()) 
-  {
-    char tmp[MAX_PATH];
-#ifndef _LINUX
-    GetTempFileName(_P("special://temp/"), "riptrack", 0, tmp);
-#else
-    int fd;
-    strncpy(tmp, _P("special://temp/riptrackXXXXXX"), MAX_PATH);
-    if ((fd = mkstemp(tmp)) == -1)
-      strFilename = "";
-    close(fd);
-#endif
-    strFilename = tmp;
-  }
+    strFilename = GetTempRipFile();
   
   if (!strFilename)
   {
@@ -309,32 +419,232 @@ bool CCDDARipper::RipCD()
   if (!CreateAlbumDir(*vecItems[0]->GetMusicInfoTag(), strDirectory, legalType))
     return false;
 
-  // rip all tracks one by one, if one fails we quit and return false
-  for (int i = 0; i < vecItems.Size(); i++)
+  unsigned int tick = XbmcThreads::SystemClockMillis();
+
+  // return false if RipTracks returned false (this means an error or the user cancelled)
+  if (!RipTracks(vecItems, strDirectory, legalType))
+    return false;
+
+  tick = XbmcThreads::SystemClockMillis() - tick;
+  CLog::Log(LOGINFO, "Ripped CD succesfull in %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
+  return true;
+}
+
+bool CCDDARipper::RipTracks(const CFileItemList& items, const CStdString& strDirectory, int legalType)
+{
+  int encoders = std::max(1, std::min(g_cpuInfo.getCPUCount(), CDDARIP_MAX_ENCODERS));
+
+  // amount of audio data of each track and in total, for the overall progress
+  vector<int64_t> trackBytes(items.Size(), 0);
+  int64_t totalBytes = 0;
+  for (int i = 0; i < items.Size(); i++)
   {
-    CFileItemPtr item = vecItems[i];
+    struct __stat64 buffer;
+    if (items[i]->GetPath().Find(".cdda") >= 0 && CFile::Stat(items[i]->GetPath(), &buffer) == 0)
+      trackBytes[i] = buffer.st_size;
+    totalBytes += trackBytes[i];
+  }
 
-    // construct filename
-    CStdString strFile = URIUtils::AddFileToFolder(strDirectory, CUtil::MakeLegalFileName(GetTrackName(item.get()), legalType));
+  CLog::Log(LOGINFO, "Start ripping %d tracks with %d encoders", items.Size(), encoders);
+
+  {
+    CSingleLock lock(m_critSection);
+    m_encoding.clear();
+    m_encodedBytes = 0;
+    m_encodeFailed = false;
+    m_abort = false;
+  }
+
+  // setup the progress dialog
+  CGUIDialogProgress* pDlgProgress = (CGUIDialogProgress*)g_windowManager.GetWindow(WINDOW_DIALOG_PROGRESS);
+  pDlgProgress->SetHeading(605); // Ripping
+  pDlgProgress->SetLine(0, "");
+  pDlgProgress->SetLine(1, "");
+  pDlgProgress->SetLine(2, "");
+  pDlgProgress->StartModal();
+  pDlgProgress->ShowProgressBar(true);
 
-    unsigned int tick = XbmcThreads::SystemClockMillis();
+  bool bCancelled = false;
+  bool bFailed = false;
+  int64_t readBytes = 0;
+  for (int i = 0; i < items.Size() && !bCancelled && !bFailed; i++)
+  {
+    CFileItemPtr item = items[i];
 
     // don't rip non cdda items
     if (item->GetPath().Find(".cdda") < 0)
       continue;
 
-    // return false if Rip returned false (this means an error or the user cancelled
-    if (!Rip(item->GetPath(), strFile.c_str(), *item->GetMusicInfoTag()))
-      return false;
+    // construct filename
+    CStdString strFile = URIUtils::AddFileToFolder(strDirectory, CUtil::MakeLegalFileName(GetTrackName(item.get()), legalType));
+    int iTrack = atoi(item->GetPath().substr(13, item->GetPath().size() - 13 - 5).c_str());
 
-    tick = XbmcThreads::SystemClockMillis() - tick;
-    CLog::Log(LOGINFO, "Ripping Track %d took %s", i, StringUtils::SecondsToTimeString(tick / 1000).c_str());
+    // wait for an encoder to become available, and for the tracks still held
+    // by the encoders to leave room for this one
+    while (!bCancelled)
+    {
+      {
+        CSingleLock lock(m_critSection);
+        bFailed = m_encodeFailed;
+        if (bFailed || m_encoding.empty())
+          break;
+        int64_t buffered = trackBytes[i];
+        for (map<unsigned int, EncodingTrack>::const_iterator it = m_encoding.begin(); it != m_encoding.end(); ++it)
+          buffered += it->second.size;
+        if ((int)m_encoding.size() < encoders && buffered <= CDDARIP_MAX_BUFFERED)
+          break;
+      }
+      bCancelled = UpdateProgress(iTrack, strFile, readBytes, totalBytes);
+      m_encodeEvent.WaitMSec(50);
+    }
+    if (bCancelled || bFailed)
+      break;
+
+    CLog::Log(LOGINFO, "Start reading track %s to %s", item->GetPath().c_str(), strFile.c_str());
+
+    CCDDAReader reader;
+    if (!reader.Init(item->GetPath()))
+    {
+      bFailed = true;
+      break;
+    }
+
+    // read the whole track into memory
+    CCDDAEncodeJob* job = new CCDDAEncodeJob(iTrack, strFile, *item->GetMusicInfoTag(), m_abort);
+    job->m_data.reserve(reader.GetTrackLength());
+    int iResult = CDDARIP_OK;
+    while (!bCancelled && iResult != CDDARIP_DONE)
+    {
+      BYTE* pbtStream = NULL;
+      long lBytesRead = 0;
+      iResult = reader.GetData(&pbtStream, lBytesRead);
+      if (iResult != CDDARIP_ERR && lBytesRead > 0)
+      {
+        job->m_data.insert(job->m_data.end(), pbtStream, pbtStream + lBytesRead);
+        readBytes += lBytesRead;
+      }
+      bCancelled = UpdateProgress(iTrack, strFile, readBytes, totalBytes);
+    }
+    reader.DeInit();
+
+    if (bCancelled)
+    {
+      delete job;
+      break;
+    }
+
+    // hand the track to an encoder, the job is registered before it can complete
+    int64_t size = job->m_data.size();
+    CSingleLock lock(m_critSection);
+    EncodingTrack& encoding = m_encoding[CJobManager::GetInstance().AddJob(job, this)];
+    encoding.track = iTrack;
+    encoding.size = size;
+    encoding.encoded = 0;
+  }
+
+  if (bCancelled || bFailed)
+    m_abort = true;
+
+  // wait for the encoders to finish, or to notice the abort
+  while (true)
+  {
+    {
+      CSingleLock lock(m_critSection);
+      if (m_encoding.empty())
+      {
+        bFailed |= m_encodeFailed;
+        break;
+      }
+    }
+    if (!bCancelled && UpdateProgress(0, "", readBytes, totalBytes))
+    {
+      bCancelled = true;
+      m_abort = true;
+    }
+    m_encodeEvent.WaitMSec(50);
   }
 
-  CLog::Log(LOGINFO, "Ripped CD succesfull");
+  pDlgProgress->Close();
+
+  if (bCancelled)
+  {
+    CLog::Log(LOGWARNING, "User Cancelled CDDA Rip");
+    return false;
+  }
+  if (bFailed)
+  {
+    CLog::Log(LOGERROR, "CCDDARipper: Ripping the CD failed");
+    g_graphicsContext.Lock();
+    CGUIDialogOK::ShowAndGetInput(257, 608, 0, 0);
+    g_graphicsContext.Unlock();
+    return false;
+  }
   return true;
 }
 
+bool CCDDARipper::UpdateProgress(int iTrack, const CStdString& strFile, int64_t readBytes, int64_t totalBytes)
+{
+  CGUIDialogProgress* pDlgProgress = (CGUIDialogProgress*)g_windowManager.GetWindow(WINDOW_DIALOG_PROGRESS);
+
+  CStdString strLine0, strLine1, strLine2;
+  if (iTrack)
+  {
+    strLine0.Format("%s %i", g_localizeStrings.Get(606).c_str(), iTrack); // Track Number: %i
+    strLine1.Format("%s %s", g_localizeStrings.Get(607).c_str(), strFile.c_str()); // To: %s
+  }
+
+  int64_t encodedBytes;
+  {
+    CSingleLock lock(m_critSection);
+    encodedBytes = m_encodedBytes;
+    for (map<unsigned int, EncodingTrack>::const_iterator it = m_encoding.begin(); it != m_encoding.end(); ++it)
+    {
+      CStdString strTrack;
+      strTrack.Format("%02i (%i%%)", it->second.track, it->second.size ? (int)(it->second.encoded * 100 / it->second.size) : 0);
+      strLine2 += strLine2.IsEmpty() ? g_localizeStrings.Get(614) + " " : ", ";
+      strLine2 += strTrack; // Encoding: 03 (45%), 04 (12%)
+      encodedBytes += it->second.encoded;
+    }
+  }
+
+  pDlgProgress->SetLine(0, strLine0);
+  pDlgProgress->SetLine(1, strLine1);
+  pDlgProgress->SetLine(2, strLine2);
+  // reading and encoding each count half
+  if (totalBytes > 0)
+    pDlgProgress->SetPercentage((int)((readBytes + encodedBytes) * 50 / totalBytes));
+  pDlgProgress->Progress();
+  pDlgProgress->ProgressKeys();
+  return pDlgProgress->IsCanceled();
+}
+
+void CCDDARipper::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CCDDAEncodeJob* encodeJob = (CCDDAEncodeJob*)job;
+  CSingleLock lock(m_critSection);
+  map<unsigned int, EncodingTrack>::iterator it = m_encoding.find(jobID);
+  if (it == m_encoding.end())
+    return;
+
+  if (success)
+  {
+    m_encodedBytes += it->second.size;
+    CLog::Log(LOGINFO, "Finished ripping track %i", encodeJob->m_iTrack);
+  }
+  else if (!m_abort)
+    m_encodeFailed = true;
+  m_encoding.erase(it);
+  m_encodeEvent.Set();
+}
+
+void CCDDARipper::OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job)
+{
+  CSingleLock lock(m_critSection);
+  map<unsigned int, EncodingTrack>::iterator it = m_encoding.find(jobID);
+  if (it != m_encoding.end())
+    it->second.encoded = progress;
+}
+
 const char* CCDDARipper::GetExtension(int iEncoder)
 {
   if (iEncoder == CDDARIP_ENCODER_WAV) return ".wav";
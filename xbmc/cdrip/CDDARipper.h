@@ -24,6 +24,11 @@
 
 #include "CDDAReader.h"
 #include "Encoder.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/Job.h"
+
+#include <map>
 
 namespace MUSIC_INFO
 {
@@ -39,8 +44,10 @@ namespace MUSIC_INFO
  for the track file name.
  Format used to encode ripped tracks is defined by the audiocds.encoder user setting, and 
  there are several choices: wav, ogg vorbis and mp3.
+ When ripping an entire CD, tracks are read into memory one after another while
+ the tracks read before are encoded concurrently on the job manager.
  */
-class CCDDARipper
+class CCDDARipper : public IJobCallback
 {
 public:
   CCDDARipper();
@@ -58,6 +65,9 @@ public:
    */
   bool RipCD();
 
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+  virtual void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job);
+
 private:
   /*! \brief Create and initialize CD reader and encoder objects used for ripping
    \param[in] source file name of the track to rip
@@ -85,6 +95,23 @@ private:
    \return true if success, false if failure
    */
   bool Rip(const CStdString& strTrackFile, const CStdString& strFileName, const MUSIC_INFO::CMusicInfoTag& infoTag);
+
+  /*! \brief Rip several tracks, reading them while the tracks read before are encoded
+   \param[in] items CFileItems representing the tracks to rip
+   \param[in] strDirectory folder the tracks are stored in
+   \param[in] legalType type of the folder (see LEGAL_... constants)
+   \return true if success, false if failure or cancelled
+   */
+  bool RipTracks(const CFileItemList& items, const CStdString& strDirectory, int legalType);
+
+  /*! \brief Update the progress dialog while ripping several tracks
+   \param[in] iTrack track being read, 0 if reading has finished
+   \param[in] strFile destination of the track being read
+   \param[in] readBytes bytes read so far
+   \param[in] totalBytes bytes of all tracks to rip
+   \return true if the user cancelled, false otherwise
+   */
+  bool UpdateProgress(int iTrack, const CStdString& strFile, int64_t readBytes, int64_t totalBytes);
   
   /*! \brief Return track file name extension for the given encoder type
    \param[in] iEncoder encoder type (see CDDARIP_ENCODER_... constants)
@@ -114,6 +141,20 @@ private:
 
   CEncoder* m_pEncoder;
   CCDDAReader m_cdReader;
+
+  /*! \brief State of a track being encoded */
+  struct EncodingTrack
+  {
+    int     track;
+    int64_t size;    ///< bytes of the track
+    int64_t encoded; ///< bytes of the track encoded so far
+  };
+  std::map<unsigned int, EncodingTrack> m_encoding; ///< tracks being encoded, by job id
+  int64_t          m_encodedBytes; ///< bytes of finished tracks
+  bool             m_encodeFailed;
+  volatile bool    m_abort;        ///< asks running encoder jobs to stop
+  CCriticalSection m_critSection;
+  CEvent           m_encodeEvent;  ///< set whenever an encoder job finishes
 };
 
 #endif // _CCDDARIPPERMP3_H
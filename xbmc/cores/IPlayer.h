@@ -83,6 +83,7 @@ public:
   virtual bool OpenFile(const CFileItem& file, const CPlayerOptions& options){ return false;}
   virtual bool QueueNextFile(const CFileItem &file) { return false; }
   virtual void OnNothingToQueueNotify() {}
+  virtual void PrefetchNextFile(const CFileItem &file) {}
   virtual bool CloseFile(){ return true;}
   virtual bool IsPlaying() const { return false;}
   virtual void Pause() = 0;
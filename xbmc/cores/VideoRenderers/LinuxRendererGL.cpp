@@ -3391,7 +3391,8 @@ bool CLinuxRendererGL::Supports(EINTERLACEMETHOD method)
     return false;
 
   if(method == VS_INTERLACEMETHOD_DEINTERLACE
-  || method == VS_INTERLACEMETHOD_DEINTERLACE_HALF)
+  || method == VS_INTERLACEMETHOD_DEINTERLACE_HALF
+  || method == VS_INTERLACEMETHOD_DEINTERLACE_TEMPORAL_HALF)
     return true;
 
   if((method == VS_INTERLACEMETHOD_RENDER_BLEND
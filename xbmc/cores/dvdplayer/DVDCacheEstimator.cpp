@@ -0,0 +1,146 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDCacheEstimator.h"
+#include "DVDClock.h"
+#include "threads/SystemClock.h"
+
+#include <math.h>
+#include <algorithm>
+
+// weight of a new sample in the running mean and variance
+#define RATE_WEIGHT     0.2
+// samples needed before an estimate is used
+#define RATE_MINSAMPLES 3
+// standard deviations the pessimistic rates are away from the mean, 1.645
+// keeps the chance of a rate beyond it at about 5% for normal distributions
+#define RATE_DEVIATIONS 1.645
+// length of a sampling window
+#define WINDOW_MSEC     1000
+// dts jumps larger than this are treated as a discontinuity
+#define WINDOW_MAXJUMP  (10.0 * DVD_TIME_BASE)
+
+void CDVDCacheEstimator::SRate::Add(double rate)
+{
+  if (count++ == 0)
+  {
+    mean = rate;
+    var  = 0.0;
+    return;
+  }
+
+  double diff = rate - mean;
+  mean += RATE_WEIGHT * diff;
+  var   = (1.0 - RATE_WEIGHT) * (var + RATE_WEIGHT * diff * diff);
+}
+
+double CDVDCacheEstimator::SRate::Deviation() const
+{
+  return RATE_DEVIATIONS * sqrt(var);
+}
+
+CDVDCacheEstimator::CDVDCacheEstimator()
+{
+  Reset();
+}
+
+void CDVDCacheEstimator::Reset()
+{
+  m_stream.Reset();
+  m_streamBytes = 0;
+  m_streamStart = DVD_NOPTS_VALUE;
+  m_streamLast  = DVD_NOPTS_VALUE;
+
+  m_input.Reset();
+  m_inputStart = -1;
+  m_inputStamp = 0;
+}
+
+void CDVDCacheEstimator::AddPacket(int size, double dts)
+{
+  if (dts == DVD_NOPTS_VALUE)
+  {
+    m_streamBytes += size;
+    return;
+  }
+
+  // restart the window on seeks and timestamp discontinuities
+  if (m_streamStart == DVD_NOPTS_VALUE
+  ||  dts < m_streamLast - DVD_TIME_BASE
+  ||  dts > m_streamLast + WINDOW_MAXJUMP)
+  {
+    m_streamStart = dts;
+    m_streamLast  = dts;
+    m_streamBytes = size;
+    return;
+  }
+
+  m_streamBytes += size;
+  if (dts > m_streamLast)
+    m_streamLast = dts;
+
+  double span = m_streamLast - m_streamStart;
+  if (span >= DVD_MSEC_TO_TIME(WINDOW_MSEC))
+  {
+    m_stream.Add(m_streamBytes * DVD_TIME_BASE / span);
+    m_streamStart = m_streamLast;
+    m_streamBytes = 0;
+  }
+}
+
+void CDVDCacheEstimator::AddInput(int64_t position, bool full)
+{
+  unsigned now = XbmcThreads::SystemClockMillis();
+
+  // a full cache or a seek says nothing about the source
+  if (full || m_inputStart < 0 || position < m_inputStart)
+  {
+    m_inputStart = position;
+    m_inputStamp = now;
+    return;
+  }
+
+  unsigned elapsed = now - m_inputStamp;
+  if (elapsed < WINDOW_MSEC)
+    return;
+
+  m_input.Add(1000.0 * (position - m_inputStart) / elapsed);
+  m_inputStart = position;
+  m_inputStamp = now;
+}
+
+unsigned CDVDCacheEstimator::GetStreamRate() const
+{
+  if (m_stream.count < RATE_MINSAMPLES)
+    return 0;
+  return (unsigned)(m_stream.mean + m_stream.Deviation());
+}
+
+unsigned CDVDCacheEstimator::GetInputRate() const
+{
+  if (m_input.count < RATE_MINSAMPLES)
+    return 0;
+
+  // never go below a tenth of the mean, the source is rarely that bad
+  // and a non-positive rate would stall the start of playback for good
+  double rate = m_input.mean - m_input.Deviation();
+  return (unsigned)std::max(rate, 0.1 * m_input.mean);
+}
@@ -0,0 +1,81 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+
+/*! \brief Estimates how much has to be cached before playback can (re)start
+ Two rates are tracked as exponentially weighted mean and variance: the rate
+ at which the input stream fills the cache, sampled over one second intervals,
+ and the bitrate of the demuxed content, as bytes per second of dts.  The
+ cache is considered sufficient once a pessimistic input rate can keep up with
+ a pessimistic content bitrate for the rest of the file, where pessimistic is
+ the mean shifted by a number of standard deviations chosen to keep the risk
+ of running dry again below a target probability.
+ */
+class CDVDCacheEstimator
+{
+public:
+  CDVDCacheEstimator();
+
+  void Reset();
+
+  /*! \brief Account a demuxed packet
+   \param size size of the packet in bytes
+   \param dts decode timestamp of the packet, DVD_NOPTS_VALUE if unknown
+   */
+  void AddPacket(int size, double dts);
+
+  /*! \brief Sample the input rate
+   \param position file position up to which data has been read into the cache
+   \param full whether the cache is full, in which case the input is not limited by the source
+   */
+  void AddInput(int64_t position, bool full);
+
+  /*! \brief Pessimistic content bitrate in bytes per second, 0 if not yet known */
+  unsigned GetStreamRate() const;
+  /*! \brief Pessimistic input rate in bytes per second, 0 if not yet known */
+  unsigned GetInputRate() const;
+
+  double GetStreamRateMean() const { return m_stream.mean; }
+  double GetInputRateMean() const  { return m_input.mean; }
+
+private:
+  struct SRate
+  {
+    void   Reset() { mean = 0.0; var = 0.0; count = 0; }
+    void   Add(double rate);
+    double Deviation() const;
+
+    double   mean;
+    double   var;
+    unsigned count;
+  };
+
+  SRate    m_stream;
+  int64_t  m_streamBytes;
+  double   m_streamStart;   // dts at the start of the current window
+  double   m_streamLast;
+
+  SRate    m_input;
+  int64_t  m_inputStart;    // position at the start of the current window
+  unsigned m_inputStamp;
+};
@@ -140,6 +140,8 @@ CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
   m_iLastKeyframe = 0;
   m_dts = DVD_NOPTS_VALUE;
   m_started = false;
+  m_skipFrameDefault = AVDISCARD_DEFAULT;
+  m_skipLoopFilterDefault = AVDISCARD_DEFAULT;
 }
 
 CDVDVideoCodecFFmpeg::~CDVDVideoCodecFFmpeg()
@@ -258,6 +260,10 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
       m_dllAvUtil.av_set_string3(m_pCodecContext, it->m_name.c_str(), it->m_value.c_str(), 0, NULL);
   }
 
+  // remember what the caller asked for so SetDropMethod restores it instead of the defaults
+  m_skipFrameDefault = m_pCodecContext->skip_frame;
+  m_skipLoopFilterDefault = m_pCodecContext->skip_loop_filter;
+
   int num_threads = std::min(8 /*MAX_THREADS*/, g_cpuInfo.getCPUCount());
   if( num_threads > 1 && !hints.software && m_pHardware == NULL // thumbnail extraction fails when run threaded
   && ( pCodec->id == CODEC_ID_H264
@@ -409,12 +415,9 @@ void CDVDVideoCodecFFmpeg::SetDropMethod(bool bDrop, bool bInputPacket /*= true
      m_bDecoderDropRequested = false;
      m_bHardwareDropRequested = false;
      m_bDropRequested = false;
-     AVDiscard loopFilterDefault = AVDISCARD_DEFAULT;
-     if (g_advancedSettings.m_iSkipLoopFilter != 0)
-        loopFilterDefault = (AVDiscard)g_advancedSettings.m_iSkipLoopFilter;
-     m_pCodecContext->skip_frame = AVDISCARD_DEFAULT;
+     m_pCodecContext->skip_frame = m_skipFrameDefault;
      m_pCodecContext->skip_idct = AVDISCARD_DEFAULT;
-     m_pCodecContext->skip_loop_filter = loopFilterDefault;
+     m_pCodecContext->skip_loop_filter = m_skipLoopFilterDefault;
         
      if (bDrop)
      {
@@ -424,14 +427,15 @@ void CDVDVideoCodecFFmpeg::SetDropMethod(bool bDrop, bool bInputPacket /*= true
         if (AllowDecoderDrop() && bInputPacket)
         {
            m_bDecoderDropRequested = true;
+           // never drop less than the options given at open time already skip
            if (HintDropUrgent())
            {
-              m_pCodecContext->skip_frame = AVDISCARD_BIDIR; //skip frame for non-reference and b-frame
+              m_pCodecContext->skip_frame = std::max(m_skipFrameDefault, AVDISCARD_BIDIR); //skip frame for non-reference and b-frame
               m_pCodecContext->skip_idct = AVDISCARD_NONREF; //skip dequant for non-reference frames
-              m_pCodecContext->skip_loop_filter = AVDISCARD_NONREF; //skip deblocking filter for non-reference frames
+              m_pCodecContext->skip_loop_filter = std::max(m_skipLoopFilterDefault, AVDISCARD_NONREF); //skip deblocking filter for non-reference frames
            }
            else
-              m_pCodecContext->skip_frame = AVDISCARD_NONREF;
+              m_pCodecContext->skip_frame = std::max(m_skipFrameDefault, AVDISCARD_NONREF);
         } 
         else
         {
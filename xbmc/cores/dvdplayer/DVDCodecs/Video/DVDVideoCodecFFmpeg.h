@@ -156,6 +156,8 @@ protected:
   bool m_bInterlacedMode; //decoder is in interlaced frame mode
   bool m_bFieldInputMode; //decoder input is field based 
   int m_iFrameFlags; //flags to be applied to the frame just decoded (from hints at decoder input time)
+  AVDiscard m_skipFrameDefault; //skip_frame in effect after Open, restored by SetDropMethod
+  AVDiscard m_skipLoopFilterDefault; //skip_loop_filter in effect after Open, restored by SetDropMethod
   struct input_hist {
      int64_t pts_opaque; //frame pts opaque form
      bool drop; //decoder drop request flag
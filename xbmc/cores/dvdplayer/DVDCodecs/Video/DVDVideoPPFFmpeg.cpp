@@ -20,11 +20,16 @@
  */
 
 #include "DVDVideoPPFFmpeg.h"
+#include "DVDVideoPPYadif.h"
+#include "utils/CPUInfo.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 #include "utils/log.h"
 
 CDVDVideoPPFFmpeg::CDVDVideoPPFFmpeg(const CStdString& mType)
 {
-  m_sType = mType;
+  m_pYadif = NULL;
+  ParseType(mType);
   m_pMode = m_pContext = NULL;
   m_pSource = m_pTarget = NULL;
   m_iInitWidth = m_iInitHeight = 0;
@@ -33,6 +38,7 @@ CDVDVideoPPFFmpeg::CDVDVideoPPFFmpeg(const CStdString& mType)
 CDVDVideoPPFFmpeg::~CDVDVideoPPFFmpeg()
 {
   Dispose();
+  DisposeYadif();
 }
 void CDVDVideoPPFFmpeg::Dispose()
 {
@@ -93,14 +99,54 @@ bool CDVDVideoPPFFmpeg::CheckInit(int iWidth, int iHeight)
     return false;
 }
 
+void CDVDVideoPPFFmpeg::ParseType(const CStdString& mType)
+{
+  m_sRequested = mType;
+  m_sType.clear();
+
+  bool yadif = false;
+  CStdStringArray filters;
+  StringUtils::SplitString(mType, ",", filters);
+  for (unsigned int i = 0; i < filters.size(); i++)
+  {
+    if (filters[i] == "yadif")
+      yadif = true;
+    else if (!filters[i].IsEmpty())
+    {
+      if (!m_sType.IsEmpty())
+        m_sType += ",";
+      m_sType += filters[i];
+    }
+  }
+
+  if (yadif && !m_pYadif)
+  {
+    m_pYadif = new CDVDVideoPPYadif(g_cpuInfo.getCPUCount());
+    // the slices are filtered on several threads, so only wall time is meaningful
+    m_yadifStats.Start(false);
+  }
+  else if (!yadif && m_pYadif)
+    DisposeYadif();
+}
+
+void CDVDVideoPPFFmpeg::DisposeYadif()
+{
+  if (!m_pYadif)
+    return;
+  m_yadifStats.Report("deinterlace");
+  delete m_pYadif;
+  m_pYadif = NULL;
+}
+
 void CDVDVideoPPFFmpeg::SetType(const CStdString& mType)
 {
-  if (mType == m_sType)
+  if (mType == m_sRequested)
     return;
 
-  m_sType = mType;
+  CStdString sType = m_sType;
+  ParseType(mType);
 
-  if(m_pContext || m_pMode)
+  if((m_pContext || m_pMode) && sType != m_sType)
     Dispose();
 }
 
@@ -111,6 +157,29 @@ bool CDVDVideoPPFFmpeg::Process(DVDVideoPicture* pPicture)
   if(m_pSource->format != DVDVideoPicture::FMT_YUV420P)
     return false;
 
+  // deinterlace first, the other filters then work on the progressive picture
+  if(m_pYadif)
+  {
+    if(m_pTarget == m_pYadif->GetPicture())
+      m_pTarget = NULL;
+
+    int64_t start = CurrentHostCounter();
+    if(!m_pYadif->Process(m_pSource))
+    {
+      CLog::Log(LOGERROR, "%s - deinterlacing %dx%d failed", __FUNCTION__, m_pSource->iWidth, m_pSource->iHeight);
+      return false;
+    }
+    m_yadifStats.AddDecode(CurrentHostCounter() - start);
+    m_yadifStats.AddFrame();
+
+    m_pSource = m_pYadif->GetPicture();
+    if(m_sType.IsEmpty())
+    {
+      m_pTarget = m_pSource;
+      return true;
+    }
+  }
+
   if( !CheckInit(m_pSource->iWidth, m_pSource->iHeight) )
   {
     CLog::Log(LOGERROR, "Initialization of ffmpeg postprocessing failed");
@@ -209,3 +278,9 @@ bool CDVDVideoPPFFmpeg::GetPicture(DVDVideoPicture* pPicture)
   return false;
 }
 
+
+void CDVDVideoPPFFmpeg::Reset()
+{
+  if (m_pYadif)
+    m_pYadif->Reset();
+}
@@ -22,8 +22,11 @@
  */
 
 #include "DVDVideoCodec.h"
+#include "DVDStreamStats.h"
 #include "DllPostProc.h"
 
+class CDVDVideoPPYadif;
+
 class CDVDVideoPPFFmpeg
 {
 public:
@@ -37,8 +40,18 @@ public:
   bool Process   (DVDVideoPicture *pPicture);
   bool GetPicture(DVDVideoPicture *pPicture);
 
+  /*! \brief Forget the pictures kept for temporal filters, eg. after a seek */
+  void Reset();
+
 protected:
-  CStdString m_sType;
+  CStdString m_sType;      ///< libpostproc filters
+  CStdString m_sRequested; ///< filters as requested, "yadif" selects the threaded deinterlacer
+  CDVDVideoPPYadif *m_pYadif;
+  CDVDStreamStats   m_yadifStats;
+
+  void DisposeYadif();
+
+  void ParseType(const CStdString& mType);
 
   void *m_pContext;
   void *m_pMode;
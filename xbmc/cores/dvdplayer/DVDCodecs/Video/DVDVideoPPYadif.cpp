@@ -0,0 +1,278 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDVideoPPYadif.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+using namespace std;
+
+#define YADIF_MAX_THREADS 8
+
+// edge directed interpolation, tries the diagonals around the current pixel
+// and keeps the one along which the rows above and below match best
+#define YADIF_CHECK(j)\
+    {   int score = abs(above[x-1+(j)] - below[x-1-(j)])\
+                  + abs(above[x  +(j)] - below[x  -(j)])\
+                  + abs(above[x+1+(j)] - below[x+1-(j)]);\
+        if (score < spatialScore) {\
+            spatialScore = score;\
+            spatialPred  = (above[x+(j)] + below[x-(j)]) >> 1;\
+
+CDVDVideoPPYadif::CWorker::CWorker(CDVDVideoPPYadif *owner)
+  : CThread("CDVDVideoPPYadif")
+  , m_owner(owner)
+{
+  m_first = m_last = 0;
+}
+
+void CDVDVideoPPYadif::CWorker::Run(int first, int last)
+{
+  m_first = first;
+  m_last  = last;
+  m_start.Set();
+}
+
+void CDVDVideoPPYadif::CWorker::Stop()
+{
+  m_bStop = true;
+  m_start.Set();
+  StopThread();
+}
+
+void CDVDVideoPPYadif::CWorker::Process()
+{
+  while (!m_bStop)
+  {
+    m_start.Wait();
+    if (m_bStop)
+      break;
+    m_owner->FilterSlice(m_first, m_last);
+    m_done.Set();
+  }
+}
+
+CDVDVideoPPYadif::CDVDVideoPPYadif(int threads)
+{
+  m_threads = min(YADIF_MAX_THREADS, max(1, threads));
+  memset(&m_output, 0, sizeof(m_output));
+  memset(m_prev, 0, sizeof(m_prev));
+  m_source  = NULL;
+  m_hasPrev = false;
+  m_parity  = 0;
+  m_width   = 0;
+  m_height  = 0;
+}
+
+CDVDVideoPPYadif::~CDVDVideoPPYadif()
+{
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+  {
+    m_workers[i]->Stop();
+    delete m_workers[i];
+  }
+  m_workers.clear();
+
+  Free();
+}
+
+void CDVDVideoPPYadif::Free()
+{
+  for (int i = 0; i < 3; i++)
+  {
+    if (m_output.data[i])
+      _aligned_free(m_output.data[i]);
+    if (m_prev[i])
+      _aligned_free(m_prev[i]);
+    m_output.data[i] = NULL;
+    m_prev[i] = NULL;
+  }
+  m_hasPrev = false;
+  m_width = m_height = 0;
+}
+
+bool CDVDVideoPPYadif::Allocate(const DVDVideoPicture *pSource)
+{
+  if (m_width == pSource->iWidth && m_height == pSource->iHeight)
+    return true;
+
+  Free();
+  memset(&m_output, 0, sizeof(m_output));
+
+  m_output.iLineSize[0] = (pSource->iWidth + 15) & ~15;
+  m_output.iLineSize[1] = (((pSource->iWidth + 1) >> 1) + 15) & ~15;
+  m_output.iLineSize[2] = m_output.iLineSize[1];
+
+  for (int i = 0; i < 3; i++)
+  {
+    int size = m_output.iLineSize[i] * (i ? (pSource->iHeight + 1) >> 1 : pSource->iHeight);
+    m_output.data[i] = (BYTE*)_aligned_malloc(size, 16);
+    m_prev[i]        = (BYTE*)_aligned_malloc(size, 16);
+    if (!m_output.data[i] || !m_prev[i])
+    {
+      Free();
+      return false;
+    }
+  }
+
+  m_width  = pSource->iWidth;
+  m_height = pSource->iHeight;
+
+  if (m_workers.empty())
+  {
+    for (int i = 1; i < m_threads; i++)
+    {
+      CWorker *worker = new CWorker(this);
+      worker->Create();
+      m_workers.push_back(worker);
+    }
+  }
+  return true;
+}
+
+bool CDVDVideoPPYadif::Process(const DVDVideoPicture *pSource)
+{
+  if (pSource->format != DVDVideoPicture::FMT_YUV420P)
+    return false;
+
+  if (!Allocate(pSource))
+    return false;
+
+  m_source = pSource;
+  m_parity = (pSource->iFlags & DVP_FLAG_TOP_FIELD_FIRST) ? 0 : 1;
+
+  // slices start on even rows, so the chroma rows split at the same place
+  int slices = m_workers.size() + 1;
+  int rows   = ((m_height + slices - 1) / slices + 1) & ~1;
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+    m_workers[i]->Run(min((int)i * rows, m_height), min((int)(i + 1) * rows, m_height));
+  FilterSlice(min((int)m_workers.size() * rows, m_height), m_height);
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+    m_workers[i]->WaitDone();
+
+  // keep the source for the temporal check of the next frame
+  for (int i = 0; i < 3; i++)
+  {
+    int width  = i ? (m_width  + 1) >> 1 : m_width;
+    int height = i ? (m_height + 1) >> 1 : m_height;
+    for (int y = 0; y < height; y++)
+      memcpy(m_prev[i] + y * m_output.iLineSize[i], pSource->data[i] + y * pSource->iLineSize[i], width);
+  }
+  m_hasPrev = true;
+
+  // take over the timing and properties of the source, but keep our planes
+  BYTE *data[4]     = { m_output.data[0], m_output.data[1], m_output.data[2], NULL };
+  int   lineSize[4] = { m_output.iLineSize[0], m_output.iLineSize[1], m_output.iLineSize[2], 0 };
+  m_output = *pSource;
+  for (int i = 0; i < 4; i++)
+  {
+    m_output.data[i]      = data[i];
+    m_output.iLineSize[i] = lineSize[i];
+  }
+  m_output.iFlags &= ~(DVP_FLAG_INTERLACED | DVP_FLAG_TOP_FIELD_FIRST | DVP_FLAG_REPEAT_TOP_FIELD);
+  m_output.iFlags |= DVP_FLAG_ALLOCATED;
+  return true;
+}
+
+void CDVDVideoPPYadif::FilterSlice(int first, int last)
+{
+  FilterPlane(0, first, last);
+  int chromaHeight = (m_height + 1) >> 1;
+  FilterPlane(1, first >> 1, last == m_height ? chromaHeight : last >> 1);
+  FilterPlane(2, first >> 1, last == m_height ? chromaHeight : last >> 1);
+}
+
+void CDVDVideoPPYadif::FilterPlane(int plane, int first, int last)
+{
+  const int w = plane ? (m_width  + 1) >> 1 : m_width;
+  const int h = plane ? (m_height + 1) >> 1 : m_height;
+  const int curStride  = m_source->iLineSize[plane];
+  const int prevStride = m_output.iLineSize[plane];
+  const BYTE *curPlane  = m_source->data[plane];
+  const BYTE *prevPlane = m_prev[plane];
+  const bool temporal   = m_hasPrev;
+
+  for (int y = first; y < last; y++)
+  {
+    BYTE *dst = m_output.data[plane] + y * m_output.iLineSize[plane];
+    if ((y & 1) == m_parity || h < 3)
+    {
+      memcpy(dst, curPlane + y * curStride, w);
+      continue;
+    }
+
+    // rows of the kept field around the missing row, mirrored at the borders
+    const int up    = y > 0     ? y - 1 : y + 1;
+    const int down  = y < h - 1 ? y + 1 : y - 1;
+    const int up2   = y >= 2    ? y - 2 : y;
+    const int down2 = y + 2 < h ? y + 2 : y;
+
+    const BYTE *above = curPlane + up   * curStride;
+    const BYTE *below = curPlane + down * curStride;
+
+    // the missing field of the previous frame was shown half a field before
+    // the kept one, the one of the current frame half a field after it
+    const BYTE *prev2     = prevPlane + y     * prevStride;
+    const BYTE *next2     = curPlane  + y     * curStride;
+    const BYTE *prev2Up   = prevPlane + up2   * prevStride;
+    const BYTE *next2Up   = curPlane  + up2   * curStride;
+    const BYTE *prev2Down = prevPlane + down2 * prevStride;
+    const BYTE *next2Down = curPlane  + down2 * curStride;
+    const BYTE *prevAbove = prevPlane + up    * prevStride;
+    const BYTE *prevBelow = prevPlane + down  * prevStride;
+
+    for (int x = 0; x < w; x++)
+    {
+      int c = above[x];
+      int e = below[x];
+      int spatialPred = (c + e) >> 1;
+
+      if (x >= 3 && x < w - 3)
+      {
+        int spatialScore = abs(above[x-1] - below[x-1]) + abs(c - e) + abs(above[x+1] - below[x+1]) - 1;
+        YADIF_CHECK(-1) YADIF_CHECK(-2) }} }}
+        YADIF_CHECK( 1) YADIF_CHECK( 2) }} }}
+      }
+
+      if (temporal)
+      {
+        int d = (prev2[x] + next2[x]) >> 1;
+        int temporalDiff0 = abs(prev2[x] - next2[x]);
+        int temporalDiff1 = (abs(prevAbove[x] - c) + abs(prevBelow[x] - e)) >> 1;
+        int diff = max(temporalDiff0 >> 1, temporalDiff1);
+
+        int b = (prev2Up[x]   + next2Up[x])   >> 1;
+        int f = (prev2Down[x] + next2Down[x]) >> 1;
+        int maxDiff = max(max(d - e, d - c), min(b - c, f - e));
+        int minDiff = min(min(d - e, d - c), max(b - c, f - e));
+        diff = max(max(diff, minDiff), -maxDiff);
+
+        if (spatialPred > d + diff)
+          spatialPred = d + diff;
+        else if (spatialPred < d - diff)
+          spatialPred = d - diff;
+      }
+
+      dst[x] = (BYTE)spatialPred;
+    }
+  }
+}
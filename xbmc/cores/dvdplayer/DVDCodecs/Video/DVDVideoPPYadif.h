@@ -0,0 +1,95 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDVideoCodec.h"
+#include "threads/Thread.h"
+#include "threads/Event.h"
+
+#include <vector>
+
+/*! \brief Temporal/spatial software deinterlacer for YUV 4:2:0 pictures
+ A variant of the yadif filter that outputs one frame per input frame without
+ delaying the picture.  The first field in time is kept, and the lines of the
+ second field are interpolated along edges, limited by how much the picture
+ changed since the previous frame.  This is exactly yadif's half rate output,
+ except for the check against the following frame, which isn't available yet.
+
+ The picture is split into slices of rows that are filtered concurrently on
+ one worker per additional core.
+ */
+class CDVDVideoPPYadif
+{
+public:
+  /*! \brief Create the deinterlacer
+   \param threads number of slices filtered concurrently, the calling thread included
+   */
+  CDVDVideoPPYadif(int threads);
+  ~CDVDVideoPPYadif();
+
+  /*! \brief Deinterlace a picture into the internal output picture
+   \param pSource the picture to deinterlace, must be FMT_YUV420P
+   \return true if the output picture was produced, false otherwise
+   */
+  bool Process(const DVDVideoPicture *pSource);
+
+  /*! \brief The last picture produced by Process(), valid until the next call */
+  DVDVideoPicture *GetPicture() { return &m_output; }
+
+  /*! \brief Forget the previous frame, eg. after a seek */
+  void Reset() { m_hasPrev = false; }
+
+private:
+  class CWorker : public CThread
+  {
+  public:
+    CWorker(CDVDVideoPPYadif *owner);
+    void Run(int first, int last);
+    void WaitDone() { m_done.Wait(); }
+    void Stop();
+  protected:
+    virtual void Process();
+  private:
+    CDVDVideoPPYadif *m_owner;
+    CEvent m_start;
+    CEvent m_done;
+    int    m_first;
+    int    m_last;
+  };
+
+  bool Allocate(const DVDVideoPicture *pSource);
+  void Free();
+
+  /*! \brief Filter luma rows [first, last) and the matching chroma rows of the current picture */
+  void FilterSlice(int first, int last);
+  void FilterPlane(int plane, int first, int last);
+
+  std::vector<CWorker*> m_workers;
+  int                   m_threads;
+
+  const DVDVideoPicture *m_source;   ///< picture being processed
+  DVDVideoPicture        m_output;
+  BYTE                  *m_prev[3];  ///< copy of the previous source picture
+  bool                   m_hasPrev;
+  int                    m_parity;   ///< row parity of the field that is kept
+  int                    m_width;
+  int                    m_height;
+};
@@ -46,6 +46,18 @@
 #include "threads/Thread.h"
 #include "utils/TimeUtils.h"
 
+/* AV_PKT_FLAG_KEY was named PKT_FLAG_KEY in older versions of libavcodec */
+#ifndef AV_PKT_FLAG_KEY
+#define AV_PKT_FLAG_KEY PKT_FLAG_KEY
+#endif
+
+// speeds above which only keyframes are read, rewind always does
+#define TRICKPLAY_MINSPEED   (4 * DVD_PLAYSPEED_NORMAL)
+// keyframes shown per second in trick play
+#define TRICKPLAY_RATE       4
+// packets read after a seek before giving up on finding the keyframe
+#define TRICKPLAY_MAXPACKETS 1000
+
 void CDemuxStreamAudioFFmpeg::GetStreamInfo(std::string& strInfo)
 {
   if(!m_stream) return;
@@ -260,6 +272,10 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
   m_speed = DVD_PLAYSPEED_NORMAL;
   g_demuxer = this;
   m_program = UINT_MAX;
+  m_trickStream = -1;
+  m_trickPts = DVD_NOPTS_VALUE;
+  m_trickDone = false;
+  m_keyframe = false;
 
   if (!pInput) return false;
 
@@ -280,6 +296,24 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
 
   bool streaminfo = true; /* set to true if we want to look for streams before playback*/
 
+  // local files that were probed before and haven't changed since can skip probing
+  unsigned int openStart = XbmcThreads::SystemClockMillis();
+  CDVDProbeDatabase probeDatabase;
+  CDVDProbeDatabase::CProbe probe;
+  int64_t probeSize = 0, probeTime = 0;
+  bool probeCached = false;
+  if (m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE) && m_pInput->GetContent() != "audio/x-spdif-compressed")
+  {
+    struct __stat64 buffer;
+    if (XFILE::CFile::Stat(strFile, &buffer) == 0 && buffer.st_size > 0 && buffer.st_mtime != 0)
+    {
+      probeSize = buffer.st_size;
+      probeTime = buffer.st_mtime;
+      if (probeDatabase.Open())
+        probeCached = probeDatabase.GetProbe(strFile, probeSize, probeTime, probe);
+    }
+  }
+
   if( m_pInput->GetContent().length() > 0 )
   {
     std::string content = m_pInput->GetContent();
@@ -333,6 +367,9 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if(m_pInput->Seek(0, SEEK_POSSIBLE) == 0)
       m_ioContext->is_streamed = 1;
 
+    if (iformat == NULL && probeCached)
+      iformat = m_dllAvFormat.av_find_input_format(probe.format.c_str());
+
     if( iformat == NULL )
     {
 #if defined(USE_EXTERNAL_FFMPEG) && LIBAVFORMAT_VERSION_INT < AV_VERSION_INT(52,98,0)
@@ -451,6 +488,8 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if (m_dllAvFormat.av_open_input_stream(&m_pFormatContext, m_ioContext, strFile.c_str(), iformat, NULL) < 0)
     {
       CLog::Log(LOGERROR, "%s - Error, could not open file %s", __FUNCTION__, strFile.c_str());
+      if (probeCached)
+        probeDatabase.RemoveProbe(strFile);
       Dispose();
       return false;
     }
@@ -463,6 +502,23 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
   // we need to know if this is matroska or avi later
   m_bMatroska = strncmp(m_pFormatContext->iformat->name, "matroska", 8) == 0;	// for "matroska.webm"
   m_bAVI = strcmp(m_pFormatContext->iformat->name, "avi") == 0;
+  m_bTS = strcmp(m_pFormatContext->iformat->name, "mpegts") == 0;
+
+  // matroska cues and the mp4 sample tables index all keyframes, for
+  // transport streams the index is built up while playing
+  m_bTrickPlay = m_bMatroska || m_bTS || strncmp(m_pFormatContext->iformat->name, "mov,", 4) == 0;
+
+  if (probeCached)
+  {
+    if (RestoreProbe(probe))
+      streaminfo = false;
+    else
+    {
+      CLog::Log(LOGDEBUG, "%s - stored probe doesn't match %s, probing again", __FUNCTION__, strFile.c_str());
+      probeDatabase.RemoveProbe(strFile);
+      probeCached = false;
+    }
+  }
 
   if (streaminfo)
   {
@@ -471,6 +527,12 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       m_pFormatContext->max_analyze_duration = 500000;
 
 
+    // only layouts fully described by the header can be restored later,
+    // ie. probing must not add streams or change their codecs
+    std::vector<int> headerCodecs;
+    for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+      headerCodecs.push_back(m_pFormatContext->streams[i]->codec->codec_id);
+
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info starting", __FUNCTION__);
     int iErr = m_dllAvFormat.av_find_stream_info(m_pFormatContext);
     if (iErr < 0)
@@ -487,6 +549,21 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       }
     }
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
+
+    if (iErr >= 0 && probeSize > 0 && probeDatabase.IsOpen() && !m_ioContext->is_streamed
+    && !(m_pFormatContext->ctx_flags & AVFMTCTX_NOHEADER)
+    &&  m_pFormatContext->nb_streams > 0 && m_pFormatContext->nb_streams <= MAX_STREAMS
+    &&  m_pFormatContext->nb_streams == headerCodecs.size())
+    {
+      bool stable = true;
+      for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+        stable &= m_pFormatContext->streams[i]->codec->codec_id == headerCodecs[i];
+      if (stable)
+      {
+        StoreProbe(probe);
+        probeDatabase.SetProbe(strFile, probeSize, probeTime, probe);
+      }
+    }
   }
   // reset any timeout
   m_timeout.SetInfinite();
@@ -525,6 +602,9 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       AddStream(i);
   }
 
+  CLog::Log(LOGDEBUG, "%s - opened %s in %u ms (%s)", __FUNCTION__, strFile.c_str(),
+            XbmcThreads::SystemClockMillis() - openStart, probeCached ? "stored probe" : "probed");
+
   return true;
 }
 
@@ -552,6 +632,7 @@ void CDVDDemuxFFmpeg::Dispose()
   m_ioContext = NULL;
   m_pFormatContext = NULL;
   m_speed = DVD_PLAYSPEED_NORMAL;
+  m_trickStream = -1;
 
   for (int i = 0; i < MAX_STREAMS; i++)
   {
@@ -586,6 +667,8 @@ void CDVDDemuxFFmpeg::Flush()
     m_dllAvFormat.av_read_frame_flush(m_pFormatContext);
 
   m_iCurrentPts = DVD_NOPTS_VALUE;
+  m_trickPts = DVD_NOPTS_VALUE;
+  m_trickDone = false;
 }
 
 void CDVDDemuxFFmpeg::Abort()
@@ -629,6 +712,32 @@ void CDVDDemuxFFmpeg::SetSpeed(int iSpeed)
         m_pFormatContext->streams[i]->discard = discard;
     }
   }
+
+  // beyond that, only keyframes of the video stream are read, by seeking
+  // from one to the next at a spacing that keeps the picture rate steady
+  int trickStream = -1;
+  if(m_bTrickPlay
+  && (m_speed > TRICKPLAY_MINSPEED || m_speed < DVD_PLAYSPEED_PAUSE)
+  && m_pInput->Seek(0, SEEK_POSSIBLE))
+  {
+    for(unsigned int i = 0; i < m_pFormatContext->nb_streams && i < MAX_STREAMS; i++)
+    {
+      AVStream *stream = m_pFormatContext->streams[i];
+      if(stream && stream->discard != AVDISCARD_ALL
+      && stream->codec && stream->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+      {
+        trickStream = i;
+        break;
+      }
+    }
+  }
+
+  if(trickStream != m_trickStream)
+  {
+    m_trickStream = trickStream;
+    m_trickPts    = DVD_NOPTS_VALUE;
+  }
+  m_trickDone = false;
 }
 
 double CDVDDemuxFFmpeg::ConvertTimestamp(int64_t pts, int den, int num)
@@ -659,6 +768,103 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
 {
   g_demuxer = this;
 
+  if(m_trickStream >= 0 && !m_trickDone)
+    return ReadKeyframe();
+  return ReadPacket();
+}
+
+DemuxPacket* CDVDDemuxFFmpeg::ReadKeyframe()
+{
+  bool forward = m_speed > 0;
+
+  if(m_trickPts != DVD_NOPTS_VALUE)
+  {
+    double step = (double)DVD_TIME_BASE * m_speed / DVD_PLAYSPEED_NORMAL / TRICKPLAY_RATE;
+    if(!SeekKeyframe(m_trickPts + step))
+    {
+      // at the start or end of the file, read on normally until the speed
+      // changes or a seek. seeking again on every call would only spin, and
+      // the player falls back to normal speed at the start on its own.
+      CLog::Log(LOGDEBUG, "%s - no keyframe left in the direction of play", __FUNCTION__);
+      m_trickDone = true;
+      return ReadPacket();
+    }
+  }
+
+  for(int i = 0; i < TRICKPLAY_MAXPACKETS; i++)
+  {
+    DemuxPacket* pPacket = ReadPacket();
+    if(!pPacket)
+      return NULL;
+
+    if(pPacket->iStreamId == m_trickStream && m_keyframe && pPacket->iSize > 0)
+    {
+      double pts = pPacket->pts != DVD_NOPTS_VALUE ? pPacket->pts : pPacket->dts;
+
+      // the seek may have ended up on the keyframe returned last time
+      if(pts == DVD_NOPTS_VALUE || m_trickPts == DVD_NOPTS_VALUE
+      || (forward ? pts > m_trickPts : pts < m_trickPts))
+      {
+        if(pts != DVD_NOPTS_VALUE)
+          m_trickPts = pts;
+        return pPacket;
+      }
+    }
+    CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+  }
+
+  // no keyframe anywhere near, the stream isn't suited to trick play
+  CLog::Log(LOGDEBUG, "%s - no keyframe within %d packets", __FUNCTION__, TRICKPLAY_MAXPACKETS);
+  m_trickDone = true;
+  return CDVDDemuxUtils::AllocateDemuxPacket(0);
+}
+
+bool CDVDDemuxFFmpeg::SeekKeyframe(double pts)
+{
+  if(pts < 0.0)
+  {
+    if(m_trickPts <= 0.0)
+      return false;
+    pts = 0.0;
+  }
+
+  AVStream *stream = m_pFormatContext->streams[m_trickStream];
+  int flags = m_speed < 0 ? AVSEEK_FLAG_BACKWARD : 0;
+
+  double seconds = pts / DVD_TIME_BASE;
+  if(m_pFormatContext->start_time != (int64_t)AV_NOPTS_VALUE)
+    seconds += (double)m_pFormatContext->start_time / AV_TIME_BASE;
+  int64_t timestamp = (int64_t)(seconds * stream->time_base.den / stream->time_base.num);
+
+  int ret;
+  {
+    CSingleLock lock(m_critSection);
+    int index = m_dllAvFormat.av_index_search_timestamp(stream, timestamp, flags);
+    if(index >= 0 && m_bTS)
+    {
+      // the index was built from packet positions, go straight there
+      ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, stream->index_entries[index].pos, AVSEEK_FLAG_BYTE);
+    }
+    else
+    {
+      if(index >= 0)
+        timestamp = stream->index_entries[index].timestamp;
+      else if(!m_bTS && stream->nb_index_entries > 0)
+        return false; // the container index has no keyframe in that direction
+
+      ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, m_trickStream, timestamp, flags);
+    }
+  }
+
+  if(ret < 0)
+    return false;
+
+  m_iCurrentPts = DVD_NOPTS_VALUE;
+  return true;
+}
+
+DemuxPacket* CDVDDemuxFFmpeg::ReadPacket()
+{
   AVPacket pkt;
   DemuxPacket* pPacket = NULL;
   // on some cases where the received packet is invalid we will need to return an empty packet (0 length) otherwise the main loop (in CDVDPlayer)
@@ -811,6 +1017,13 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
         }
 
         pPacket->iStreamId = pkt.stream_index; // XXX just for now
+
+        // remember where the keyframes of transport streams are, for trick play
+        m_keyframe = (pkt.flags & AV_PKT_FLAG_KEY) != 0;
+        pPacket->keyframe = m_keyframe;
+        if(m_bTS && m_keyframe && pkt.pos >= 0 && pkt.dts != (int64_t)AV_NOPTS_VALUE
+        && stream->codec && stream->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+          m_dllAvFormat.av_add_index_entry(stream, pkt.pos, pkt.dts, 0, 0, AVINDEX_KEYFRAME);
       }
       m_dllAvCodec.av_free_packet(&pkt);
     }
@@ -861,6 +1074,9 @@ bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
   if(time < 0)
     time = 0;
 
+  m_trickPts = DVD_NOPTS_VALUE;
+  m_trickDone = false;
+
   CDVDInputStream::ISeekTime* ist = dynamic_cast<CDVDInputStream::ISeekTime*>(m_pInput);
   if (ist)
   {
@@ -976,6 +1192,113 @@ int CDVDDemuxFFmpeg::GetNrOfStreams()
   return i;
 }
 
+bool CDVDDemuxFFmpeg::RestoreProbe(const CDVDProbeDatabase::CProbe &probe)
+{
+  // streams of headerless formats only show up while reading
+  if (m_pFormatContext->ctx_flags & AVFMTCTX_NOHEADER)
+    return false;
+
+  if (probe.format != m_pFormatContext->iformat->name
+  ||  probe.streams.size() != m_pFormatContext->nb_streams)
+    return false;
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVCodecContext *codec = m_pFormatContext->streams[i]->codec;
+    if (codec->codec_type != probe.streams[i].type
+    ||  codec->codec_id   != probe.streams[i].codec)
+      return false;
+  }
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    const CDVDProbeDatabase::CStream &stored = probe.streams[i];
+    AVStream       *stream = m_pFormatContext->streams[i];
+    AVCodecContext *codec  = stream->codec;
+
+    codec->codec_tag             = stored.fourcc;
+    codec->width                 = stored.width;
+    codec->height                = stored.height;
+    codec->pix_fmt               = (PixelFormat)stored.pixfmt;
+    codec->sample_rate           = stored.samplerate;
+    codec->channels              = stored.channels;
+    codec->sample_fmt            = (AVSampleFormat)stored.samplefmt;
+    codec->bits_per_coded_sample = stored.bitspersample;
+    codec->block_align           = stored.blockalign;
+    codec->bit_rate              = stored.bitrate;
+    codec->level                 = stored.level;
+    codec->profile               = stored.profile;
+
+    stream->r_frame_rate.num        = stored.fpsrate;
+    stream->r_frame_rate.den        = stored.fpsscale;
+    stream->avg_frame_rate.num      = stored.avgrate;
+    stream->avg_frame_rate.den      = stored.avgscale;
+    stream->sample_aspect_ratio.num = stored.aspectnum;
+    stream->sample_aspect_ratio.den = stored.aspectden;
+    stream->duration                = stored.duration;
+    stream->start_time              = stored.starttime;
+
+    // the header usually carries the extradata, only fill in what probing would have found
+    if (!codec->extradata && !stored.extradata.empty())
+    {
+      codec->extradata = (uint8_t*)m_dllAvUtil.av_mallocz(stored.extradata.size() + FF_INPUT_BUFFER_PADDING_SIZE);
+      if (codec->extradata)
+      {
+        memcpy(codec->extradata, stored.extradata.data(), stored.extradata.size());
+        codec->extradata_size = stored.extradata.size();
+      }
+    }
+  }
+
+  m_pFormatContext->duration   = probe.duration;
+  m_pFormatContext->start_time = probe.starttime;
+  m_pFormatContext->bit_rate   = probe.bitrate;
+  return true;
+}
+
+void CDVDDemuxFFmpeg::StoreProbe(CDVDProbeDatabase::CProbe &probe)
+{
+  probe.format    = m_pFormatContext->iformat->name;
+  probe.duration  = m_pFormatContext->duration;
+  probe.starttime = m_pFormatContext->start_time;
+  probe.bitrate   = m_pFormatContext->bit_rate;
+  probe.streams.clear();
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVStream       *stream = m_pFormatContext->streams[i];
+    AVCodecContext *codec  = stream->codec;
+    CDVDProbeDatabase::CStream stored;
+
+    stored.type          = codec->codec_type;
+    stored.codec         = codec->codec_id;
+    stored.fourcc        = codec->codec_tag;
+    stored.width         = codec->width;
+    stored.height        = codec->height;
+    stored.pixfmt        = codec->pix_fmt;
+    stored.samplerate    = codec->sample_rate;
+    stored.channels      = codec->channels;
+    stored.samplefmt     = codec->sample_fmt;
+    stored.bitspersample = codec->bits_per_coded_sample;
+    stored.blockalign    = codec->block_align;
+    stored.bitrate       = codec->bit_rate;
+    stored.level         = codec->level;
+    stored.profile       = codec->profile;
+    stored.fpsrate       = stream->r_frame_rate.num;
+    stored.fpsscale      = stream->r_frame_rate.den;
+    stored.avgrate       = stream->avg_frame_rate.num;
+    stored.avgscale      = stream->avg_frame_rate.den;
+    stored.aspectnum     = stream->sample_aspect_ratio.num;
+    stored.aspectden     = stream->sample_aspect_ratio.den;
+    stored.duration      = stream->duration;
+    stored.starttime     = stream->start_time;
+    if (codec->extradata && codec->extradata_size > 0)
+      stored.extradata.assign((const char*)codec->extradata, codec->extradata_size);
+
+    probe.streams.push_back(stored);
+  }
+}
+
 void CDVDDemuxFFmpeg::AddStream(int iId)
 {
   AVStream* pStream = m_pFormatContext->streams[iId];
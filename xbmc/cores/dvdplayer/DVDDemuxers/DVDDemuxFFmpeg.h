@@ -22,6 +22,7 @@
  */
 
 #include "DVDDemux.h"
+#include "DVDProbeDatabase.h"
 #include "DllAvFormat.h"
 #include "DllAvCodec.h"
 #include "DllAvUtil.h"
@@ -121,9 +122,23 @@ protected:
   int ReadFrame(AVPacket *packet);
   void AddStream(int iId);
 
+  DemuxPacket* ReadPacket();
+  /*! \brief Read the next keyframe of the trick play stream, spaced by the current speed */
+  DemuxPacket* ReadKeyframe();
+  /*! \brief Position the demuxer on the keyframe next to a time in the direction of play
+   \return false if there is no keyframe left in that direction
+   */
+  bool SeekKeyframe(double pts);
+
   double ConvertTimestamp(int64_t pts, int den, int num);
   void UpdateCurrentPTS();
 
+  /*! \brief Apply a stored probe outcome to the freshly opened streams
+   \return true if the stored layout matches the header of the file, false if it needs probing
+   */
+  bool RestoreProbe(const CDVDProbeDatabase::CProbe &probe);
+  void StoreProbe(CDVDProbeDatabase::CProbe &probe);
+
   CCriticalSection m_critSection;
   #define MAX_STREAMS 100
   CDemuxStream* m_streams[MAX_STREAMS]; // maximum number of streams that ffmpeg can handle
@@ -137,7 +152,13 @@ protected:
   double   m_iCurrentPts; // used for stream length estimation
   bool     m_bMatroska;
   bool     m_bAVI;
+  bool     m_bTS;
   int      m_speed;
+  bool     m_bTrickPlay;  // whether the container allows keyframe trick play
+  int      m_trickStream; // video stream read in trick play, -1 when playing normally
+  double   m_trickPts;    // time of the last keyframe returned in trick play
+  bool     m_trickDone;   // no keyframe left in the direction of play, packets are read normally
+  bool     m_keyframe;    // whether the last packet read was a keyframe
   unsigned m_program;
   XbmcThreads::EndTime  m_timeout;
 
@@ -34,4 +34,5 @@
   double pts; // pts in DVD_TIME_BASE
   double dts; // dts in DVD_TIME_BASE
   double duration; // duration in DVD_TIME_BASE if available
+  bool keyframe; // packet starts a keyframe, only set by demuxers that know
 } DemuxPacket;
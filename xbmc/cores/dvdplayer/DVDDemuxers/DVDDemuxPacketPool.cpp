@@ -0,0 +1,268 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#if (defined HAVE_CONFIG_H) && (!defined WIN32)
+  #include "config.h"
+#endif
+#include "DVDDemuxPacketPool.h"
+#include "DVDClock.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+extern "C" {
+#if (defined USE_EXTERNAL_FFMPEG)
+  #if (defined HAVE_LIBAVCODEC_AVCODEC_H)
+    #include <libavcodec/avcodec.h>
+  #else
+    #include <ffmpeg/avcodec.h>
+  #endif
+#else
+  #include "libavcodec/avcodec.h"
+#endif
+}
+
+// bytes in front of each payload holding its size class, keeps the payload 16 byte aligned
+#define DEMUX_POOL_HEADER     16
+// bytes of free buffers kept per size class, and the bounds on their number.
+// Trim() cuts every class down to the minimum again
+#define DEMUX_POOL_CLASS_BYTES (1024 * 1024)
+#define DEMUX_POOL_MIN_CACHED 4
+#define DEMUX_POOL_MAX_CACHED 256
+// packet structures kept for reuse
+#define DEMUX_POOL_MAX_PACKETS 1024
+
+CDVDDemuxPacketPool& CDVDDemuxPacketPool::Get()
+{
+  // never destroyed, packets may still be freed during static destruction
+  static CDVDDemuxPacketPool* pool = new CDVDDemuxPacketPool();
+  return *pool;
+}
+
+CDVDDemuxPacketPool::CDVDDemuxPacketPool()
+{
+  for (int i = 0; i <= DEMUX_POOL_CLASSES; i++)
+  {
+    SizeClass& sizeClass = m_classes[i];
+    memset(&sizeClass.stats, 0, sizeof(sizeClass.stats));
+    if (i < DEMUX_POOL_CLASSES)
+    {
+      sizeClass.stats.size = 1 << (DEMUX_POOL_MIN_SHIFT + i);
+      sizeClass.maxCached  = DEMUX_POOL_CLASS_BYTES / sizeClass.stats.size;
+      if (sizeClass.maxCached < DEMUX_POOL_MIN_CACHED)
+        sizeClass.maxCached = DEMUX_POOL_MIN_CACHED;
+      if (sizeClass.maxCached > DEMUX_POOL_MAX_CACHED)
+        sizeClass.maxCached = DEMUX_POOL_MAX_CACHED;
+    }
+    else
+      sizeClass.maxCached = 0;
+  }
+}
+
+CDVDDemuxPacketPool::~CDVDDemuxPacketPool()
+{
+  Purge();
+}
+
+int CDVDDemuxPacketPool::GetClass(int iDataSize)
+{
+  int index = 0;
+  while (index < DEMUX_POOL_CLASSES && iDataSize > (1 << (DEMUX_POOL_MIN_SHIFT + index)))
+    index++;
+  return index;
+}
+
+unsigned char* CDVDDemuxPacketPool::AllocateBuffer(int iDataSize)
+{
+  int index = GetClass(iDataSize);
+  SizeClass& sizeClass = m_classes[index];
+  unsigned char* pBuffer = NULL;
+
+  {
+    CSingleLock lock(sizeClass.lock);
+    sizeClass.stats.allocs++;
+    if (!sizeClass.buffers.empty())
+    {
+      pBuffer = sizeClass.buffers.back();
+      sizeClass.buffers.pop_back();
+      sizeClass.stats.hits++;
+    }
+    sizeClass.stats.cached = sizeClass.buffers.size();
+    if (++sizeClass.stats.inuse > sizeClass.stats.peak)
+      sizeClass.stats.peak = sizeClass.stats.inuse;
+  }
+
+  if (!pBuffer)
+  {
+    int capacity = index < DEMUX_POOL_CLASSES ? sizeClass.stats.size : iDataSize;
+    pBuffer = (unsigned char*)_aligned_malloc(DEMUX_POOL_HEADER + capacity + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+    if (!pBuffer)
+    {
+      CSingleLock lock(sizeClass.lock);
+      sizeClass.stats.inuse--;
+      return NULL;
+    }
+    *(int*)pBuffer = index;
+  }
+
+  return pBuffer + DEMUX_POOL_HEADER;
+}
+
+void CDVDDemuxPacketPool::FreeBuffer(unsigned char* pData)
+{
+  unsigned char* pBuffer = pData - DEMUX_POOL_HEADER;
+  int index = *(int*)pBuffer;
+  if (index < 0 || index > DEMUX_POOL_CLASSES)
+  {
+    CLog::Log(LOGERROR, "%s - freeing a buffer that wasn't allocated by the pool", __FUNCTION__);
+    return;
+  }
+
+  SizeClass& sizeClass = m_classes[index];
+  {
+    CSingleLock lock(sizeClass.lock);
+    sizeClass.stats.inuse--;
+    if (sizeClass.buffers.size() < sizeClass.maxCached)
+    {
+      sizeClass.buffers.push_back(pBuffer);
+      sizeClass.stats.cached = sizeClass.buffers.size();
+      return;
+    }
+  }
+  _aligned_free(pBuffer);
+}
+
+DemuxPacket* CDVDDemuxPacketPool::Allocate(int iDataSize)
+{
+  DemuxPacket* pPacket = NULL;
+  {
+    CSingleLock lock(m_packetLock);
+    if (!m_packets.empty())
+    {
+      pPacket = m_packets.back();
+      m_packets.pop_back();
+    }
+  }
+  if (!pPacket)
+    pPacket = new DemuxPacket;
+
+  memset(pPacket, 0, sizeof(DemuxPacket));
+
+  if (iDataSize > 0)
+  {
+    pPacket->pData = AllocateBuffer(iDataSize);
+    if (!pPacket->pData)
+    {
+      Free(pPacket);
+      return NULL;
+    }
+
+    // ffmpeg's bitstream readers may read over the end of the data, the
+    // padding after it has to be zeroed
+    memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+  }
+
+  // setup defaults
+  pPacket->dts       = DVD_NOPTS_VALUE;
+  pPacket->pts       = DVD_NOPTS_VALUE;
+  pPacket->iStreamId = -1;
+
+  return pPacket;
+}
+
+void CDVDDemuxPacketPool::Free(DemuxPacket* pPacket)
+{
+  if (pPacket->pData)
+  {
+    FreeBuffer(pPacket->pData);
+    pPacket->pData = NULL;
+  }
+
+  {
+    CSingleLock lock(m_packetLock);
+    if (m_packets.size() < DEMUX_POOL_MAX_PACKETS)
+    {
+      m_packets.push_back(pPacket);
+      return;
+    }
+  }
+  delete pPacket;
+}
+
+void CDVDDemuxPacketPool::Trim()
+{
+  ReleaseBuffers(DEMUX_POOL_MIN_CACHED);
+}
+
+void CDVDDemuxPacketPool::ReleaseBuffers(unsigned int keep)
+{
+  for (int i = 0; i <= DEMUX_POOL_CLASSES; i++)
+  {
+    std::vector<unsigned char*> buffers;
+    {
+      CSingleLock lock(m_classes[i].lock);
+      std::vector<unsigned char*>& cached = m_classes[i].buffers;
+      if (cached.size() > keep)
+      {
+        buffers.assign(cached.begin() + keep, cached.end());
+        cached.resize(keep);
+      }
+      m_classes[i].stats.cached = cached.size();
+    }
+    for (unsigned int j = 0; j < buffers.size(); j++)
+      _aligned_free(buffers[j]);
+  }
+}
+
+void CDVDDemuxPacketPool::Purge()
+{
+  ReleaseBuffers(0);
+
+  std::vector<DemuxPacket*> packets;
+  {
+    CSingleLock lock(m_packetLock);
+    packets.swap(m_packets);
+  }
+  for (unsigned int i = 0; i < packets.size(); i++)
+    delete packets[i];
+}
+
+void CDVDDemuxPacketPool::GetStats(std::vector<ClassStats>& stats)
+{
+  stats.clear();
+  for (int i = 0; i <= DEMUX_POOL_CLASSES; i++)
+  {
+    CSingleLock lock(m_classes[i].lock);
+    stats.push_back(m_classes[i].stats);
+  }
+}
+
+void CDVDDemuxPacketPool::LogStats()
+{
+  std::vector<ClassStats> stats;
+  GetStats(stats);
+  for (unsigned int i = 0; i < stats.size(); i++)
+  {
+    const ClassStats& s = stats[i];
+    if (s.allocs == 0)
+      continue;
+    CLog::Log(LOGDEBUG, "%s - size %7d: %u allocations, %u from pool (%.1f%%), %u in use, %u cached, peak %u", __FUNCTION__,
+              s.size, s.allocs, s.hits, 100.0 * s.hits / s.allocs, s.inuse, s.cached, s.peak);
+  }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDDemuxPacket.h"
+#include "threads/CriticalSection.h"
+
+#include <vector>
+
+// payload size classes of the pool, 256 bytes up to 2MB
+#define DEMUX_POOL_MIN_SHIFT 8
+#define DEMUX_POOL_CLASSES   14
+
+/*! \brief Recycles demux packets and their payload buffers
+ Payloads are rounded up to power of two size classes, each with its own free
+ list, so the steady stream of similarly sized packets of a playing file is
+ served without going to the system allocator.  The input padding required by
+ ffmpeg is part of every pooled buffer.  Payloads larger than the biggest size
+ class are allocated and freed directly.
+ */
+class CDVDDemuxPacketPool
+{
+public:
+  struct ClassStats
+  {
+    int          size;     ///< payload capacity of the class, 0 for oversized payloads
+    unsigned int allocs;   ///< number of allocations served
+    unsigned int hits;     ///< number of allocations served from the free list
+    unsigned int cached;   ///< buffers currently on the free list
+    unsigned int inuse;    ///< buffers currently handed out
+    unsigned int peak;     ///< maximum of inuse
+  };
+
+  static CDVDDemuxPacketPool& Get();
+
+  DemuxPacket* Allocate(int iDataSize);
+  void Free(DemuxPacket* pPacket);
+
+  /*! \brief Release the free buffers beyond a few per size class, eg. after a flush */
+  void Trim();
+
+  /*! \brief Release all buffers on the free lists back to the system */
+  void Purge();
+
+  void GetStats(std::vector<ClassStats>& stats);
+  void LogStats();
+
+private:
+  CDVDDemuxPacketPool();
+  ~CDVDDemuxPacketPool();
+
+  struct SizeClass
+  {
+    CCriticalSection            lock;
+    std::vector<unsigned char*> buffers;
+    ClassStats                  stats;
+    unsigned int                maxCached;
+  };
+
+  unsigned char* AllocateBuffer(int iDataSize);
+  void FreeBuffer(unsigned char* pData);
+  void ReleaseBuffers(unsigned int keep);
+  static int GetClass(int iDataSize);
+
+  SizeClass                 m_classes[DEMUX_POOL_CLASSES + 1]; ///< the last one tracks oversized payloads
+  CCriticalSection          m_packetLock;
+  std::vector<DemuxPacket*> m_packets;
+};
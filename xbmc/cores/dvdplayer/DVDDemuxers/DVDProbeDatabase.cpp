@@ -0,0 +1,268 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDProbeDatabase.h"
+#include "utils/log.h"
+#include "utils/Crc32.h"
+#include "dbwrappers/dataset.h"
+
+using namespace std;
+
+static string ToHex(const string &data)
+{
+  static const char digits[] = "0123456789abcdef";
+  string hex;
+  hex.reserve(data.size() * 2);
+  for (size_t i = 0; i < data.size(); i++)
+  {
+    hex += digits[(unsigned char)data[i] >> 4];
+    hex += digits[(unsigned char)data[i] & 0xf];
+  }
+  return hex;
+}
+
+static string FromHex(const string &hex)
+{
+  string data;
+  data.reserve(hex.size() / 2);
+  for (size_t i = 0; i + 1 < hex.size(); i += 2)
+  {
+    int hi = hex[i]   <= '9' ? hex[i]   - '0' : hex[i]   - 'a' + 10;
+    int lo = hex[i+1] <= '9' ? hex[i+1] - '0' : hex[i+1] - 'a' + 10;
+    data += (char)((hi << 4) | lo);
+  }
+  return data;
+}
+
+CDVDProbeDatabase::CStream::CStream()
+{
+  type = codec = 0;
+  fourcc = 0;
+  width = height = pixfmt = 0;
+  samplerate = channels = samplefmt = 0;
+  bitspersample = blockalign = bitrate = 0;
+  level = profile = 0;
+  fpsrate = fpsscale = avgrate = avgscale = 0;
+  aspectnum = aspectden = 0;
+  duration = starttime = 0;
+}
+
+CDVDProbeDatabase::CProbe::CProbe()
+{
+  duration = starttime = 0;
+  bitrate = 0;
+}
+
+CDVDProbeDatabase::CDVDProbeDatabase()
+{
+}
+
+CDVDProbeDatabase::~CDVDProbeDatabase()
+{
+}
+
+bool CDVDProbeDatabase::Open()
+{
+  return CDatabase::Open();
+}
+
+bool CDVDProbeDatabase::CreateTables()
+{
+  try
+  {
+    CDatabase::CreateTables();
+
+    CLog::Log(LOGINFO, "create probe table");
+    m_pDS->exec("CREATE TABLE probe (idProbe integer primary key, pathhash integer, strPath text, size integer, mtime integer, "
+                "format text, duration integer, starttime integer, bitrate integer)\n");
+
+    CLog::Log(LOGINFO, "create probe index");
+    m_pDS->exec("CREATE INDEX idxProbe ON probe(pathhash)");
+
+    CLog::Log(LOGINFO, "create probestream table");
+    m_pDS->exec("CREATE TABLE probestream (idProbe integer, idx integer, type integer, codec integer, fourcc integer, "
+                "width integer, height integer, pixfmt integer, samplerate integer, channels integer, samplefmt integer, "
+                "bitspersample integer, blockalign integer, bitrate integer, level integer, profile integer, "
+                "fpsrate integer, fpsscale integer, avgrate integer, avgscale integer, aspectnum integer, aspectden integer, "
+                "duration integer, starttime integer, extradata text)\n");
+
+    CLog::Log(LOGINFO, "create probestream index");
+    m_pDS->exec("CREATE INDEX idxProbeStream ON probestream(idProbe)");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s unable to create tables", __FUNCTION__);
+    return false;
+  }
+
+  return true;
+}
+
+bool CDVDProbeDatabase::UpdateOldVersion(int version)
+{
+  return true;
+}
+
+bool CDVDProbeDatabase::GetProbe(const CStdString &path, int64_t size, int64_t mtime, CProbe &probe)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString sql = PrepareSQL("select idProbe, size, mtime, format, duration, starttime, bitrate from probe where pathhash=%u and strPath='%s'",
+                                GetPathHash(path), path.c_str());
+    m_pDS->query(sql.c_str());
+    if (m_pDS->eof())
+    {
+      m_pDS->close();
+      return false;
+    }
+
+    int idProbe = m_pDS->fv(0).get_asInt();
+    bool unchanged = m_pDS->fv(1).get_asInt64() == size && m_pDS->fv(2).get_asInt64() == mtime;
+    probe.format    = m_pDS->fv(3).get_asString();
+    probe.duration  = m_pDS->fv(4).get_asInt64();
+    probe.starttime = m_pDS->fv(5).get_asInt64();
+    probe.bitrate   = m_pDS->fv(6).get_asInt();
+    m_pDS->close();
+    if (!unchanged)
+      return false;
+
+    sql = PrepareSQL("select type, codec, fourcc, width, height, pixfmt, samplerate, channels, samplefmt, bitspersample, blockalign, bitrate, "
+                     "level, profile, fpsrate, fpsscale, avgrate, avgscale, aspectnum, aspectden, duration, starttime, extradata "
+                     "from probestream where idProbe=%i order by idx", idProbe);
+    m_pDS->query(sql.c_str());
+    probe.streams.clear();
+    while (!m_pDS->eof())
+    {
+      CStream stream;
+      stream.type          = m_pDS->fv(0).get_asInt();
+      stream.codec         = m_pDS->fv(1).get_asInt();
+      stream.fourcc        = (unsigned int)m_pDS->fv(2).get_asInt64();
+      stream.width         = m_pDS->fv(3).get_asInt();
+      stream.height        = m_pDS->fv(4).get_asInt();
+      stream.pixfmt        = m_pDS->fv(5).get_asInt();
+      stream.samplerate    = m_pDS->fv(6).get_asInt();
+      stream.channels      = m_pDS->fv(7).get_asInt();
+      stream.samplefmt     = m_pDS->fv(8).get_asInt();
+      stream.bitspersample = m_pDS->fv(9).get_asInt();
+      stream.blockalign    = m_pDS->fv(10).get_asInt();
+      stream.bitrate       = m_pDS->fv(11).get_asInt();
+      stream.level         = m_pDS->fv(12).get_asInt();
+      stream.profile       = m_pDS->fv(13).get_asInt();
+      stream.fpsrate       = m_pDS->fv(14).get_asInt();
+      stream.fpsscale      = m_pDS->fv(15).get_asInt();
+      stream.avgrate       = m_pDS->fv(16).get_asInt();
+      stream.avgscale      = m_pDS->fv(17).get_asInt();
+      stream.aspectnum     = m_pDS->fv(18).get_asInt();
+      stream.aspectden     = m_pDS->fv(19).get_asInt();
+      stream.duration      = m_pDS->fv(20).get_asInt64();
+      stream.starttime     = m_pDS->fv(21).get_asInt64();
+      stream.extradata     = FromHex(m_pDS->fv(22).get_asString());
+      probe.streams.push_back(stream);
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return !probe.streams.empty();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on path '%s'", __FUNCTION__, path.c_str());
+  }
+  return false;
+}
+
+void CDVDProbeDatabase::SetProbe(const CStdString &path, int64_t size, int64_t mtime, const CProbe &probe)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    unsigned int hash = GetPathHash(path);
+
+    BeginTransaction();
+    CStdString sql = PrepareSQL("select idProbe from probe where pathhash=%u and strPath='%s'", hash, path.c_str());
+    m_pDS->query(sql.c_str());
+    int idProbe = -1;
+    if (!m_pDS->eof())
+      idProbe = m_pDS->fv(0).get_asInt();
+    m_pDS->close();
+
+    if (idProbe >= 0)
+    {
+      m_pDS->exec(PrepareSQL("delete from probestream where idProbe=%i", idProbe).c_str());
+      m_pDS->exec(PrepareSQL("update probe set size=%I64d, mtime=%I64d, format='%s', duration=%I64d, starttime=%I64d, bitrate=%i where idProbe=%i",
+                             size, mtime, probe.format.c_str(), probe.duration, probe.starttime, probe.bitrate, idProbe).c_str());
+    }
+    else
+    {
+      m_pDS->exec(PrepareSQL("insert into probe (idProbe, pathhash, strPath, size, mtime, format, duration, starttime, bitrate) values(NULL, %u, '%s', %I64d, %I64d, '%s', %I64d, %I64d, %i)",
+                             hash, path.c_str(), size, mtime, probe.format.c_str(), probe.duration, probe.starttime, probe.bitrate).c_str());
+      idProbe = (int)m_pDS->lastinsertid();
+    }
+
+    for (unsigned int i = 0; i < probe.streams.size(); i++)
+    {
+      const CStream &stream = probe.streams[i];
+      QueueInsertQuery(PrepareSQL("insert into probestream (idProbe, idx, type, codec, fourcc, width, height, pixfmt, samplerate, channels, samplefmt, "
+                                  "bitspersample, blockalign, bitrate, level, profile, fpsrate, fpsscale, avgrate, avgscale, aspectnum, aspectden, "
+                                  "duration, starttime, extradata) "
+                                  "values(%i, %u, %i, %i, %u, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i, %I64d, %I64d, '%s')",
+                                  idProbe, i, stream.type, stream.codec, stream.fourcc, stream.width, stream.height, stream.pixfmt,
+                                  stream.samplerate, stream.channels, stream.samplefmt, stream.bitspersample, stream.blockalign, stream.bitrate,
+                                  stream.level, stream.profile, stream.fpsrate, stream.fpsscale, stream.avgrate, stream.avgscale,
+                                  stream.aspectnum, stream.aspectden, stream.duration, stream.starttime, ToHex(stream.extradata).c_str()));
+    }
+    CommitInsertQueries();
+    CommitTransaction();
+  }
+  catch (...)
+  {
+    RollbackTransaction();
+    CLog::Log(LOGERROR, "%s failed on path '%s'", __FUNCTION__, path.c_str());
+  }
+}
+
+void CDVDProbeDatabase::RemoveProbe(const CStdString &path)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    CStdString where = PrepareSQL("pathhash=%u and strPath='%s'", GetPathHash(path), path.c_str());
+    m_pDS->exec(("delete from probestream where idProbe in (select idProbe from probe where " + where + ")").c_str());
+    m_pDS->exec(("delete from probe where " + where).c_str());
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on path '%s'", __FUNCTION__, path.c_str());
+  }
+}
+
+unsigned int CDVDProbeDatabase::GetPathHash(const CStdString &path) const
+{
+  Crc32 crc;
+  crc.Compute(path);
+  return (unsigned int)crc;
+}
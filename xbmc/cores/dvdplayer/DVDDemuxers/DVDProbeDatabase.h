@@ -0,0 +1,95 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "dbwrappers/Database.h"
+
+#include <string>
+#include <vector>
+
+/*! \brief Persistent cache of the stream layout found by probing a file
+ Probing a file with av_find_stream_info() means decoding the first frames of
+ every stream, which dominates the time it takes to open most local files.
+ The outcome is stored keyed by path, size and modification time, so reopening
+ an unchanged file can restore the codec parameters instead of probing again.
+ */
+class CDVDProbeDatabase : public CDatabase
+{
+public:
+  class CStream
+  {
+  public:
+    CStream();
+
+    int          type;      ///< AVMediaType
+    int          codec;     ///< CodecID
+    unsigned int fourcc;
+    int          width, height, pixfmt;
+    int          samplerate, channels, samplefmt;
+    int          bitspersample, blockalign, bitrate;
+    int          level, profile;
+    int          fpsrate, fpsscale;
+    int          avgrate, avgscale;
+    int          aspectnum, aspectden;
+    int64_t      duration;  ///< in stream time base
+    int64_t      starttime; ///< in stream time base
+    std::string  extradata;
+  };
+
+  class CProbe
+  {
+  public:
+    CProbe();
+
+    std::string          format;    ///< name of the input format
+    int64_t              duration;  ///< in AV_TIME_BASE
+    int64_t              starttime; ///< in AV_TIME_BASE
+    int                  bitrate;
+    std::vector<CStream> streams;
+  };
+
+  CDVDProbeDatabase();
+  virtual ~CDVDProbeDatabase();
+  virtual bool Open();
+
+  /*! \brief Retrieve the stored probe outcome of a file
+   \param path the file that was probed
+   \param size the current size of the file
+   \param mtime the current modification time of the file
+   \param probe [out] the stored outcome
+   \return true if an outcome matching size and mtime was found, false otherwise
+   */
+  bool GetProbe(const CStdString &path, int64_t size, int64_t mtime, CProbe &probe);
+
+  /*! \brief Store the probe outcome of a file, replacing any previous one */
+  void SetProbe(const CStdString &path, int64_t size, int64_t mtime, const CProbe &probe);
+
+  /*! \brief Remove the stored outcome of a file, eg. because it turned out to be wrong */
+  void RemoveProbe(const CStdString &path);
+
+protected:
+  unsigned int GetPathHash(const CStdString &path) const;
+
+  virtual bool CreateTables();
+  virtual bool UpdateOldVersion(int version);
+  virtual int GetMinVersion() const { return 1; };
+  const char *GetBaseDBName() const { return "StreamProbe"; };
+};
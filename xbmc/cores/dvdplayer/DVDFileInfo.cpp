@@ -73,20 +73,37 @@ bool CDVDFileInfo::GetFileDuration(const CStdString &path, int& duration)
 }
 
 bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &strTarget, CStreamDetails *pStreamDetails)
+{
+  std::vector<CStdString> targets;
+  std::vector<double> positions;
+  targets.push_back(strTarget);
+  positions.push_back(1.0 / 3);
+  return ExtractFrames(strPath, targets, positions, pStreamDetails) == 1;
+}
+
+int CDVDFileInfo::ExtractThumbs(const CStdString &strPath, const std::vector<CStdString> &targets, CStreamDetails *pStreamDetails)
+{
+  std::vector<double> positions;
+  for (unsigned int i = 0; i < targets.size(); i++)
+    positions.push_back((double)(i + 1) / (targets.size() + 1));
+  return ExtractFrames(strPath, targets, positions, pStreamDetails);
+}
+
+int CDVDFileInfo::ExtractFrames(const CStdString &strPath, const std::vector<CStdString> &targets, const std::vector<double> &positions, CStreamDetails *pStreamDetails)
 {
   unsigned int nTime = XbmcThreads::SystemClockMillis();
   CDVDInputStream *pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, strPath, "");
   if (!pInputStream)
   {
     CLog::Log(LOGERROR, "InputStream: Error creating stream for %s", strPath.c_str());
-    return false;
+    return 0;
   }
 
   if (pInputStream->IsStreamType(DVDSTREAM_TYPE_DVD))
   {
     CLog::Log(LOGERROR, "InputStream: dvd streams not supported for thumb extraction, file: %s", strPath.c_str());
     delete pInputStream;
-    return false;
+    return 0;
   }
 
   if (!pInputStream->Open(strPath.c_str(), ""))
@@ -94,7 +111,7 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
     CLog::Log(LOGERROR, "InputStream: Error opening, %s", strPath.c_str());
     if (pInputStream)
       delete pInputStream;
-    return false;
+    return 0;
   }
 
   CDVDDemux *pDemuxer = NULL;
@@ -106,7 +123,7 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
     {
       delete pInputStream;
       CLog::Log(LOGERROR, "%s - Error creating demuxer", __FUNCTION__);
-      return false;
+      return 0;
     }
   }
   catch(...)
@@ -115,7 +132,7 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
     if (pDemuxer)
       delete pDemuxer;
     delete pInputStream;
-    return false;
+    return 0;
   }
 
   if (pStreamDetails)
@@ -135,39 +152,68 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
     }
   }
 
-  bool bOk = false;
+  std::vector<bool> extracted(targets.size(), false);
+  int nExtracted = 0;
   if (nVideoStream != -1)
   {
-    CDVDVideoCodec *pVideoCodec;
+    CDVDVideoCodec *pVideoCodec = NULL;
 
     CDVDStreamInfo hint(*pDemuxer->GetStream(nVideoStream), true);
     hint.software = true;
 
-    if (hint.codec == CODEC_ID_MPEG2VIDEO || hint.codec == CODEC_ID_MPEG1VIDEO)
+    // only keyframes are decoded, and without deblocking, as the image is scaled
+    // down anyway. mpeg1/2 goes to ffmpeg as well, libmpeg2 is not thread safe.
+    CDVDCodecOptions dvdOptions;
+    dvdOptions.push_back(CDVDCodecOption("skip_frame", "nokey"));
+    dvdOptions.push_back(CDVDCodecOption("skip_loop_filter", "all"));
+
+    // let decoders that support it scale down while decoding, as long as the
+    // picture stays larger than the thumb
+    int lowres = 0;
+    if (hint.codec == CODEC_ID_MPEG1VIDEO || hint.codec == CODEC_ID_MPEG2VIDEO
+    ||  hint.codec == CODEC_ID_MPEG4      || hint.codec == CODEC_ID_MJPEG)
     {
-      // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
-      CDVDCodecOptions dvdOptions;
-      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
+      while (hint.width >> (lowres + 1) >= g_advancedSettings.m_thumbSize && lowres < 3)
+        lowres++;
     }
-    else
+    if (lowres)
     {
-      pVideoCodec = CDVDFactoryCodec::CreateVideoCodec( hint );
+      CDVDCodecOptions lowresOptions(dvdOptions);
+      CStdString value;
+      value.Format("%d", lowres);
+      lowresOptions.push_back(CDVDCodecOption("lowres", value));
+      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, lowresOptions);
     }
+    if (!pVideoCodec)
+      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
 
     if (pVideoCodec)
     {
       int nTotalLen = pDemuxer->GetStreamLength();
-      int nSeekTo = nTotalLen / 3;
+      DllSwScale dllSwScale;
+      dllSwScale.Load();
+      struct SwsContext *context = NULL;
+      BYTE *pOutBuf = NULL;
+      int nOutSize = 0;
 
-      CLog::Log(LOGDEBUG,"%s - seeking to pos %dms (total: %dms) in %s", __FUNCTION__, nSeekTo, nTotalLen, strPath.c_str());
-      if (pDemuxer->SeekTime(nSeekTo, true))
+      for (unsigned int i = 0; i < targets.size(); i++)
       {
+        int nSeekTo = (int)(nTotalLen * positions[i]);
+
+        if (i > 0)
+          pVideoCodec->Reset();
+
+        CLog::Log(LOGDEBUG,"%s - seeking to pos %dms (total: %dms) in %s", __FUNCTION__, nSeekTo, nTotalLen, strPath.c_str());
+        if (!pDemuxer->SeekTime(nSeekTo, true))
+          continue;
+
         DemuxPacket* pPacket = NULL;
         int iDecoderState = VC_ERROR;
         DVDVideoPicture picture;
 
         // num streams * 40 frames, should get a valid frame, if not abort.
         int abort_index = pDemuxer->GetNrOfStreams() * 40;
+        bool bKeyframeSent = false;
         do
         {
           pPacket = pDemuxer->Read();
@@ -180,12 +226,26 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
             continue;
           }
 
+          if (pPacket->keyframe)
+            bKeyframeSent = true;
           iDecoderState = pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
           CDVDDemuxUtils::FreeDemuxPacket(pPacket);
 
           if (iDecoderState & VC_ERROR)
             break;
 
+          // decoders with reordering delay hold the keyframe back until the
+          // next decoded frame, which with skipping is the next keyframe.
+          // until a keyframe went in there is nothing held back to drain.
+          if (!(iDecoderState & VC_PICTURE) && bKeyframeSent)
+          {
+            pVideoCodec->SetDecoderHint(VC_HINT_HARDDRAIN);
+            iDecoderState = pVideoCodec->Decode(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+            pVideoCodec->SetDecoderHint(0);
+            if (iDecoderState & VC_ERROR)
+              break;
+          }
+
           if (iDecoderState & VC_PICTURE)
           {
             memset(&picture, 0, sizeof(DVDVideoPicture));
@@ -200,33 +260,30 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
 
         if (iDecoderState & VC_PICTURE && !(picture.iFlags & DVP_FLAG_DROPPED))
         {
-          {
-            int nWidth = g_advancedSettings.m_thumbSize;
-            double aspect = (double)picture.iWidth / (double)picture.iHeight;
-            int nHeight = (int)((double)g_advancedSettings.m_thumbSize / aspect);
-
-            DllSwScale dllSwScale;
-            dllSwScale.Load();
-
-            BYTE *pOutBuf = new BYTE[nWidth * nHeight * 4];
-            struct SwsContext *context = dllSwScale.sws_getContext(picture.iWidth, picture.iHeight,
-                  PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-            uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
-            int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
-            uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
-            int     dstStride[] = { nWidth*4, 0, 0, 0 };
-
-            if (context)
-            {
-              dllSwScale.sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
-              dllSwScale.sws_freeContext(context);
-
-              CPicture::CreateThumbnailFromSurface(pOutBuf, nWidth, nHeight, nWidth * 4, strTarget);
-              bOk = true;
-            }
+          int nWidth = g_advancedSettings.m_thumbSize;
+          double aspect = (double)picture.iWidth / (double)picture.iHeight;
+          int nHeight = (int)((double)g_advancedSettings.m_thumbSize / aspect);
 
-            dllSwScale.Unload();
+          if (nWidth * nHeight * 4 > nOutSize)
+          {
             delete [] pOutBuf;
+            nOutSize = nWidth * nHeight * 4;
+            pOutBuf = new BYTE[nOutSize];
+          }
+          context = dllSwScale.sws_getCachedContext(context, picture.iWidth, picture.iHeight,
+                PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+          uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
+          int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
+          uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
+          int     dstStride[] = { nWidth*4, 0, 0, 0 };
+
+          if (context)
+          {
+            dllSwScale.sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
+
+            CPicture::CreateThumbnailFromSurface(pOutBuf, nWidth, nHeight, nWidth * 4, targets[i]);
+            extracted[i] = true;
+            nExtracted++;
           }
         }
         else
@@ -234,6 +291,11 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
           CLog::Log(LOGDEBUG,"%s - decode failed in %s", __FUNCTION__, strPath.c_str());
         }
       }
+
+      if (context)
+        dllSwScale.sws_freeContext(context);
+      dllSwScale.Unload();
+      delete [] pOutBuf;
       delete pVideoCodec;
     }
   }
@@ -243,16 +305,19 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
 
   delete pInputStream;
 
-  if(!bOk)
+  for (unsigned int i = 0; i < targets.size(); i++)
   {
-    XFILE::CFile file;
-    if(file.OpenForWrite(strTarget))
-      file.Close();
+    if (!extracted[i])
+    {
+      XFILE::CFile file;
+      if(file.OpenForWrite(targets[i]))
+        file.Close();
+    }
   }
 
   unsigned int nTotalTime = XbmcThreads::SystemClockMillis() - nTime;
-  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s> ", __FUNCTION__, nTotalTime, strPath.c_str());
-  return bOk;
+  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract %d of %u thumb(s) from file <%s> ", __FUNCTION__, nTotalTime, nExtracted, (unsigned int)targets.size(), strPath.c_str());
+  return nExtracted;
 }
 
 /**
@@ -22,6 +22,8 @@
 
 #include "utils/StdString.h"
 
+#include <vector>
+
 class CFileItem;
 class CDVDDemux;
 class CStreamDetails;
@@ -33,9 +35,16 @@ public:
   // Extract a thumbnail immage from the media at strPath an image file in strTarget, optionally populating a streamdetails class with the data
   static bool ExtractThumb(const CStdString &strPath, const CStdString &strTarget, CStreamDetails *pStreamDetails);
 
+  // Extract evenly spaced images (eg. for a chapter or scrub strip) from a single open of the media into targets, returns the number extracted
+  static int ExtractThumbs(const CStdString &strPath, const std::vector<CStdString> &targets, CStreamDetails *pStreamDetails = NULL);
+
   // Probe the files streams and store the info in the VideoInfoTag
   static bool GetFileStreamDetails(CFileItem *pItem);
   static bool DemuxerToStreamDetails(CDVDInputStream* pInputStream, CDVDDemux *pDemux, CStreamDetails &details, const CStdString &path = "");
 
   static bool GetFileDuration(const CStdString &path, int &duration);
+
+private:
+  // Decode the keyframes at the given fractions of the duration and write them to the targets
+  static int ExtractFrames(const CStdString &strPath, const std::vector<CStdString> &targets, const std::vector<double> &positions, CStreamDetails *pStreamDetails);
 };
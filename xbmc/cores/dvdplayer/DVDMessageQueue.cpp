@@ -27,6 +27,8 @@
 #include "utils/MathUtils.h"
 #include "utils/TimeUtils.h"
 
+#include <limits.h>
+
 using namespace std;
 
 CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true)
@@ -37,6 +39,9 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true)
   m_bInitialized  = false;
   m_bCaching      = false;
   m_bEmptied      = true;
+  m_iCount        = 0;
+  m_iWaiting      = 0;
+  m_iWaitPriority = INT_MAX;
 
   m_TimeBack      = DVD_NOPTS_VALUE;
   m_TimeFront     = DVD_NOPTS_VALUE;
@@ -63,12 +68,32 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
   CSingleLock lock(m_section);
 
-  for(SList::iterator it = m_list.begin(); it != m_list.end();)
+  if (type == CDVDMsg::NONE)
   {
-    if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
-      it = m_list.erase(it);
-    else
-      it++;
+    m_lanes.clear();
+    m_counts.clear();
+    m_iCount = 0;
+  }
+  else if (m_counts[type] > 0)
+  {
+    for (SLanes::iterator lane = m_lanes.begin(); lane != m_lanes.end();)
+    {
+      SLane& items = lane->second;
+      for (SLane::iterator it = items.begin(); it != items.end();)
+      {
+        if (it->message->IsType(type))
+          it = items.erase(it);
+        else
+          it++;
+      }
+
+      if (items.empty())
+        m_lanes.erase(lane++);
+      else
+        lane++;
+    }
+    m_iCount -= m_counts[type];
+    m_counts[type] = 0;
   }
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
@@ -117,14 +142,9 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     return MSGQ_INVALID_MSG;
   }
 
-  SList::iterator it = m_list.begin();
-  while(it != m_list.end())
-  {
-    if(priority <= it->priority)
-      break;
-    it++;
-  }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  m_lanes[priority].push_back(DVDMessageListItem(pMsg, priority));
+  m_counts[pMsg->GetMessageType()]++;
+  m_iCount++;
 
   if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
   {
@@ -143,7 +163,9 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 
   pMsg->Release();
 
-  m_hEvent.Set(); // inform waiter for new packet
+  // inform waiter for new packet, unless nobody waits for this priority
+  if (m_iWaiting > 0 && priority >= m_iWaitPriority)
+    m_hEvent.Set();
 
   return MSGQ_OK;
 }
@@ -162,7 +184,7 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(m_iCount == 0 && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
     m_bEmptied = true;
@@ -171,9 +193,10 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
   int64_t start = CurrentHostCounter();
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    SLanes::reverse_iterator lane = m_lanes.rbegin();
+    if(lane != m_lanes.rend() && lane->first >= priority && !m_bCaching)
     {
-      DVDMessageListItem& item(m_list.back());
+      DVDMessageListItem& item(lane->second.front());
       priority = item.priority;
 
       if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
@@ -193,7 +216,11 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
       }
 
       *pMsg = item.message->Acquire();
-      m_list.pop_back();
+      m_counts[item.message->GetMessageType()]--;
+      m_iCount--;
+      lane->second.pop_front();
+      if (lane->second.empty())
+        m_lanes.erase(lane->first);
 
       ret = MSGQ_OK;
       break;
@@ -207,13 +234,20 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     else
     {
       m_hEvent.Reset();
+      m_iWaiting++;
+      if (priority < m_iWaitPriority)
+        m_iWaitPriority = priority;
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
-        return MSGQ_TIMEOUT;
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
 
       lock.Enter();
+      if (--m_iWaiting == 0)
+        m_iWaitPriority = INT_MAX;
+
+      if (!signaled)
+        return MSGQ_TIMEOUT;
     }
   }
 
@@ -230,14 +264,10 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
   if (!m_bInitialized)
     return 0;
 
-  unsigned count = 0;
-  for(SList::iterator it = m_list.begin(); it != m_list.end();it++)
-  {
-    if(it->message->IsType(type))
-      count++;
-  }
-
-  return count;
+  std::map<CDVDMsg::Message, unsigned>::const_iterator it = m_counts.find(type);
+  if (it == m_counts.end())
+    return 0;
+  return it->second;
 }
 
 void CDVDMessageQueue::WaitUntilEmpty()
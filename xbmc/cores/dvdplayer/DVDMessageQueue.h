@@ -24,6 +24,8 @@
 #include "DVDMessage.h"
 #include <string>
 #include <list>
+#include <deque>
+#include <map>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
@@ -138,7 +140,15 @@ private:
   bool m_bEmptied;
   std::string m_owner;
 
-  typedef std::list<DVDMessageListItem> SList;
-  SList m_list;
+  // one FIFO lane per priority, only non empty lanes are kept
+  typedef std::deque<DVDMessageListItem> SLane;
+  typedef std::map<int, SLane> SLanes;
+  SLanes m_lanes;
+
+  std::map<CDVDMsg::Message, unsigned> m_counts; ///< queued messages per type
+  unsigned m_iCount;                             ///< queued messages in total
+
+  int m_iWaiting;      ///< threads waiting in Get()
+  int m_iWaitPriority; ///< lowest priority asked for by a waiting thread
 };
 
@@ -22,6 +22,7 @@
 #include "DVDPerformanceCounter.h"
 #include "DVDMessageQueue.h"
 #include "utils/TimeUtils.h"
+#include "utils/log.h"
 
 #include "dvd_config.h"
 
@@ -155,4 +156,3 @@ void CDVDPerformanceCounter::DeInitialize()
 {
 
 }
-
@@ -32,6 +32,7 @@
 
 #include "DVDDemuxers/DVDDemux.h"
 #include "DVDDemuxers/DVDDemuxUtils.h"
+#include "DVDDemuxers/DVDDemuxPacketPool.h"
 #include "DVDDemuxers/DVDDemuxVobsub.h"
 #include "DVDDemuxers/DVDFactoryDemuxer.h"
 #include "DVDDemuxers/DVDDemuxFFmpeg.h"
@@ -78,11 +79,79 @@
 #include "dialogs/GUIDialogBusy.h"
 #include "dialogs/GUIDialogKaiToast.h"
 #include "utils/StringUtils.h"
+#include "utils/JobManager.h"
 #include "Util.h"
 
 using namespace std;
 using namespace PVR;
 
+// time (in ms) before the end of a file at which the next playlist item is opened
+#define DVDPLAYER_PREOPEN_TIME 20000
+
+/*! \brief Opens the input stream and demuxer of an upcoming item
+ Opening a network file and probing its streams can take several seconds, so
+ this is done while the previous item is still playing.  The opened objects
+ are handed to the player on completion, anything not taken is freed with the
+ job.
+ */
+class CDVDPreOpenJob : public CJob
+{
+public:
+  CDVDPreOpenJob(const CFileItem &item)
+    : m_item(item)
+  {
+    m_filename = item.GetPath();
+    m_mimetype = item.GetMimeType();
+    m_pInputStream = NULL;
+    m_pDemuxer = NULL;
+  }
+
+  virtual ~CDVDPreOpenJob()
+  {
+    delete m_pDemuxer;
+    delete m_pInputStream;
+  }
+
+  virtual const char *GetType() const { return "dvdpreopen"; }
+
+  virtual bool DoWork()
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+
+    m_pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, m_filename, m_mimetype);
+    if (!m_pInputStream || !m_pInputStream->IsStreamType(DVDSTREAM_TYPE_FILE))
+      return false;
+
+    m_pInputStream->SetFileItem(m_item);
+    if (!m_pInputStream->Open(m_filename.c_str(), m_mimetype))
+    {
+      CLog::Log(LOGDEBUG, "%s - unable to open [%s]", __FUNCTION__, m_filename.c_str());
+      return false;
+    }
+
+    try
+    {
+      m_pDemuxer = CDVDFactoryDemuxer::CreateDemuxer(m_pInputStream);
+    }
+    catch(...)
+    {
+      CLog::Log(LOGERROR, "%s - Exception thrown when opening demuxer", __FUNCTION__);
+      m_pDemuxer = NULL;
+    }
+    if (!m_pDemuxer)
+      return false;
+
+    CLog::Log(LOGDEBUG, "%s - opened [%s] in %u ms", __FUNCTION__, m_filename.c_str(), XbmcThreads::SystemClockMillis() - start);
+    return true;
+  }
+
+  CFileItem        m_item;
+  std::string      m_filename;
+  std::string      m_mimetype;
+  CDVDInputStream* m_pInputStream;
+  CDVDDemux*       m_pDemuxer;
+};
+
 void CSelectionStreams::Clear(StreamType type, StreamSource source)
 {
   CSingleLock lock(m_section);
@@ -314,8 +383,15 @@ CDVDPlayer::CDVDPlayer(IPlayerCallback& callback)
 {
   m_pDemuxer = NULL;
   m_pSubtitleDemuxer = NULL;
+  m_pPreOpenedDemuxer = NULL;
+  m_readRate = 0;
   m_pInputStream = NULL;
 
+  m_nextQueued = false;
+  m_nextJob = 0;
+  m_pNextInputStream = NULL;
+  m_pNextDemuxer = NULL;
+
   m_dvd.Clear();
   m_State.Clear();
   m_UpdateApplication = 0;
@@ -333,6 +409,7 @@ CDVDPlayer::CDVDPlayer(IPlayerCallback& callback)
 CDVDPlayer::~CDVDPlayer()
 {
   CloseFile();
+  DiscardPreOpened();
 
 #ifdef DVDDEBUG_MESSAGE_TRACKER
   g_dvdMessageTracker.DeInit();
@@ -362,6 +439,7 @@ bool CDVDPlayer::OpenFile(const CFileItem& file, const CPlayerOptions &options)
     m_filename = file.GetPath();
     m_scanStart = 0;
     m_refreshChanging = false;
+    m_nextQueued = false;
 
     m_ready.Reset();
     Create();
@@ -425,6 +503,112 @@ bool CDVDPlayer::CloseFile()
   return true;
 }
 
+bool CDVDPlayer::QueueNextFile(const CFileItem &file)
+{
+  // only plain files are opened ahead, discs, stacks and live streams
+  // need the player (or the application) to set them up
+  if (m_PlayerOptions.identify
+  ||  file.IsStack()
+  ||  file.IsPlayList()
+  ||  file.IsLiveTV()
+  ||  file.IsDVDImage()
+  ||  file.IsDVDFile(false, true)
+  ||  file.IsType(".bdmv")
+  ||  file.IsType(".mpls"))
+    return false;
+
+  CSingleLock lock(m_nextSection);
+  if (m_nextFilename == file.GetPath())
+    return false;
+
+  DiscardPreOpened();
+
+  CLog::Log(LOGDEBUG, "%s - opening next item [%s]", __FUNCTION__, file.GetPath().c_str());
+  m_nextFilename = file.GetPath();
+  m_nextMimetype = file.GetMimeType();
+  m_nextJob = CJobManager::GetInstance().AddJob(new CDVDPreOpenJob(file), this);
+
+  // the item is still started through the playlist player once this one
+  // ends, OpenInputStream() then takes over what has been opened here
+  return false;
+}
+
+void CDVDPlayer::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_nextSection);
+  if (jobID != m_nextJob)
+    return;
+
+  m_nextJob = 0;
+  CDVDPreOpenJob *preOpen = (CDVDPreOpenJob*)job;
+  if (!success)
+  {
+    m_nextFilename.clear();
+    return;
+  }
+
+  m_pNextInputStream = preOpen->m_pInputStream;
+  m_pNextDemuxer     = preOpen->m_pDemuxer;
+  preOpen->m_pInputStream = NULL;
+  preOpen->m_pDemuxer     = NULL;
+}
+
+bool CDVDPlayer::TakePreOpened()
+{
+  CSingleLock lock(m_nextSection);
+  if (!m_pNextInputStream
+  ||  m_nextFilename != m_filename
+  ||  m_nextMimetype != m_mimetype)
+  {
+    DiscardPreOpened();
+    return false;
+  }
+
+  CLog::Log(LOGNOTICE, "%s - using input stream and demuxer opened ahead for [%s]", __FUNCTION__, m_filename.c_str());
+  m_pInputStream      = m_pNextInputStream;
+  m_pPreOpenedDemuxer = m_pNextDemuxer;
+  m_pNextInputStream  = NULL;
+  m_pNextDemuxer      = NULL;
+  m_nextFilename.clear();
+  m_nextMimetype.clear();
+  return true;
+}
+
+void CDVDPlayer::DiscardPreOpened()
+{
+  CSingleLock lock(m_nextSection);
+  if (m_nextJob)
+    CJobManager::GetInstance().CancelJob(m_nextJob);
+  m_nextJob = 0;
+
+  SAFE_DELETE(m_pNextDemuxer);
+  SAFE_DELETE(m_pNextInputStream);
+  m_nextFilename.clear();
+  m_nextMimetype.clear();
+}
+
+void CDVDPlayer::CheckQueueNextItem()
+{
+  if (m_nextQueued || m_PlayerOptions.identify)
+    return;
+
+  if (m_pInputStream->IsStreamType(DVDSTREAM_TYPE_DVD)
+  ||  m_pInputStream->IsStreamType(DVDSTREAM_TYPE_TV)
+  ||  m_pInputStream->IsStreamType(DVDSTREAM_TYPE_PVRMANAGER)
+  ||  m_pInputStream->IsStreamType(DVDSTREAM_TYPE_HTSP))
+    return;
+
+  {
+    CSingleLock lock(m_StateSection);
+    if (m_State.time_total <= 0
+    ||  m_State.time_total - m_State.time > DVDPLAYER_PREOPEN_TIME)
+      return;
+  }
+
+  m_nextQueued = true;
+  m_callback.OnQueueNextItem();
+}
+
 bool CDVDPlayer::IsPlaying() const
 {
   return !m_bStop;
@@ -440,6 +624,9 @@ void CDVDPlayer::OnStartup()
   m_messenger.Init();
 
   g_dvdPerformanceCounter.EnableMainPerformance(this);
+  m_demuxStats.Start();
+  m_cacheEstimator.Reset();
+  m_readRate = 0;
 }
 
 bool CDVDPlayer::OpenInputStream()
@@ -457,8 +644,11 @@ bool CDVDPlayer::OpenInputStream()
   {
     m_filename = g_mediaManager.TranslateDevicePath("");
   }
+
+  bool preopened = TakePreOpened();
 retry:
-  m_pInputStream = CDVDFactoryInputStream::CreateInputStream(this, m_filename, m_mimetype);
+  if (!preopened)
+    m_pInputStream = CDVDFactoryInputStream::CreateInputStream(this, m_filename, m_mimetype);
   if(m_pInputStream == NULL)
   {
     CLog::Log(LOGERROR, "CDVDPlayer::OpenInputStream - unable to create input stream for [%s]", m_filename.c_str());
@@ -467,7 +657,7 @@ retry:
   else
     m_pInputStream->SetFileItem(m_item);
 
-  if (!m_pInputStream->Open(m_filename.c_str(), m_mimetype))
+  if (!preopened && !m_pInputStream->Open(m_filename.c_str(), m_mimetype))
   {
       if(m_pInputStream->IsStreamType(DVDSTREAM_TYPE_DVD))
       {
@@ -539,10 +729,16 @@ bool CDVDPlayer::OpenDemuxStream()
 
   CLog::Log(LOGNOTICE, "Creating Demuxer");
 
+  if (m_pPreOpenedDemuxer)
+  {
+    m_pDemuxer = m_pPreOpenedDemuxer;
+    m_pPreOpenedDemuxer = NULL;
+  }
+
   try
   {
     int attempts = 10;
-    while(!m_bStop && attempts-- > 0)
+    while(!m_pDemuxer && !m_bStop && attempts-- > 0)
     {
       m_pDemuxer = CDVDFactoryDemuxer::CreateDemuxer(m_pInputStream);
       if(!m_pDemuxer && m_pInputStream->IsStreamType(DVDSTREAM_TYPE_PVRMANAGER))
@@ -576,8 +772,12 @@ bool CDVDPlayer::OpenDemuxStream()
 
   int64_t len = m_pInputStream->GetLength();
   int64_t tim = m_pDemuxer->GetStreamLength();
+  m_readRate = 0;
   if(len > 0 && tim > 0)
-    m_pInputStream->SetReadRate(len * 1000 / tim);
+  {
+    m_readRate = (unsigned)(len * 1000 / tim);
+    m_pInputStream->SetReadRate(m_readRate);
+  }
 
   return true;
 }
@@ -783,10 +983,17 @@ bool CDVDPlayer::ReadPacket(DemuxPacket*& packet, CDemuxStream*& stream)
 
   // read a data frame from stream.
   if(m_pDemuxer)
+  {
+    int64_t readStart = CurrentHostCounter();
     packet = m_pDemuxer->Read();
+    m_demuxStats.AddDecode(CurrentHostCounter() - readStart);
+  }
 
   if(packet)
   {
+    m_demuxStats.AddFrame();
+    m_cacheEstimator.AddPacket(packet->iSize, packet->dts);
+
     // this groupId stuff is getting a bit messy, need to find a better way
     // currently it is used to determine if a menu overlay is associated with a picture
     // for dvd's we use as a group id, the current cell and the current title
@@ -1069,6 +1276,9 @@ void CDVDPlayer::Process()
     // update application with our state
     UpdateApplication(1000);
 
+    // get the next item ready before this one ends
+    CheckQueueNextItem();
+
     if (CheckDelayedChannelEntry())
       continue;
 
@@ -1423,6 +1633,13 @@ bool CDVDPlayer::GetCachingTimes(double& level, double& delay, double& offset)
     return false;
 
   double play_sbp  = DVD_MSEC_TO_TIME(m_pDemuxer->GetStreamLength()) / length;
+
+  // the file average hides peaks of variable bitrate content, plan with
+  // the measured bitrate when it is higher
+  unsigned stream_rate = m_cacheEstimator.GetStreamRate();
+  if(stream_rate > 0)
+    play_sbp = std::min(play_sbp, (double)DVD_TIME_BASE / stream_rate);
+
   double queued = 1000.0 * GetQueueTime() / play_sbp;
 
   delay  = 0.0;
@@ -1438,7 +1655,13 @@ bool CDVDPlayer::GetCachingTimes(double& level, double& delay, double& offset)
     return true;
   }
 
-  double cache_sbp   = 1.1 * (double)DVD_TIME_BASE / rate;            /* underestimate by 10 % */
+  /* plan with the pessimistic measured rate, or underestimate the average by 10 % until there is one */
+  unsigned input_rate = m_cacheEstimator.GetInputRate();
+  double cache_sbp;
+  if(input_rate > 0)
+    cache_sbp = (double)DVD_TIME_BASE / std::min(input_rate, rate);
+  else
+    cache_sbp = 1.1 * (double)DVD_TIME_BASE / rate;
   double play_left   = play_sbp  * (remain + queued);                 /* time to play out all remaining bytes */
   double cache_left  = cache_sbp * (remain - cached);                 /* time to cache the remaining bytes */
   double cache_need  = std::max(0.0, remain - play_left / cache_sbp); /* bytes needed until play_left == cache_left */
@@ -1714,6 +1937,10 @@ void CDVDPlayer::CheckContinuity(CCurrentStream& current, DemuxPacket* pPacket)
   if (m_playSpeed < DVD_PLAYSPEED_PAUSE)
     return;
 
+  // demuxers may jump from keyframe to keyframe at these speeds
+  if (m_playSpeed > 4 * DVD_PLAYSPEED_NORMAL)
+    return;
+
   if( pPacket->dts == DVD_NOPTS_VALUE )
     return;
 
@@ -1964,6 +2191,7 @@ void CDVDPlayer::SendPlayerMessage(CDVDMsg* pMsg, unsigned int target)
 void CDVDPlayer::OnExit()
 {
   g_dvdPerformanceCounter.DisableMainPerformance();
+  m_demuxStats.Report("demux");
 
   try
   {
@@ -1995,6 +2223,7 @@ void CDVDPlayer::OnExit()
       CloseTeletextStream(!m_bAbortRequest);
     }
     // destroy the demuxer
+    SAFE_DELETE(m_pPreOpenedDemuxer);
     if (m_pDemuxer)
     {
       CLog::Log(LOGNOTICE, "CDVDPlayer::OnExit() deleting demuxer");
@@ -2022,6 +2251,10 @@ void CDVDPlayer::OnExit()
 
     m_messenger.End();
 
+    // hand the buffers of this file back, the next one may use other sizes
+    CDVDDemuxPacketPool::Get().LogStats();
+    CDVDDemuxPacketPool::Get().Purge();
+
   }
   catch (...)
   {
@@ -2612,6 +2845,10 @@ void CDVDPlayer::GetGeneralInfo(CStdString& strGeneralInfo)
                          , m_State.cache_level * 100);
       if(m_playSpeed == 0 || m_caching == CACHESTATE_FULL)
         strBuf.AppendFormat(" %d sec", DVD_TIME_TO_SEC(m_State.cache_delay));
+      if(m_State.cache_input > 0 || m_State.cache_stream > 0)
+        strBuf.AppendFormat(" in:%.1f br:%.1f Mbit/s"
+                           , m_State.cache_input  * 8.0 / 1000000
+                           , m_State.cache_stream * 8.0 / 1000000);
     }
 
     strGeneralInfo.Format("C( ad:% 6.3f, a/v:% 6.3f%s, dcpu:%2i%% acpu:%2i%% vcpu:%2i%%%s )"
@@ -3101,6 +3338,7 @@ bool CDVDPlayer::CloseAudioStream(bool bWaitForBuffers)
   m_dvdPlayerAudio.CloseStream(bWaitForBuffers);
 
   m_CurrentAudio.Clear();
+  CDVDDemuxPacketPool::Get().Trim();
   return true;
 }
 
@@ -3117,6 +3355,7 @@ bool CDVDPlayer::CloseVideoStream(bool bWaitForBuffers)
   m_dvdPlayerVideo.CloseStream(bWaitForBuffers);
 
   m_CurrentVideo.Clear();
+  CDVDDemuxPacketPool::Get().Trim();
   return true;
 }
 
@@ -3130,6 +3369,7 @@ bool CDVDPlayer::CloseSubtitleStream(bool bKeepOverlays)
   m_dvdPlayerSubtitle.CloseStream(!bKeepOverlays);
 
   m_CurrentSubtitle.Clear();
+  CDVDDemuxPacketPool::Get().Trim();
   return true;
 }
 
@@ -3146,6 +3386,7 @@ bool CDVDPlayer::CloseTeletextStream(bool bWaitForBuffers)
   m_dvdPlayerTeletext.CloseStream(bWaitForBuffers);
 
   m_CurrentTeletext.Clear();
+  CDVDDemuxPacketPool::Get().Trim();
   return true;
 }
 
@@ -3217,6 +3458,9 @@ void CDVDPlayer::FlushBuffers(bool queued, double pts, bool accurate)
       m_clock.Discontinuity(pts);
     UpdatePlayState(0);
   }
+
+  // the flushed packets are back in the pool, don't keep all of them cached
+  CDVDDemuxPacketPool::Get().Trim();
 }
 
 // since we call ffmpeg functions to decode, this is being called in the same thread as ::Process() is
@@ -3905,6 +4149,23 @@ void CDVDPlayer::UpdatePlayState(double timeout)
   else
     m_State.demux_video = "";
 
+  if(m_pInputStream)
+  {
+    int64_t cached = m_pInputStream->GetCachedBytes();
+    if(cached >= 0)
+      m_cacheEstimator.AddInput(m_pInputStream->Seek(0, SEEK_CUR) + cached, m_pInputStream->GetReadRate() == (unsigned)-1);
+
+    // let the cache fetch faster if the content peaks above the rate it was limited to
+    unsigned stream_rate = m_cacheEstimator.GetStreamRate();
+    if(m_readRate > 0 && stream_rate > m_readRate + m_readRate / 10)
+    {
+      m_readRate = stream_rate;
+      m_pInputStream->SetReadRate(m_readRate);
+    }
+  }
+  m_State.cache_input  = m_cacheEstimator.GetInputRate();
+  m_State.cache_stream = m_cacheEstimator.GetStreamRate();
+
   double level, delay, offset;
   if(GetCachingTimes(level, delay, offset))
   {
@@ -28,6 +28,7 @@
 
 #include "DVDMessageQueue.h"
 #include "DVDClock.h"
+#include "DVDCacheEstimator.h"
 #include "DVDPlayerAudio.h"
 #include "DVDPlayerVideo.h"
 #include "DVDPlayerSubtitle.h"
@@ -40,6 +41,7 @@
 #include "Edl.h"
 #include "FileItem.h"
 #include "threads/SingleLock.h"
+#include "utils/Job.h"
 
 
 class CDVDInputStream;
@@ -143,7 +145,7 @@ public:
 #define DVDPLAYER_SUBTITLE 3
 #define DVDPLAYER_TELETEXT 4
 
-class CDVDPlayer : public IPlayer, public CThread, public IDVDPlayer
+class CDVDPlayer : public IPlayer, public CThread, public IDVDPlayer, public IJobCallback
 {
 public:
   CDVDPlayer(IPlayerCallback& callback);
@@ -152,6 +154,7 @@ public:
   virtual void UnRegisterAudioCallback()                        { m_dvdPlayerAudio.UnRegisterAudioCallback(); }
   virtual bool OpenFile(const CFileItem& file, const CPlayerOptions &options);
   virtual bool CloseFile();
+  virtual bool QueueNextFile(const CFileItem &file);
   virtual bool IsPlaying() const;
   virtual void Pause();
   virtual bool IsPaused() const;
@@ -247,6 +250,8 @@ public:
 
   virtual void PauseRefreshChanging();
   virtual void NotifyRefreshChanged();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
 protected:
   friend class CSelectionStreams;
 
@@ -316,6 +321,12 @@ protected:
   bool OpenDemuxStream();
   void OpenDefaultStreams();
 
+  /*! \brief Ask the application for the next item once the end of the current one is near */
+  void CheckQueueNextItem();
+  /*! \brief Take over the input stream and demuxer pre-opened for the current file, if any */
+  bool TakePreOpened();
+  void DiscardPreOpened();
+
   void UpdateApplication(double timeout);
   void UpdatePlayState(double timeout);
   double m_UpdateApplication;
@@ -336,6 +347,9 @@ protected:
   CCurrentStream m_CurrentTeletext;
 
   CSelectionStreams m_SelectionStreams;
+  CDVDStreamStats   m_demuxStats;
+  CDVDCacheEstimator m_cacheEstimator;
+  unsigned          m_readRate;     // rate limit passed to the input stream's cache, bytes per second
 
   int m_playSpeed;
   struct SSpeedState
@@ -359,6 +373,16 @@ protected:
   CDVDInputStream* m_pInputStream;  // input stream for current playing file
   CDVDDemux* m_pDemuxer;            // demuxer for current playing file
   CDVDDemux* m_pSubtitleDemuxer;
+  CDVDDemux* m_pPreOpenedDemuxer;   // demuxer opened ahead of time for m_pInputStream, until OpenDemuxStream takes it
+
+  // the next item of the playlist is opened in the background while the current one plays out
+  CCriticalSection m_nextSection;
+  bool             m_nextQueued;    // whether the next item has been requested for the current file
+  unsigned int     m_nextJob;       // job opening the next item, 0 if none is running
+  std::string      m_nextFilename;
+  std::string      m_nextMimetype;
+  CDVDInputStream* m_pNextInputStream;
+  CDVDDemux*       m_pNextDemuxer;
 
   CStdString m_lastSub;
   
@@ -402,6 +426,8 @@ protected:
       cache_level   = 0.0;
       cache_delay   = 0.0;
       cache_offset  = 0.0;
+      cache_input   = 0;
+      cache_stream  = 0;
     }
 
     double timestamp;         // last time of update
@@ -427,6 +453,8 @@ protected:
     double  cache_level;   // current estimated required cache level
     double  cache_delay;   // time until cache is expected to reach estimated level
     double  cache_offset;  // percentage of file ahead of current position
+    unsigned cache_input;  // pessimistic rate the cache is filled at, bytes per second
+    unsigned cache_stream; // pessimistic bitrate of the content, bytes per second
   } m_State;
   CCriticalSection m_StateSection;
 
@@ -302,7 +302,9 @@ int CDVDPlayerAudio::DecodeFrame(DVDAudioFrame &audioframe, bool bDropPacket)
       if (dts != DVD_NOPTS_VALUE)
         m_audioClock = dts;
 
+      int64_t decodeStart = CurrentHostCounter();
       int len = m_pAudioCodec->Decode(m_decode.data, m_decode.size);
+      m_decodeStats.AddDecode(CurrentHostCounter() - decodeStart, m_messageQueue.GetLevel());
       m_audioStats.AddSampleBytes(m_decode.size);
       if (len < 0)
       {
@@ -369,13 +371,17 @@ int CDVDPlayerAudio::DecodeFrame(DVDAudioFrame &audioframe, bool bDropPacket)
 
       // if demux source want's us to not display this, continue
       if(m_decode.msg->GetPacketDrop())
+      {
+        m_decodeStats.AddFrame(true);
         continue;
+      }
 
       //If we are asked to drop this packet, return a size of zero. then it won't be played
       //we currently still decode the audio.. this is needed since we still need to know it's
       //duration to make sure clock is updated correctly.
       if( bDropPacket )
         result |= DECODE_FLAG_DROP;
+      m_decodeStats.AddFrame(bDropPacket);
 
       return result;
     }
@@ -519,6 +525,7 @@ void CDVDPlayerAudio::OnStartup()
   m_decode.Release();
 
   g_dvdPerformanceCounter.EnableAudioDecodePerformance(this);
+  m_decodeStats.Start();
 
 #ifdef _WIN32
   CoInitializeEx(NULL, COINIT_MULTITHREADED);
@@ -858,6 +865,7 @@ bool CDVDPlayerAudio::OutputPacket(DVDAudioFrame &audioframe)
 void CDVDPlayerAudio::OnExit()
 {
   g_dvdPerformanceCounter.DisableAudioDecodePerformance();
+  m_decodeStats.Report("audio");
 
 #ifdef _WIN32
   CoUninitialize();
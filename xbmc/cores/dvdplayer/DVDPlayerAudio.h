@@ -28,6 +28,7 @@
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "DVDStreamInfo.h"
 #include "utils/BitstreamStats.h"
+#include "DVDStreamStats.h"
 #include "DVDPlayerAudioResampler.h"
 
 #include <list>
@@ -172,6 +173,7 @@ protected:
   CDVDClock* m_pClock; // dvd master clock
   CDVDAudioCodec* m_pAudioCodec; // audio codec
   BitstreamStats m_audioStats;
+  CDVDStreamStats m_decodeStats;
 
   int     m_speed;
   double  m_droptime;
@@ -322,6 +322,7 @@ void CDVDPlayerVideo::OnStartup()
   m_iCurrentPts = DVD_NOPTS_VALUE;
 
   g_dvdPerformanceCounter.EnableVideoDecodePerformance(this);
+  m_decodeStats.Start();
 }
 
 void CDVDPlayerVideo::Process()
@@ -680,7 +681,9 @@ CLog::Log(LOGDEBUG, "ASB: CDVDPlayerVideo VC_HINT_HARDDRAIN");
         int iConvergeCount = m_pVideoCodec->GetConvergeCount();
 
 CLog::Log(LOGDEBUG,"ASB: CDVDPlayerVideo::Process about to decode pts: %f drop: %i", pPacket->pts, (int)bRequestDrop);
+        int64_t decodeStart = CurrentHostCounter();
         iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+        m_decodeStats.AddDecode(CurrentHostCounter() - decodeStart, m_messageQueue.GetLevel());
         //if (iDecoderState & VC_AGAIN)
         //  CLog::Log(LOGDEBUG, "ASB: CDVDPlayerVideo iDecoderState: VC_AGAIN");
 
@@ -791,6 +794,7 @@ CLog::Log(LOGDEBUG, "ASB: CDVDPlayerVideo hurry up m_fLastDecodedPictureClock: %
         if (iDecoderState & VC_PICTURE)
         {
           // we have decoded a picture for output
+          m_decodeStats.AddFrame();
           m_fPrevLastDecodedPictureClock = m_fLastDecodedPictureClock;
           m_fLastDecodedPictureClock = fDecodedPictureClock;
 
@@ -1436,6 +1440,7 @@ void CDVDPlayerVideo::ResetDropInfo()
 void CDVDPlayerVideo::OnExit()
 {
   g_dvdPerformanceCounter.DisableVideoDecodePerformance();
+  m_decodeStats.Report("video", m_iDroppedFrames);
 
 //TODO: sort out locking for m_pOverlayCodecCC
   if (m_pOverlayCodecCC)
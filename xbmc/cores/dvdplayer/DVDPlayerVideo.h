@@ -28,6 +28,7 @@
 #include "DVDClock.h"
 #include "DVDOverlayContainer.h"
 #include "DVDTSCorrection.h"
+#include "DVDStreamStats.h"
 #ifdef HAS_VIDEO_PLAYBACK
 #include "cores/VideoRenderers/RenderManager.h"
 #endif
@@ -258,6 +259,7 @@ protected:
 //  unsigned int m_autosync;
 
   BitstreamStats m_videoStats;
+  CDVDStreamStats m_decodeStats;
 
   // classes
   CDVDStreamInfo m_hints;
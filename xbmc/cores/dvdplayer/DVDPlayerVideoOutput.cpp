@@ -34,6 +34,7 @@
 
 CDVDPlayerVideoOutput::CDVDPlayerVideoOutput(CDVDPlayerVideo *videoplayer, CDVDClock* pClock)
 : CThread("Video Output Thread")
+, m_postProcess("")
 {
   m_pVideoPlayer = videoplayer;
   m_pts = 0;
@@ -44,6 +45,7 @@ CDVDPlayerVideoOutput::CDVDPlayerVideoOutput(CDVDPlayerVideo *videoplayer, CDVDC
   m_recover = true;
   m_configuring = false;
   m_pClock = pClock;
+  m_resetPostProcess = false;
   memset(&m_picture, 0, sizeof(DVDVideoPicture));
 }
 
@@ -83,6 +85,7 @@ void CDVDPlayerVideoOutput::Reset(bool resetConfigure /* = false */)
 
     memset(&m_picture, 0, sizeof(DVDVideoPicture));
     m_state = VO_STATE_WAITINGPLAYERSTART;
+    m_resetPostProcess = true;
   }
 
   if (bRecover)
@@ -616,7 +619,6 @@ bool CDVDPlayerVideoOutput::GetPicture(double& pts, double& frametime, bool drop
   bool bReturn = false;
 
   DVDVideoPicture picture;
-  CDVDVideoPPFFmpeg mPostProcess("");
   CStdString sPostProcessType;
 
   // try to retrieve the picture (should never fail!), unless there is a demuxer bug ofcours
@@ -649,7 +651,13 @@ CLog::Log(LOGDEBUG, "ASB: CDVDPlayerVideoOutput::GetPicture pts: %f", m_picture.
     {
       if(!(mFilters & CDVDVideoCodec::FILTER_DEINTERLACE_ANY))
       {
-        if((mInt == VS_INTERLACEMETHOD_DEINTERLACE)
+        if(mInt == VS_INTERLACEMETHOD_DEINTERLACE_TEMPORAL_HALF)
+        {
+          if (!sPostProcessType.empty())
+            sPostProcessType += ",";
+          sPostProcessType += "yadif";
+        }
+        else if((mInt == VS_INTERLACEMETHOD_DEINTERLACE)
         || (mInt == VS_INTERLACEMETHOD_AUTO && !g_renderManager.Supports(VS_INTERLACEMETHOD_RENDER_BOB)
                                             && !g_renderManager.Supports(VS_INTERLACEMETHOD_DXVA_ANY)))
         {
@@ -668,11 +676,20 @@ CLog::Log(LOGDEBUG, "ASB: CDVDPlayerVideoOutput::GetPicture pts: %f", m_picture.
       sPostProcessType += g_advancedSettings.m_videoPPFFmpegPostProc;
     }
 
+    { CSingleLock lock(m_criticalSection);
+      if (m_resetPostProcess)
+      {
+        // the previous picture is from before the flush, don't filter against it
+        m_postProcess.Reset();
+        m_resetPostProcess = false;
+      }
+    }
+
     if (!sPostProcessType.empty())
     {
-      mPostProcess.SetType(sPostProcessType);
-      if (mPostProcess.Process(&m_picture))
-        mPostProcess.GetPicture(&m_picture);
+      m_postProcess.SetType(sPostProcessType);
+      if (m_postProcess.Process(&m_picture))
+        m_postProcess.GetPicture(&m_picture);
     }
 
     /* if frame has a pts (usually originiating from demux packet), use that */
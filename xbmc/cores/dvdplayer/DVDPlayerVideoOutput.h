@@ -23,6 +23,7 @@
 
 #include "threads/Thread.h"
 #include "DVDCodecs/Video/DVDVideoCodec.h"
+#include "DVDCodecs/Video/DVDVideoPPFFmpeg.h"
 #include "DVDClock.h"
 #include "DVDStreamInfo.h"
 #include "utils/BitstreamStats.h"
@@ -117,6 +118,8 @@ protected:
   double m_pts;
   CDVDVideoCodec* m_pVideoCodec;
   DVDVideoPicture m_picture;
+  CDVDVideoPPFFmpeg m_postProcess; ///< kept across pictures, the deinterlacer needs the previous one
+  bool m_resetPostProcess; ///< set by Reset(), the output thread resets m_postProcess before the next picture
   std::queue<ToOutputMessage> m_toOutputMessage;
   std::queue<FromOutputMessage> m_fromOutputMessage;
   CEvent m_toMsgSignal, m_fromMsgSignal;
@@ -0,0 +1,112 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDStreamStats.h"
+#include "threads/Thread.h"
+#include "utils/StdString.h"
+#include "utils/TimeUtils.h"
+#include "utils/log.h"
+
+#include <string.h>
+
+CDVDStreamStats::CDVDStreamStats()
+{
+  Start();
+}
+
+void CDVDStreamStats::Start(bool threadUsage)
+{
+  m_decodes = 0;
+  m_frames = 0;
+  m_dropped = 0;
+  m_decodeTicks = 0;
+  m_maxDecodeTicks = 0;
+  memset(m_histogram, 0, sizeof(m_histogram));
+  m_queueSamples = 0;
+  m_queueLevels = 0;
+  m_maxQueueLevel = 0;
+  m_startTime = CurrentHostCounter();
+  m_startUsage = threadUsage ? CThread::GetCurrentThreadUsage() : -1;
+}
+
+void CDVDStreamStats::AddDecode(int64_t ticks, int queueLevel)
+{
+  m_decodes++;
+  m_decodeTicks += ticks;
+  if (ticks > m_maxDecodeTicks)
+    m_maxDecodeTicks = ticks;
+
+  int64_t ms = ticks * 1000 / CurrentHostFrequency();
+  int bucket = 0;
+  while (bucket < BUCKETS - 1 && ms >= (1 << bucket))
+    bucket++;
+  m_histogram[bucket]++;
+
+  if (queueLevel >= 0)
+  {
+    m_queueSamples++;
+    m_queueLevels += queueLevel;
+    if (queueLevel > m_maxQueueLevel)
+      m_maxQueueLevel = queueLevel;
+  }
+}
+
+void CDVDStreamStats::AddFrame(bool dropped)
+{
+  if (dropped)
+    m_dropped++;
+  else
+    m_frames++;
+}
+
+void CDVDStreamStats::Report(const char *stage, unsigned int dropped)
+{
+  double freq = (double)CurrentHostFrequency();
+  double elapsed = (CurrentHostCounter() - m_startTime) / freq;
+
+  CStdString histogram;
+  for (int i = 0; i < BUCKETS; i++)
+  {
+    CStdString bucket;
+    if (i < BUCKETS - 1)
+      bucket.Format(" <%ims:%u", 1 << i, m_histogram[i]);
+    else
+      bucket.Format(" >=%ims:%u", 1 << (i - 1), m_histogram[i]);
+    histogram += bucket;
+  }
+
+  if (m_startUsage >= 0)
+  {
+    double cpu = (CThread::GetCurrentThreadUsage() - m_startUsage) / 10000000.0;
+    CLog::Log(LOGDEBUG, "%s stats: %u frames, %u dropped, %.1f fps over %.1f s, cpu %.2f s (%.0f%%)",
+              stage, m_frames, m_dropped + dropped, elapsed > 0 ? m_frames / elapsed : 0.0, elapsed,
+              cpu, elapsed > 0 ? cpu * 100.0 / elapsed : 0.0);
+  }
+  else
+    CLog::Log(LOGDEBUG, "%s stats: %u frames, %u dropped, %.1f fps over %.1f s",
+              stage, m_frames, m_dropped + dropped, elapsed > 0 ? m_frames / elapsed : 0.0, elapsed);
+  CLog::Log(LOGDEBUG, "%s stats: %u calls, avg %.2f ms, max %.2f ms,%s", stage, m_decodes,
+            m_decodes ? m_decodeTicks * 1000.0 / freq / m_decodes : 0.0, m_maxDecodeTicks * 1000.0 / freq,
+            histogram.c_str());
+  if (m_queueSamples)
+    CLog::Log(LOGDEBUG, "%s stats: queue avg %u%%, max %i%%", stage,
+              (unsigned int)(m_queueLevels / m_queueSamples), m_maxQueueLevel);
+}
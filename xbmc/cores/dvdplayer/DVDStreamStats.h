@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+
+/*! \brief Throughput statistics of one stage of the player (demuxing or the decoding of a stream)
+ Counts the frames (or packets) processed and dropped, keeps a histogram of the
+ time spent per decode call and samples the fill level of the stage's input
+ queue.  All methods are to be called from the thread doing the work, which
+ allows the cpu time of the thread to be reported along with the rest.  The
+ counters can also be read back, for callers that collect them rather than log them.
+ */
+class CDVDStreamStats
+{
+public:
+  CDVDStreamStats();
+
+  /*! \brief Reset the statistics, called when the thread starts
+   \param threadUsage false for stages whose work is spread over several threads,
+   the cpu time of the calling thread alone would be meaningless then
+   */
+  void Start(bool threadUsage = true);
+
+  /*! \brief Record a decode (or read) call
+   \param ticks time spent in the call, in CurrentHostCounter() ticks
+   \param queueLevel fill level of the input queue in percent, negative if unknown
+   */
+  void AddDecode(int64_t ticks, int queueLevel = -1);
+  void AddFrame(bool dropped = false);
+
+  /*! \brief Write the statistics to the log
+   \param stage name of the stage, used in the log
+   \param dropped number of frames dropped outside of AddFrame()
+   */
+  void Report(const char *stage, unsigned int dropped = 0);
+
+  unsigned int GetFrames() const  { return m_frames; }
+  unsigned int GetDropped() const { return m_dropped; }
+  unsigned int GetDecodes() const { return m_decodes; }
+  /*! \brief Number of calls that took less than 2^bucket ms (bucket 0: less than 1 ms), or longer for the last bucket */
+  unsigned int GetHistogram(int bucket) const { return bucket >= 0 && bucket < BUCKETS ? m_histogram[bucket] : 0; }
+  /*! \brief Average and peak fill level of the input queue in percent, -1 if never sampled */
+  int GetAverageQueueLevel() const { return m_queueSamples ? (int)(m_queueLevels / m_queueSamples) : -1; }
+  int GetMaxQueueLevel() const     { return m_queueSamples ? m_maxQueueLevel : -1; }
+
+  enum { BUCKETS = 8 };   ///< histogram buckets, doubling from below 1 ms to 64 ms and over
+
+private:
+  unsigned int m_decodes;
+  unsigned int m_frames;
+  unsigned int m_dropped;
+  int64_t      m_decodeTicks;
+  int64_t      m_maxDecodeTicks;
+  unsigned int m_histogram[BUCKETS];
+  unsigned int m_queueSamples;
+  int64_t      m_queueLevels;
+  int          m_maxQueueLevel;
+  int64_t      m_startTime;
+  int64_t      m_startUsage;
+};
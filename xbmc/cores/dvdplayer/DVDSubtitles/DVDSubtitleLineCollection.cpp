@@ -22,14 +22,19 @@
 #include "DVDSubtitleLineCollection.h"
 #include "DVDClock.h"
 
+#include <algorithm>
 
-CDVDSubtitleLineCollection::CDVDSubtitleLineCollection()
+using namespace std;
+
+static bool CompareStartTime(const CDVDOverlay* left, const CDVDOverlay* right)
 {
-  m_pHead = NULL;
-  m_pCurrent = NULL;
-  m_pTail = NULL;
+  return left->iPTSStartTime < right->iPTSStartTime;
+}
 
-  m_iSize = 0;
+CDVDSubtitleLineCollection::CDVDSubtitleLineCollection()
+{
+  m_current = 0;
+  m_bSorted = true;
   m_fLastPts = DVD_NOPTS_VALUE;
 }
 
@@ -40,41 +45,37 @@ CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
 
 void CDVDSubtitleLineCollection::Add(CDVDOverlay* pOverlay)
 {
-  ListElement* pElement = new ListElement;
-  pElement->pOverlay = pOverlay;
-  pElement->pNext = NULL;
+  if (!m_overlays.empty() && pOverlay->iPTSStartTime < m_overlays.back()->iPTSStartTime)
+    m_bSorted = false;
 
-  if (!m_pHead)
-  {
-    m_pHead = m_pTail = pElement;
-    m_pCurrent = m_pHead;
-  }
-  else
-  {
-    m_pTail->pNext = pElement;
-    m_pTail = pElement;
-  }
+  double maxStop = pOverlay->iPTSStopTime;
+  if (!m_maxStop.empty() && m_maxStop.back() > maxStop)
+    maxStop = m_maxStop.back();
 
-  m_iSize++;
+  m_overlays.push_back(pOverlay);
+  m_maxStop.push_back(maxStop);
 }
 
 void CDVDSubtitleLineCollection::Sort()
 {
-  if (!m_pHead || !m_pHead->pNext)
+  if (m_bSorted)
     return;
-  
-  for (ListElement* p1 = m_pHead; p1->pNext->pNext != NULL; p1 = p1->pNext)
+
+  // keep pointing at the overlay that would have been returned next
+  CDVDOverlay* current = m_current < m_overlays.size() ? m_overlays[m_current] : NULL;
+
+  stable_sort(m_overlays.begin(), m_overlays.end(), CompareStartTime);
+
+  for (unsigned int i = 0; i < m_overlays.size(); i++)
   {
-    for (ListElement* p2 = p1->pNext; p2->pNext != NULL; p2 = p2->pNext)
-    {
-      if (p1->pOverlay->iPTSStartTime > p2->pOverlay->iPTSStartTime)
-      {
-        CDVDOverlay* temp = p1->pOverlay;
-        p1->pOverlay = p2->pOverlay;
-        p2->pOverlay = temp;
-      }
-    }
+    m_maxStop[i] = m_overlays[i]->iPTSStopTime;
+    if (i > 0 && m_maxStop[i - 1] > m_maxStop[i])
+      m_maxStop[i] = m_maxStop[i - 1];
   }
+
+  if (current)
+    m_current = find(m_overlays.begin(), m_overlays.end(), current) - m_overlays.begin();
+  m_bSorted = true;
 }
 
 CDVDOverlay* CDVDSubtitleLineCollection::Get(double iPts)
@@ -84,46 +85,47 @@ CDVDOverlay* CDVDSubtitleLineCollection::Get(double iPts)
   if (iPts < m_fLastPts)
     Reset();
 
-  if (m_pCurrent)
+  if (m_current < m_overlays.size())
   {
-    while (m_pCurrent && m_pCurrent->pOverlay->iPTSStopTime < iPts)
-    {
-      m_pCurrent = m_pCurrent->pNext;
-    }
+    // skip everything that can't be visible anymore, no overlay before the
+    // first running maximum >= iPts stops after iPts
+    m_current = lower_bound(m_maxStop.begin() + m_current, m_maxStop.end(), iPts) - m_maxStop.begin();
+
+    while (m_current < m_overlays.size() && m_overlays[m_current]->iPTSStopTime < iPts)
+      m_current++;
 
-    if (m_pCurrent)
+    if (m_current < m_overlays.size())
     {
-      pOverlay = m_pCurrent->pOverlay;
+      pOverlay = m_overlays[m_current];
 
       // advance to the next overlay
-      m_pCurrent = m_pCurrent->pNext;
+      m_current++;
       m_fLastPts = iPts;
     }
   }
   return pOverlay;
 }
 
+double CDVDSubtitleLineCollection::GetLastStartTime()
+{
+  if (m_overlays.empty())
+    return DVD_NOPTS_VALUE;
+  return m_overlays.back()->iPTSStartTime;
+}
+
 void CDVDSubtitleLineCollection::Reset()
 {
-  m_pCurrent = m_pHead;
+  m_current = 0;
 }
 
 void CDVDSubtitleLineCollection::Clear()
 {
-  ListElement* pElement = NULL;
-
-  while (m_pHead)
-  {
-    pElement = m_pHead;
-    m_pHead = pElement->pNext;
-
-    pElement->pOverlay->Release();
-    delete pElement;
-  }
+  for (unsigned int i = 0; i < m_overlays.size(); i++)
+    m_overlays[i]->Release();
 
-  m_pTail    = NULL;
-  m_pHead    = NULL;
-  m_pCurrent = NULL;
-  m_iSize    = 0;
+  m_overlays.clear();
+  m_maxStop.clear();
+  m_current  = 0;
+  m_bSorted  = true;
   m_fLastPts = DVD_NOPTS_VALUE;
 }
@@ -23,40 +23,35 @@
 
 #include "../DVDCodecs/Overlay/DVDOverlay.h"
 
-typedef struct stListElement
-{
-  CDVDOverlay* pOverlay;
-  struct stListElement* pNext;
-
-} ListElement;
+#include <vector>
 
+// overlays are kept ordered by start time, alongside the running maximum of
+// their stop times so that the first overlay still visible at a given pts can
+// be found with a binary search after a seek.
 class CDVDSubtitleLineCollection
 {
 public:
   CDVDSubtitleLineCollection();
   virtual ~CDVDSubtitleLineCollection();
 
-  //void Lock()   { EnterCriticalSection(&m_critSection); }
-  //void Unlock() { LeaveCriticalSection(&m_critSection); }
-
   void Add(CDVDOverlay* pSubtitle);
   void Sort();
+  bool IsSorted() { return m_bSorted; }
 
   CDVDOverlay* Get(double iPts = 0LL); // get the first overlay in this fifo
 
   void Reset();
 
-  void Remove();
   void Clear();
-  int GetSize() { return m_iSize; }
+  int GetSize() { return (int)m_overlays.size(); }
+  double GetLastStartTime(); // start time of the last added overlay
 
 private:
-  ListElement* m_pHead;
-  ListElement* m_pCurrent;
-  ListElement* m_pTail;
+  std::vector<CDVDOverlay*> m_overlays;
+  std::vector<double>       m_maxStop;  // running maximum of iPTSStopTime
+  unsigned int              m_current;
 
-  int m_iSize;
+  bool m_bSorted;
   double m_fLastPts;
-  //CRITICAL_SECTION m_critSection;
 };
 
@@ -39,6 +39,9 @@ public:
   virtual CDVDOverlay* Parse(double iPts) = 0;
 };
 
+// number of subtitle entries read per ParseChunk() call
+#define SUBTITLE_CHUNK_ENTRIES 100
+
 class CDVDSubtitleParserCollection
   : public CDVDSubtitleParser
 {
@@ -46,15 +49,50 @@ public:
   CDVDSubtitleParserCollection(const std::string& strFile)
   {
     m_filename = strFile;
+    m_bParsed  = false;
   }
   virtual ~CDVDSubtitleParserCollection() { }
-  virtual CDVDOverlay* Parse(double iPts) { return m_collection.Get(iPts); }
+  virtual CDVDOverlay* Parse(double iPts)
+  {
+    // parse on demand, until everything starting up to iPts is available
+    while (!m_bParsed && (m_collection.GetSize() == 0 || m_collection.GetLastStartTime() <= iPts))
+      ParseNextChunk();
+
+    CDVDOverlay* pOverlay = m_collection.Get(iPts);
+    while (!pOverlay && !m_bParsed)
+    {
+      ParseNextChunk();
+      pOverlay = m_collection.Get(iPts);
+    }
+    return pOverlay;
+  }
   virtual void         Reset()            { m_collection.Reset(); }
-  virtual void         Dispose()          { m_collection.Clear(); }
+  virtual void         Dispose()          { m_collection.Clear(); m_bParsed = false; }
 
 protected:
+  /*! \brief Parse the next part of the subtitle file into m_collection
+   Parsers that don't read their file incrementally do all the work in Open().
+   \return false once the end of the file is reached
+   */
+  virtual bool ParseChunk() { return false; }
+
   CDVDSubtitleLineCollection m_collection;
   std::string                m_filename;
+
+private:
+  void ParseNextChunk()
+  {
+    m_bParsed = !ParseChunk();
+    // out of order files can only be shown correctly once fully parsed
+    if (!m_collection.IsSorted())
+    {
+      while (!m_bParsed)
+        m_bParsed = !ParseChunk();
+      m_collection.Sort();
+    }
+  }
+
+  bool                       m_bParsed;
 };
 
 class CDVDSubtitleParserText
@@ -22,11 +22,9 @@
 #include "DVDSubtitleParserMicroDVD.h"
 #include "DVDCodecs/Overlay/DVDOverlayText.h"
 #include "DVDClock.h"
-#include "utils/RegExp.h"
 #include "DVDStreamInfo.h"
 #include "utils/StdString.h"
 #include "utils/log.h"
-#include "DVDSubtitleTagMicroDVD.h"
 
 using namespace std;
 
@@ -55,39 +53,41 @@ bool CDVDSubtitleParserMicroDVD::Open(CDVDStreamInfo &hints)
   else
     m_framerate = DVD_TIME_BASE / 25.0;
 
-  char line[1024];
+  // the file itself is parsed on demand by ParseChunk()
+  return m_reg.RegComp("\\{([0-9]+)\\}\\{([0-9]+)\\}");
+}
 
-  CRegExp reg;
-  if (!reg.RegComp("\\{([0-9]+)\\}\\{([0-9]+)\\}"))
-    return false;
-  CDVDSubtitleTagMicroDVD TagConv;
+bool CDVDSubtitleParserMicroDVD::ParseChunk()
+{
+  char line[1024];
+  int entries = 0;
 
-  while (m_pStream->ReadLine(line, sizeof(line)))
+  while (entries < SUBTITLE_CHUNK_ENTRIES && m_pStream->ReadLine(line, sizeof(line)))
   {
     if ((strlen(line) > 0) && (line[strlen(line) - 1] == '\r'))
       line[strlen(line) - 1] = 0;
 
-    int pos = reg.RegFind(line);
+    int pos = m_reg.RegFind(line);
     if (pos > -1)
     {
-      const char* text = line + pos + reg.GetFindLen();
-      char* startFrame = reg.GetReplaceString("\\1");
-      char* endFrame   = reg.GetReplaceString("\\2");
+      const char* text = line + pos + m_reg.GetFindLen();
+      char* startFrame = m_reg.GetReplaceString("\\1");
+      char* endFrame   = m_reg.GetReplaceString("\\2");
       CDVDOverlayText* pOverlay = new CDVDOverlayText();
       pOverlay->Acquire(); // increase ref count with one so that we can hold a handle to this overlay
 
       pOverlay->iPTSStartTime = m_framerate * atoi(startFrame);
       pOverlay->iPTSStopTime  = m_framerate * atoi(endFrame);
 
-      TagConv.ConvertLine(pOverlay, text, strlen(text));
+      m_tagConv.ConvertLine(pOverlay, text, strlen(text));
 
       free(startFrame);
       free(endFrame);
 
       m_collection.Add(pOverlay);
+      entries++;
     }
   }
-
-  return true;
+  return entries == SUBTITLE_CHUNK_ENTRIES;
 }
 
@@ -23,6 +23,8 @@
 
 #include "DVDSubtitleParser.h"
 #include "DVDSubtitleLineCollection.h"
+#include "DVDSubtitleTagMicroDVD.h"
+#include "utils/RegExp.h"
 
 class CDVDSubtitleParserMicroDVD : public CDVDSubtitleParserText
 {
@@ -31,6 +33,10 @@ public:
   virtual ~CDVDSubtitleParserMicroDVD();
 
   virtual bool Open(CDVDStreamInfo &hints);
+protected:
+  virtual bool ParseChunk();
 private:
   double m_framerate;
+  CRegExp m_reg;
+  CDVDSubtitleTagMicroDVD m_tagConv;
 };
@@ -23,7 +23,6 @@
 #include "DVDCodecs/Overlay/DVDOverlayText.h"
 #include "DVDClock.h"
 #include "utils/StdString.h"
-#include "DVDSubtitleTagSami.h"
 
 using namespace std;
 
@@ -42,14 +41,17 @@ bool CDVDSubtitleParserSubrip::Open(CDVDStreamInfo &hints)
   if (!CDVDSubtitleParserText::Open())
     return false;
 
-  CDVDSubtitleTagSami TagConv;
-  if (!TagConv.Init())
-    return false;
+  // the file itself is parsed on demand by ParseChunk()
+  return m_tagConv.Init();
+}
 
+bool CDVDSubtitleParserSubrip::ParseChunk()
+{
   char line[1024];
   CStdString strLine;
+  int entries = 0;
 
-  while (m_pStream->ReadLine(line, sizeof(line)))
+  while (entries < SUBTITLE_CHUNK_ENTRIES && m_pStream->ReadLine(line, sizeof(line)))
   {
     strLine = line;
     strLine.Trim();
@@ -82,14 +84,13 @@ bool CDVDSubtitleParserSubrip::Open(CDVDStreamInfo &hints)
           // empty line, next subtitle is about to start
           if (strLine.length() <= 0) break;
 
-          TagConv.ConvertLine(pOverlay, strLine.c_str(), strLine.length());
+          m_tagConv.ConvertLine(pOverlay, strLine.c_str(), strLine.length());
         }
-        TagConv.CloseTag(pOverlay);
+        m_tagConv.CloseTag(pOverlay);
         m_collection.Add(pOverlay);
+        entries++;
       }
     }
   }
-  m_collection.Sort();
-  return true;
+  return entries == SUBTITLE_CHUNK_ENTRIES;
 }
-
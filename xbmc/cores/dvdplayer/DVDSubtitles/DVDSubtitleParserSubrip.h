@@ -23,6 +23,7 @@
 
 #include "DVDSubtitleParser.h"
 #include "DVDSubtitleLineCollection.h"
+#include "DVDSubtitleTagSami.h"
 
 class CDVDSubtitleParserSubrip : public CDVDSubtitleParserText
 {
@@ -31,5 +32,8 @@ public:
   virtual ~CDVDSubtitleParserSubrip();
 
   virtual bool Open(CDVDStreamInfo &hints);
+protected:
+  virtual bool ParseChunk();
 private:
+  CDVDSubtitleTagSami m_tagConv;
 };
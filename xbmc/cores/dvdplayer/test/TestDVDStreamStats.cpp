@@ -0,0 +1,98 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cores/dvdplayer/DVDStreamStats.h"
+#include "utils/TimeUtils.h"
+
+#include <boost/test/unit_test.hpp>
+
+// the host clock of the real player would pull in the date and time handling
+// of the application, a microsecond clock the test advances is all it needs
+static int64_t g_hostCounter = 0;
+
+int64_t CurrentHostCounter(void)
+{
+  return g_hostCounter;
+}
+
+int64_t CurrentHostFrequency(void)
+{
+  return 1000000;
+}
+
+BOOST_AUTO_TEST_CASE(TestDVDStreamStatsHistogram)
+{
+  CDVDStreamStats stats;
+  stats.Start(false);
+
+  // one call per bucket: <1ms, <2ms, <4ms, ... <64ms, >=64ms
+  const int64_t us[] = { 500, 1500, 3000, 7999, 8000, 20000, 63999, 64000 };
+  const int buckets[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  for (unsigned int i = 0; i < sizeof(us) / sizeof(us[0]); i++)
+    stats.AddDecode(us[i]);
+  stats.AddDecode(1000000);
+
+  unsigned int expected[CDVDStreamStats::BUCKETS] = {};
+  for (unsigned int i = 0; i < sizeof(buckets) / sizeof(buckets[0]); i++)
+    expected[buckets[i]]++;
+  expected[CDVDStreamStats::BUCKETS - 1]++;
+
+  BOOST_CHECK_EQUAL(stats.GetDecodes(), 9u);
+  for (int i = 0; i < CDVDStreamStats::BUCKETS; i++)
+    BOOST_CHECK_EQUAL(stats.GetHistogram(i), expected[i]);
+  BOOST_CHECK_EQUAL(stats.GetHistogram(-1), 0u);
+  BOOST_CHECK_EQUAL(stats.GetHistogram(CDVDStreamStats::BUCKETS), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TestDVDStreamStatsCounters)
+{
+  CDVDStreamStats stats;
+  stats.Start(false);
+
+  BOOST_CHECK_EQUAL(stats.GetAverageQueueLevel(), -1);
+  BOOST_CHECK_EQUAL(stats.GetMaxQueueLevel(), -1);
+
+  // unknown queue levels aren't sampled
+  stats.AddDecode(100, 10);
+  stats.AddDecode(100, 90);
+  stats.AddDecode(100, 50);
+  stats.AddDecode(100);
+  BOOST_CHECK_EQUAL(stats.GetAverageQueueLevel(), 50);
+  BOOST_CHECK_EQUAL(stats.GetMaxQueueLevel(), 90);
+
+  for (int i = 0; i < 25; i++)
+    stats.AddFrame();
+  stats.AddFrame(true);
+  stats.AddFrame(true);
+  BOOST_CHECK_EQUAL(stats.GetFrames(), 25u);
+  BOOST_CHECK_EQUAL(stats.GetDropped(), 2u);
+
+  g_hostCounter += 1000000;
+  stats.Report("test", 3);
+
+  // a restart forgets everything
+  stats.Start(false);
+  BOOST_CHECK_EQUAL(stats.GetFrames(), 0u);
+  BOOST_CHECK_EQUAL(stats.GetDropped(), 0u);
+  BOOST_CHECK_EQUAL(stats.GetDecodes(), 0u);
+  BOOST_CHECK_EQUAL(stats.GetHistogram(0), 0u);
+  BOOST_CHECK_EQUAL(stats.GetAverageQueueLevel(), -1);
+}
@@ -0,0 +1,178 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoPPYadif.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+  // odd sizes, so the chroma planes are rounded up and the slices are uneven
+  const int width  = 67;
+  const int height = 45;
+  // slices filtered concurrently, more than the rows of a small chroma plane
+  const int threads = 4;
+
+  // a synthetic 4:2:0 picture, with strides wider than the rows
+  class CTestPicture
+  {
+  public:
+    CTestPicture(bool topFieldFirst)
+    {
+      memset(&m_picture, 0, sizeof(m_picture));
+      m_picture.format  = DVDVideoPicture::FMT_YUV420P;
+      m_picture.iWidth  = width;
+      m_picture.iHeight = height;
+      m_picture.iFlags  = DVP_FLAG_INTERLACED | (topFieldFirst ? DVP_FLAG_TOP_FIELD_FIRST : 0);
+      for (int i = 0; i < 3; i++)
+      {
+        m_picture.iLineSize[i] = PlaneWidth(i) + 13;
+        m_planes[i].assign(m_picture.iLineSize[i] * PlaneHeight(i), 0);
+        m_picture.data[i] = &m_planes[i][0];
+      }
+    }
+
+    static int PlaneWidth(int plane)  { return plane ? (width  + 1) >> 1 : width;  }
+    static int PlaneHeight(int plane) { return plane ? (height + 1) >> 1 : height; }
+
+    BYTE &At(int plane, int x, int y) { return m_picture.data[plane][y * m_picture.iLineSize[plane] + x]; }
+
+    void Fill(BYTE even, BYTE odd)
+    {
+      for (int i = 0; i < 3; i++)
+        for (int y = 0; y < PlaneHeight(i); y++)
+          for (int x = 0; x < PlaneWidth(i); x++)
+            At(i, x, y) = (y & 1) ? odd : even;
+    }
+
+    void FillRandom()
+    {
+      for (int i = 0; i < 3; i++)
+        for (int y = 0; y < PlaneHeight(i); y++)
+          for (int x = 0; x < PlaneWidth(i); x++)
+            At(i, x, y) = (BYTE)(rand() % 256);
+    }
+
+    const DVDVideoPicture *Get() const { return &m_picture; }
+
+  private:
+    DVDVideoPicture   m_picture;
+    std::vector<BYTE> m_planes[3];
+  };
+
+  BYTE OutputAt(const DVDVideoPicture *picture, int plane, int x, int y)
+  {
+    return picture->data[plane][y * picture->iLineSize[plane] + x];
+  }
+
+  bool SameOutput(const DVDVideoPicture *a, const DVDVideoPicture *b)
+  {
+    for (int i = 0; i < 3; i++)
+      for (int y = 0; y < CTestPicture::PlaneHeight(i); y++)
+        for (int x = 0; x < CTestPicture::PlaneWidth(i); x++)
+          if (OutputAt(a, i, x, y) != OutputAt(b, i, x, y))
+            return false;
+    return true;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestYadifRejectsOtherFormats)
+{
+  CTestPicture source(true);
+  DVDVideoPicture picture = *source.Get();
+  picture.format = DVDVideoPicture::FMT_NV12;
+
+  CDVDVideoPPYadif yadif(threads);
+  BOOST_CHECK(!yadif.Process(&picture));
+}
+
+BOOST_AUTO_TEST_CASE(TestYadifKeepsFirstField)
+{
+  srand(1);
+  for (int tff = 0; tff < 2; tff++)
+  {
+    CTestPicture source(tff != 0);
+    CDVDVideoPPYadif yadif(threads);
+    for (int frame = 0; frame < 2; frame++)
+    {
+      source.FillRandom();
+      BOOST_REQUIRE(yadif.Process(source.Get()));
+      const DVDVideoPicture *output = yadif.GetPicture();
+
+      BOOST_CHECK_EQUAL(output->iWidth, (unsigned int)width);
+      BOOST_CHECK_EQUAL(output->iHeight, (unsigned int)height);
+      BOOST_CHECK(!(output->iFlags & (DVP_FLAG_INTERLACED | DVP_FLAG_TOP_FIELD_FIRST)));
+
+      // the rows of the first field in time are passed through untouched
+      int kept = tff ? 0 : 1;
+      for (int i = 0; i < 3; i++)
+        for (int y = kept; y < CTestPicture::PlaneHeight(i); y += 2)
+          for (int x = 0; x < CTestPicture::PlaneWidth(i); x++)
+            BOOST_REQUIRE_EQUAL((int)OutputAt(output, i, x, y), (int)source.At(i, x, y));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestYadifRemovesCombing)
+{
+  // a static picture whose fields differ completely, the second field must be
+  // interpolated from the first, with and without a previous frame
+  CTestPicture source(true);
+  source.Fill(200, 50);
+
+  CDVDVideoPPYadif yadif(threads);
+  for (int frame = 0; frame < 3; frame++)
+  {
+    BOOST_REQUIRE(yadif.Process(source.Get()));
+    const DVDVideoPicture *output = yadif.GetPicture();
+    for (int i = 0; i < 3; i++)
+      for (int y = 0; y < CTestPicture::PlaneHeight(i); y++)
+        for (int x = 0; x < CTestPicture::PlaneWidth(i); x++)
+          BOOST_REQUIRE_EQUAL((int)OutputAt(output, i, x, y), 200);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestYadifReset)
+{
+  srand(2);
+  CTestPicture first(true), second(true);
+  first.FillRandom();
+  second.FillRandom();
+
+  // without a previous frame only the spatial interpolation is used
+  CDVDVideoPPYadif fresh(threads);
+  BOOST_REQUIRE(fresh.Process(second.Get()));
+
+  CDVDVideoPPYadif continued(threads);
+  BOOST_REQUIRE(continued.Process(first.Get()));
+  BOOST_REQUIRE(continued.Process(second.Get()));
+  BOOST_CHECK(!SameOutput(continued.GetPicture(), fresh.GetPicture()));
+
+  CDVDVideoPPYadif reset(threads);
+  BOOST_REQUIRE(reset.Process(first.Get()));
+  reset.Reset();
+  BOOST_REQUIRE(reset.Process(second.Get()));
+  BOOST_CHECK(SameOutput(reset.GetPicture(), fresh.GetPicture()));
+}
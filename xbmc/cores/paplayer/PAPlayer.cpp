@@ -26,6 +26,9 @@
 #include "guilib/AudioContext.h"
 #include "Application.h"
 #include "FileItem.h"
+#include "GUIUserMessages.h"
+#include "guilib/GUIWindowManager.h"
+#include "filesystem/FilePrefetch.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/GUISettings.h"
 #include "settings/Settings.h"
@@ -46,6 +49,7 @@
 #define FADE_TIME 2 * 2048.0f / XBMC_SAMPLE_RATE.0f      // 2 packets
 
 #define TIME_TO_CACHE_NEXT_FILE 5000L         // 5 seconds
+#define TIME_TO_PREFETCH_NEXT_FILE 2000L      // 2 seconds into a track
 #define TIME_TO_CROSS_FADE      10000L        // 10 seconds
 
 // PAP: Psycho-acoustic Audio Player
@@ -57,6 +61,7 @@ PAPlayer::PAPlayer(IPlayerCallback& callback) : CThread("PAPlayer"), IPlayer(cal
   m_bIsPlaying = false;
   m_bPaused = false;
   m_cachingNextFile = false;
+  m_prefetchingNextFile = false;
   m_currentlyCrossFading = false;
   m_bQueueFailed = false;
 
@@ -175,6 +180,7 @@ bool PAPlayer::OpenFile(const CFileItem& file, const CPlayerOptions &options)
 
   m_bIsPlaying = true;
   m_cachingNextFile = false;
+  m_prefetchingNextFile = false;
   m_currentlyCrossFading = false;
   m_forceFadeToNext = false;
   m_bQueueFailed = false;
@@ -215,6 +221,17 @@ void PAPlayer::OnNothingToQueueNotify()
   m_bQueueFailed = true;
 }
 
+void PAPlayer::PrefetchNextFile(const CFileItem &file)
+{
+  // cd reading and last.fm don't like a second connection, local files
+  // gain nothing and the next .cue sheet item is the file we're playing
+  if (file.IsCDDA() || file.IsLastFM() || file.IsPlayList() || file.IsHD() ||
+      file.GetPath() == m_currentFile->GetPath())
+    return;
+
+  XFILE::CFilePrefetch::Prefetch(file.GetPath());
+}
+
 bool PAPlayer::QueueNextFile(const CFileItem &file)
 {
   return QueueNextFile(file, true);
@@ -298,7 +315,16 @@ bool PAPlayer::CloseFileInternal(bool bAudioDevice /*= true*/)
   m_nextFile->Reset();
 
   if(bAudioDevice)
+  {
     g_audioContext.SetActiveDevice(CAudioContext::DEFAULT_DEVICE);
+
+    unsigned int hits, misses;
+    uint64_t bytes;
+    XFILE::CFilePrefetch::GetStats(hits, misses, bytes);
+    XFILE::CFilePrefetch::Release();
+    if (hits || misses)
+      CLog::Log(LOGDEBUG, "PAPlayer: Prefetch hits: %u, misses: %u, %.1f MB served from memory", hits, misses, bytes / (1024.0 * 1024.0));
+  }
   else
     FlushStreams();
 
@@ -544,6 +570,16 @@ bool PAPlayer::ProcessPAP()
 
     UpdateCacheLevel();
 
+    // read the next file ahead well before it's queued, so the transition never waits on the network
+    if ((GetTotalTime64() > 0) && GetTime() > TIME_TO_PREFETCH_NEXT_FILE && !m_prefetchingNextFile && !m_cachingNextFile &&
+        GetTotalTime64() - GetTime() > TIME_TO_CACHE_NEXT_FILE + m_crossFading * 1000L + TIME_TO_PREFETCH_NEXT_FILE &&
+        g_advancedSettings.m_musicPrefetchSize > 0)
+    {
+      CGUIMessage msg(GUI_MSG_PREFETCH_NEXT_ITEM, 0, 0);
+      g_windowManager.SendThreadMessage(msg);
+      m_prefetchingNextFile = true;
+    }
+
     // check whether we should queue the next file up
     if ((GetTotalTime64() > 0) && GetTotalTime64() - GetTime() < TIME_TO_CACHE_NEXT_FILE + m_crossFading * 1000L && !m_cachingNextFile)
     { // request the next file from our application
@@ -580,6 +616,7 @@ bool PAPlayer::ProcessPAP()
           *m_currentFile = *m_nextFile;
           m_nextFile->Reset();
           m_cachingNextFile = false;
+          m_prefetchingNextFile = false;
         }
       }
     }
@@ -637,6 +674,7 @@ bool PAPlayer::ProcessPAP()
             *m_currentFile = *m_nextFile;
             m_nextFile->Reset();
             m_cachingNextFile = false;
+            m_prefetchingNextFile = false;
             m_currentDecoder = 1 - m_currentDecoder;
           }
           else
@@ -682,6 +720,7 @@ bool PAPlayer::ProcessPAP()
         *m_currentFile = *m_nextFile;
         m_nextFile->Reset();
         m_cachingNextFile = false;
+        m_prefetchingNextFile = false;
       }
     }
 
@@ -58,6 +58,7 @@ public:
   virtual bool OpenFile(const CFileItem& file, const CPlayerOptions &options);
   virtual bool QueueNextFile(const CFileItem &file);
   virtual void OnNothingToQueueNotify();
+  virtual void PrefetchNextFile(const CFileItem &file);
   virtual bool CloseFile()       { return CloseFileInternal(true); }
   virtual bool CloseFileInternal(bool bAudioDevice = true);
   virtual bool IsPlaying() const { return m_bIsPlaying; }
@@ -111,6 +112,7 @@ protected:
   bool m_bQueueFailed;
   bool m_bStopPlaying;
   bool m_cachingNextFile;
+  bool m_prefetchingNextFile;
   int  m_crossFading;
   bool m_currentlyCrossFading;
   __int64 m_crossFadeLength;
@@ -24,6 +24,7 @@
 #include "DirectoryCache.h"
 #include "Directory.h"
 #include "FileCache.h"
+#include "FilePrefetch.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/BitstreamStats.h"
@@ -224,6 +225,14 @@ bool CFile::Open(const CStdString& strFileName, unsigned int flags)
     }
 
     CURL url(URIUtils::SubstitutePath(strFileName));
+    if ( (flags & READ_NO_CACHE) == 0 && CFilePrefetch::IsPrefetched(url) )
+    {
+      m_pFile = new CFilePrefetch();
+      if (m_pFile->Open(url))
+        return true;
+      SAFE_DELETE(m_pFile);
+    }
+
     if ( (flags & READ_NO_CACHE) == 0 && URIUtils::IsInternetStream(url) && !CUtil::IsPicture(strFileName) )
       m_flags |= READ_CACHED;
 
@@ -0,0 +1,327 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "FilePrefetch.h"
+#include "URL.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/JobManager.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#include <vector>
+#include <sys/stat.h>
+
+using namespace XFILE;
+
+#define PREFETCH_CHUNK_SIZE (64 * 1024)
+
+class CFilePrefetch::CPrefetchData
+{
+public:
+  CPrefetchData(const CStdString &path, const CStdString &key)
+    : m_path(path), m_key(key), m_length(0), m_ready(false), m_missed(false), m_abort(false)
+  {
+  }
+
+  CStdString           m_path;   ///< path the prefetch was requested for
+  CStdString           m_key;    ///< substituted url the file is opened with
+  std::vector<uint8_t> m_buffer; ///< the first m_buffer.size() bytes of the file, only modified before m_ready is set
+  int64_t              m_length; ///< length of the whole file
+  bool                 m_ready;
+  bool                 m_missed; ///< whether the file was opened before the prefetch finished
+  volatile bool        m_abort;
+};
+
+static CCriticalSection                 g_prefetchSection;
+static CFilePrefetch::CPrefetchDataPtr  g_prefetchData;
+static unsigned int                     g_prefetchHits   = 0;
+static unsigned int                     g_prefetchMisses = 0;
+static uint64_t                         g_prefetchBytes  = 0;
+
+class CPrefetchJob : public CJob
+{
+public:
+  CPrefetchJob(const CFilePrefetch::CPrefetchDataPtr &data, unsigned int maxSize)
+    : m_data(data), m_maxSize(maxSize)
+  {
+  }
+
+  virtual const char *GetType() const { return "prefetch"; }
+
+  virtual bool DoWork()
+  {
+    CFile file;
+    if (!file.Open(m_data->m_path, READ_NO_CACHE))
+      return false;
+
+    // streams of unknown length (radio etc.) would never end
+    int64_t length = file.GetLength();
+    if (length <= 0)
+    {
+      CLog::Log(LOGDEBUG, "%s - not prefetching %s, unknown length", __FUNCTION__, m_data->m_path.c_str());
+      return false;
+    }
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    size_t size = (size_t)std::min(length, (int64_t)m_maxSize);
+    m_data->m_buffer.resize(size);
+
+    size_t done = 0;
+    while (done < size && !m_data->m_abort)
+    {
+      unsigned int read = file.Read(&m_data->m_buffer[done], std::min(size - done, (size_t)PREFETCH_CHUNK_SIZE));
+      if (read == 0)
+        break;
+      done += read;
+    }
+    file.Close();
+
+    if (m_data->m_abort)
+      return false;
+
+    if (done == 0)
+      return false;
+
+    if (done < size)
+    { // a short read may be a hiccup of the source rather than the end of the
+      // file, so keep its length and let Read() fetch the rest from the source
+      CLog::Log(LOGDEBUG, "%s - short read on %s, the rest is read from the source", __FUNCTION__, m_data->m_path.c_str());
+      m_data->m_buffer.resize(done);
+    }
+
+    CSingleLock lock(g_prefetchSection);
+    m_data->m_length = length;
+    m_data->m_ready  = true;
+    CLog::Log(LOGDEBUG, "%s - prefetched %"PRIu64" of %"PRId64" bytes of %s in %u ms", __FUNCTION__,
+              (uint64_t)done, length, m_data->m_path.c_str(), XbmcThreads::SystemClockMillis() - start);
+    return true;
+  }
+
+private:
+  CFilePrefetch::CPrefetchDataPtr m_data;
+  unsigned int                    m_maxSize;
+};
+
+CFilePrefetch::CFilePrefetch()
+{
+  m_position   = 0;
+  m_sourceOpen = false;
+  m_served     = 0;
+}
+
+CFilePrefetch::~CFilePrefetch()
+{
+  Close();
+}
+
+void CFilePrefetch::Prefetch(const CStdString &path)
+{
+  if (g_advancedSettings.m_musicPrefetchSize == 0)
+    return;
+
+  CStdString key = CURL(URIUtils::SubstitutePath(path)).Get();
+
+  CSingleLock lock(g_prefetchSection);
+  if (g_prefetchData && g_prefetchData->m_key == key)
+    return;
+
+  Release();
+  g_prefetchData.reset(new CPrefetchData(path, key));
+  CJobManager::GetInstance().AddJob(new CPrefetchJob(g_prefetchData, g_advancedSettings.m_musicPrefetchSize), NULL, CJob::PRIORITY_LOW);
+}
+
+void CFilePrefetch::Release()
+{
+  CSingleLock lock(g_prefetchSection);
+  if (g_prefetchData)
+  { // files still open keep their data alive, the job notices the abort
+    g_prefetchData->m_abort = true;
+    g_prefetchData.reset();
+  }
+}
+
+bool CFilePrefetch::IsPrefetched(const CURL &url)
+{
+  CSingleLock lock(g_prefetchSection);
+  if (!g_prefetchData || g_prefetchData->m_key != url.Get())
+    return false;
+
+  if (!g_prefetchData->m_ready)
+  {
+    if (!g_prefetchData->m_missed)
+    {
+      g_prefetchData->m_missed = true;
+      g_prefetchMisses++;
+      CLog::Log(LOGDEBUG, "%s - prefetch of %s not finished yet (hits: %u, misses: %u)", __FUNCTION__,
+                g_prefetchData->m_path.c_str(), g_prefetchHits, g_prefetchMisses);
+    }
+    return false;
+  }
+  return true;
+}
+
+void CFilePrefetch::GetStats(unsigned int &hits, unsigned int &misses, uint64_t &bytes)
+{
+  CSingleLock lock(g_prefetchSection);
+  hits   = g_prefetchHits;
+  misses = g_prefetchMisses;
+  bytes  = g_prefetchBytes;
+}
+
+bool CFilePrefetch::Open(const CURL& url)
+{
+  Close();
+
+  CSingleLock lock(g_prefetchSection);
+  if (!g_prefetchData || !g_prefetchData->m_ready || g_prefetchData->m_key != url.Get())
+    return false;
+
+  m_data = g_prefetchData;
+  m_position = 0;
+  g_prefetchHits++;
+  CLog::Log(LOGDEBUG, "%s - serving %s from memory (hits: %u, misses: %u)", __FUNCTION__,
+            m_data->m_path.c_str(), g_prefetchHits, g_prefetchMisses);
+  return true;
+}
+
+bool CFilePrefetch::Exists(const CURL& url)
+{
+  return CFile::Exists(url.Get());
+}
+
+int CFilePrefetch::Stat(const CURL& url, struct __stat64* buffer)
+{
+  return CFile::Stat(url.Get(), buffer);
+}
+
+int CFilePrefetch::Stat(struct __stat64* buffer)
+{
+  if (!m_data)
+    return -1;
+
+  memset(buffer, 0, sizeof(struct __stat64));
+  buffer->st_size = m_data->m_length;
+  buffer->st_mode = _S_IFREG;
+  return 0;
+}
+
+unsigned int CFilePrefetch::Read(void* lpBuf, int64_t uiBufSize)
+{
+  if (!m_data || uiBufSize <= 0)
+    return 0;
+
+  uint8_t *buffer = (uint8_t *)lpBuf;
+  int64_t done = 0;
+
+  const int64_t buffered = m_data->m_buffer.size();
+  if (m_position < buffered)
+  {
+    done = std::min(uiBufSize, buffered - m_position);
+    memcpy(buffer, &m_data->m_buffer[(size_t)m_position], (size_t)done);
+    m_position += done;
+    m_served   += done;
+  }
+
+  // the remainder of files larger than the prefetch cap comes from the source
+  if (done < uiBufSize && m_position >= buffered && m_position < m_data->m_length)
+  {
+    if (!m_sourceOpen)
+    {
+      if (!m_source.Open(m_data->m_path, READ_NO_CACHE))
+        return (unsigned int)done;
+      m_sourceOpen = true;
+    }
+    if (m_source.GetPosition() != m_position && m_source.Seek(m_position, SEEK_SET) != m_position)
+      return (unsigned int)done;
+
+    unsigned int read = m_source.Read(buffer + done, uiBufSize - done);
+    m_position += read;
+    done += read;
+  }
+  return (unsigned int)done;
+}
+
+int64_t CFilePrefetch::Seek(int64_t iFilePosition, int iWhence)
+{
+  if (!m_data)
+    return -1;
+
+  int64_t position;
+  switch (iWhence)
+  {
+    case SEEK_SET:
+      position = iFilePosition;
+      break;
+    case SEEK_CUR:
+      position = m_position + iFilePosition;
+      break;
+    case SEEK_END:
+      position = m_data->m_length + iFilePosition;
+      break;
+    default:
+      return -1;
+  }
+
+  if (position < 0 || position > m_data->m_length)
+    return -1;
+
+  m_position = position;
+  return m_position;
+}
+
+void CFilePrefetch::Close()
+{
+  if (m_sourceOpen)
+  {
+    m_source.Close();
+    m_sourceOpen = false;
+  }
+
+  if (m_served)
+  {
+    CSingleLock lock(g_prefetchSection);
+    g_prefetchBytes += m_served;
+    m_served = 0;
+  }
+  m_data.reset();
+  m_position = 0;
+}
+
+int64_t CFilePrefetch::GetPosition()
+{
+  return m_position;
+}
+
+int64_t CFilePrefetch::GetLength()
+{
+  return m_data ? m_data->m_length : 0;
+}
+
+int CFilePrefetch::IoControl(EIoControl request, void* param)
+{
+  if (request == IOCTRL_SEEK_POSSIBLE)
+    return 1;
+
+  return -1;
+}
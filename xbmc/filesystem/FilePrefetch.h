@@ -0,0 +1,86 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "IFile.h"
+#include "File.h"
+#include <boost/shared_ptr.hpp>
+
+namespace XFILE
+{
+/*! \brief Serves a file that was read ahead into memory
+ The music player prefetches the next queued track while the current one is
+ playing, so the transition to it never waits on (network) I/O.  Only one
+ file is held at a time and at most advancedsettings' musicprefetchsize bytes
+ of it; reads beyond the prefetched part fall through to the original file.
+ CFile::Open() uses this implementation whenever the requested file has been
+ prefetched completely or up to the memory cap.
+ */
+class CFilePrefetch : public IFile
+{
+public:
+  CFilePrefetch();
+  virtual ~CFilePrefetch();
+
+  virtual bool Open(const CURL& url);
+  virtual bool Exists(const CURL& url);
+  virtual int Stat(const CURL& url, struct __stat64* buffer);
+  virtual int Stat(struct __stat64* buffer);
+  virtual unsigned int Read(void* lpBuf, int64_t uiBufSize);
+  virtual int64_t Seek(int64_t iFilePosition, int iWhence = SEEK_SET);
+  virtual void Close();
+  virtual int64_t GetPosition();
+  virtual int64_t GetLength();
+  virtual int IoControl(EIoControl request, void* param);
+
+  /*! \brief Start reading a file into memory in the background
+   Any previously prefetched file is released.
+   \param path the file to read ahead
+   */
+  static void Prefetch(const CStdString &path);
+
+  /*! \brief Release the prefetched file and abort a running prefetch */
+  static void Release();
+
+  /*! \brief Check whether a file can be served from memory
+   \param url the (substituted) url of the file
+   \return true if the prefetch of the file has finished, false otherwise
+   */
+  static bool IsPrefetched(const CURL &url);
+
+  /*! \brief Retrieve the prefetch counters
+   \param hits [out] number of opens of a prefetched file served from memory
+   \param misses [out] number of opens of a requested file before its prefetch finished
+   \param bytes [out] number of bytes served from memory
+   */
+  static void GetStats(unsigned int &hits, unsigned int &misses, uint64_t &bytes);
+
+  class CPrefetchData;
+  typedef boost::shared_ptr<CPrefetchData> CPrefetchDataPtr;
+
+protected:
+  CPrefetchDataPtr m_data;
+  int64_t          m_position;
+  CFile            m_source;    ///< the original file, opened on demand for reads beyond the prefetched part
+  bool             m_sourceOpen;
+  uint64_t         m_served;    ///< bytes served from memory since Open()
+};
+}
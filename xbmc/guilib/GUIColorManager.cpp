@@ -20,6 +20,7 @@
  */
 
 #include "GUIColorManager.h"
+#include "GUITextLayout.h"
 #include "filesystem/SpecialProtocol.h"
 #include "addons/Skin.h"
 #include "utils/log.h"
@@ -40,6 +41,8 @@ CGUIColorManager::~CGUIColorManager(void)
 void CGUIColorManager::Clear()
 {
   m_colors.clear();
+  // cached layouts hold resolved colors
+  CGUITextLayout::ClearCache();
 }
 
 // load the color file in
@@ -25,6 +25,7 @@
 #include "addons/Skin.h"
 #include "GUIFontTTF.h"
 #include "GUIFont.h"
+#include "GUITextLayout.h"
 #include "utils/XMLUtils.h"
 #include "GUIControlFactory.h"
 #include "filesystem/File.h"
@@ -194,6 +195,9 @@ void GUIFontManager::ReloadTTFFonts(void)
   if (!m_vecFonts.size())
     return;   // we haven't even loaded fonts in yet
 
+  // the metrics of every font change
+  CGUITextLayout::ClearCache();
+
   for (unsigned int i = 0; i < m_vecFonts.size(); i++)
   {
     CGUIFont* font = m_vecFonts[i];
@@ -235,6 +239,7 @@ void GUIFontManager::Unload(const CStdString& strFontName)
     {
       delete (*iFont);
       m_vecFonts.erase(iFont);
+      CGUITextLayout::ClearCache();
       return;
     }
   }
@@ -324,6 +329,7 @@ void GUIFontManager::Clear()
   m_vecFontFiles.clear();
   m_vecFontInfo.clear();
   m_fontsetUnicode=false;
+  CGUITextLayout::ClearCache();
 }
 
 void GUIFontManager::LoadFonts(const CStdString& strFontSet)
@@ -28,6 +28,8 @@
 #include "utils/MathUtils.h"
 #include "utils/log.h"
 #include "windowing/WindowingFactory.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SystemClock.h"
 
 #include <math.h>
 
@@ -302,6 +304,14 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
   Character *ellipse = GetCharacter(L'.');
   if (ellipse) m_ellipsesWidth = ellipse->advance;
 
+  if (g_advancedSettings.m_guiPrewarmFonts)
+  { // render the printable ascii characters up front, so most labels don't need to render glyphs while drawing
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    for (character_t letter = 0x20; letter < 0x7f; letter++)
+      GetCharacter(letter);
+    CLog::Log(LOGDEBUG, "%s prerendered %i characters of %s (%f) in %u ms", __FUNCTION__, m_numChars, strFilename.c_str(), height, XbmcThreads::SystemClockMillis() - start);
+  }
+
   return true;
 }
 
@@ -498,25 +508,22 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
     memmove(m_char + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
   }
   // render the character to our texture
-  // must End() as we can't render text to our texture during a Begin(), End() block
-  unsigned int nestedBeginCount = m_nestedBeginCount;
-  m_nestedBeginCount = 1;
-  if (nestedBeginCount) End();
+  // the characters queued so far are only drawn if the texture has to be replaced,
+  // so a string with new characters doesn't cause a draw and upload per character
   if (!CacheCharacter(letter, style, m_char + low))
   { // unable to cache character - try clearing them all out and starting over
     CLog::Log(LOGDEBUG, "GUIFontTTF::GetCharacter: Unable to cache character.  Clearing character cache of %i characters", m_numChars);
+    unsigned int nestedBeginCount = FlushVertices();
     ClearCharacterCache();
     low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
+    bool cached = CacheCharacter(letter, style, m_char + low);
+    RestoreVertices(nestedBeginCount);
+    if (!cached)
     {
       CLog::Log(LOGERROR, "GUIFontTTF::GetCharacter: Unable to cache character (out of memory?)");
-      if (nestedBeginCount) Begin();
-      m_nestedBeginCount = nestedBeginCount;
       return NULL;
     }
   }
-  if (nestedBeginCount) Begin();
-  m_nestedBeginCount = nestedBeginCount;
 
   // fixup quick access
   memset(m_charquick, 0, sizeof(m_charquick));
@@ -587,15 +594,19 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
         return false;
       }
 
+      // the queued characters refer to the current texture and its size
+      unsigned int nestedBeginCount = FlushVertices();
       CBaseTexture* newTexture = NULL;
       newTexture = ReallocTexture(newHeight);
       if(newTexture == NULL)
       {
+        RestoreVertices(nestedBeginCount);
         FT_Done_Glyph(glyph);
         CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: Failed to allocate new texture of height %u", newHeight);
         return false;
       }
       m_texture = newTexture;
+      RestoreVertices(nestedBeginCount);
     }
   }
 
@@ -632,6 +643,27 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   return true;
 }
 
+unsigned int CGUIFontTTFBase::FlushVertices()
+{
+  // draw what has been queued and leave the Begin() block, whatever its nesting
+  unsigned int nestedBeginCount = m_nestedBeginCount;
+  if (nestedBeginCount)
+  {
+    m_nestedBeginCount = 1;
+    End();
+  }
+  return nestedBeginCount;
+}
+
+void CGUIFontTTFBase::RestoreVertices(unsigned int nestedBeginCount)
+{
+  if (nestedBeginCount)
+  {
+    Begin();
+    m_nestedBeginCount = nestedBeginCount;
+  }
+}
+
 void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX)
 {
   // actual image width isn't same as the character width as that is
@@ -112,7 +112,16 @@ protected:
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
   void ClearCharacterCache();
 
+  /*! \brief Draw the queued characters before the texture is replaced, ending any Begin() block
+   \return the nesting of the Begin() block, to be passed to RestoreVertices()
+   */
+  unsigned int FlushVertices();
+  void RestoreVertices(unsigned int nestedBeginCount);
+
   virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
+  /*! \brief Copy a rendered character into the texture
+   May be called within a Begin() block, the character has to be drawable by the following End().
+   */
   virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, Character *ch) = 0;
   virtual void DeleteHardwareTexture() = 0;
 
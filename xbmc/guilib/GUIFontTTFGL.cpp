@@ -46,6 +46,8 @@ using namespace std;
 CGUIFontTTFGL::CGUIFontTTFGL(const CStdString& strFileName)
 : CGUIFontTTFBase(strFileName)
 {
+  m_updateY1 = 0;
+  m_updateY2 = 0;
 }
 
 CGUIFontTTFGL::~CGUIFontTTFGL(void)
@@ -76,6 +78,7 @@ void CGUIFontTTFGL::Begin()
 
       VerifyGLState();
       m_bTextureLoaded = true;
+      m_updateY1 = m_updateY2 = 0;
     }
 
     // Turn Blending On
@@ -116,6 +119,9 @@ void CGUIFontTTFGL::End()
   if (--m_nestedBeginCount > 0)
     return;
 
+  // characters rendered since Begin() are uploaded in one go
+  UploadTexture();
+
 #ifdef HAS_GL
   glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
 
@@ -183,6 +189,15 @@ CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int& newHeight)
   m_textureHeight = newTexture->GetHeight();
   m_textureWidth = newTexture->GetWidth();
 
+  // the new texture is uploaded as a whole by the next Begin()
+  if (m_bTextureLoaded)
+  {
+    g_graphicsContext.BeginPaint();  //FIXME
+    DeleteHardwareTexture();
+    g_graphicsContext.EndPaint();
+  }
+  m_updateY1 = m_updateY2 = 0;
+
   memset(newTexture->GetPixels(), 0, m_textureHeight * newTexture->GetPitch());
   if (m_texture)
   {
@@ -215,19 +230,36 @@ bool CGUIFontTTFGL::CopyCharToTexture(FT_BitmapGlyph bitGlyph, Character* ch)
   }
   // THE SOURCE VALUES ARE THE SAME IN BOTH SITUATIONS.
 
-  // Since we have a new texture, we need to delete the old one
-  // the Begin(); End(); stuff is handled by whoever called us
-  if (m_bTextureLoaded)
+  // the changed rows are uploaded by the next End(), together with any other new characters
+  unsigned int y1 = m_posY + ch->offsetY;
+  unsigned int y2 = y1 + bitmap.rows;
+  if (m_updateY2 > m_updateY1)
   {
-    g_graphicsContext.BeginPaint();  //FIXME
-    DeleteHardwareTexture();
-    g_graphicsContext.EndPaint();
-    m_bTextureLoaded = false;
+    m_updateY1 = min(m_updateY1, y1);
+    m_updateY2 = max(m_updateY2, y2);
+  }
+  else
+  {
+    m_updateY1 = y1;
+    m_updateY2 = y2;
   }
 
   return TRUE;
 }
 
+void CGUIFontTTFGL::UploadTexture()
+{
+  if (!m_bTextureLoaded || m_updateY2 <= m_updateY1 || !m_texture)
+    return;
+
+  // the texture is bound by Begin()
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_updateY1, m_texture->GetWidth(), m_updateY2 - m_updateY1,
+                  GL_ALPHA, GL_UNSIGNED_BYTE, m_texture->GetPixels() + m_updateY1 * m_texture->GetPitch());
+  VerifyGLState();
+
+  m_updateY1 = m_updateY2 = 0;
+}
+
 
 void CGUIFontTTFGL::DeleteHardwareTexture()
 {
@@ -50,6 +50,11 @@ protected:
   virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, Character *ch);
   virtual void DeleteHardwareTexture();
 
+private:
+  void UploadTexture();
+
+  unsigned int m_updateY1;  // rows of the texture changed since it was last uploaded
+  unsigned int m_updateY2;
 };
 
 #endif
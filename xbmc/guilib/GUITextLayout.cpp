@@ -23,13 +23,193 @@
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
+#include "GraphicContext.h"
 #include "utils/CharsetConverter.h"
 #include "utils/StringUtils.h"
+#include "utils/log.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Atomics.h"
+
+#include <list>
+#include <map>
 
 using namespace std;
 
 #define WORK_AROUND_NEEDED_FOR_LINE_BREAKS
 
+// number of layouts kept in the cache, and the longest text that is cached
+#define LAYOUT_CACHE_SIZE      2048
+#define LAYOUT_CACHE_MAX_TEXT  4096
+// number of lookups between hit rate reports in the debug log
+#define LAYOUT_CACHE_REPORT    50000
+
+// bumped by ClearCache().  A plain counter is used so fonts and colors may be
+// cleared at any time, including during static destruction.
+static volatile long g_layoutCacheGeneration = 0;
+
+/*! \brief LRU cache of finished text layouts, shared by all CGUITextLayout instances
+ A layout depends on the text and everything ParseText(), WrapText() and
+ BidiTransform() take into account: the font, the wrapping width (if wrapping),
+ the maximum height, the reading order and the default text color.  Text is
+ measured in the current GUI scale, so the scale is part of the key as well.
+ Alignment is only applied at render time, so it is not part of the key.
+ */
+class CTextLayoutCache
+{
+public:
+  class CKey
+  {
+  public:
+    CKey(const CStdStringW &text, const CGUITextLayout &layout, float maxWidth, bool forceLTRReadingOrder)
+      : m_text(text)
+    {
+      m_hash = 2166136261u;
+      for (unsigned int i = 0; i < text.size(); i++)
+        m_hash = (m_hash ^ (uint32_t)text[i]) * 16777619u;
+      m_font = layout.m_font;
+      m_maxWidth = (layout.m_wrap && maxWidth > 0) ? maxWidth : 0;
+      m_maxHeight = layout.m_maxHeight;
+      m_wrap = layout.m_wrap;
+      m_forceLTR = forceLTRReadingOrder;
+      m_textColor = layout.m_textColor;
+      m_scaleX = g_graphicsContext.GetGUIScaleX();
+      m_scaleY = g_graphicsContext.GetGUIScaleY();
+    }
+
+    bool operator<(const CKey &right) const
+    {
+      if (m_hash != right.m_hash) return m_hash < right.m_hash;
+      if (m_font != right.m_font) return m_font < right.m_font;
+      if (m_maxWidth != right.m_maxWidth) return m_maxWidth < right.m_maxWidth;
+      if (m_maxHeight != right.m_maxHeight) return m_maxHeight < right.m_maxHeight;
+      if (m_wrap != right.m_wrap) return m_wrap < right.m_wrap;
+      if (m_forceLTR != right.m_forceLTR) return m_forceLTR < right.m_forceLTR;
+      if (m_textColor != right.m_textColor) return m_textColor < right.m_textColor;
+      if (m_scaleX != right.m_scaleX) return m_scaleX < right.m_scaleX;
+      if (m_scaleY != right.m_scaleY) return m_scaleY < right.m_scaleY;
+      return m_text.compare(right.m_text) < 0;
+    }
+
+  private:
+    CStdStringW m_text;
+    uint32_t    m_hash;
+    CGUIFont   *m_font;
+    float       m_maxWidth;
+    float       m_maxHeight;
+    bool        m_wrap;
+    bool        m_forceLTR;
+    color_t     m_textColor;
+    float       m_scaleX;
+    float       m_scaleY;
+  };
+
+  CTextLayoutCache()
+  {
+    m_generation = 0;
+    m_hits = m_misses = 0;
+  }
+
+  /*! \brief Fill in the lines, colors and extents of a layout from the cache
+   \return true if the layout was cached, false otherwise
+   */
+  bool Get(const CKey &key, CGUITextLayout &layout)
+  {
+    CSingleLock lock(m_critSection);
+    CheckGeneration();
+    Map::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+      m_misses++;
+      Report();
+      return false;
+    }
+    // move to the front of the LRU list
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    const CEntry &entry = it->second;
+    layout.m_lines = entry.lines;
+    layout.m_colors = entry.colors;
+    layout.m_textWidth = entry.width;
+    layout.m_textHeight = entry.height;
+    m_hits++;
+    Report();
+    return true;
+  }
+
+  void Add(const CKey &key, const CGUITextLayout &layout)
+  {
+    CSingleLock lock(m_critSection);
+    CheckGeneration();
+    pair<Map::iterator, bool> result = m_entries.insert(make_pair(key, CEntry()));
+    CEntry &entry = result.first->second;
+    if (result.second)
+    {
+      m_lru.push_front(result.first);
+      entry.lru = m_lru.begin();
+    }
+    entry.lines = layout.m_lines;
+    entry.colors = layout.m_colors;
+    entry.width = layout.m_textWidth;
+    entry.height = layout.m_textHeight;
+
+    while (m_entries.size() > LAYOUT_CACHE_SIZE)
+    {
+      m_entries.erase(m_lru.back());
+      m_lru.pop_back();
+    }
+  }
+
+  void GetStats(unsigned int &hits, unsigned int &misses)
+  {
+    CSingleLock lock(m_critSection);
+    hits = m_hits;
+    misses = m_misses;
+  }
+
+private:
+  class CEntry;
+  typedef map<CKey, CEntry> Map;
+  typedef list<Map::iterator> LRUList;
+
+  class CEntry
+  {
+  public:
+    vector<CGUIString> lines;
+    vecColors          colors;
+    float              width;
+    float              height;
+    LRUList::iterator  lru;
+  };
+
+  void CheckGeneration()
+  {
+    long generation = g_layoutCacheGeneration;
+    if (generation != m_generation)
+    {
+      m_entries.clear();
+      m_lru.clear();
+      m_generation = generation;
+    }
+  }
+
+  void Report()
+  {
+    unsigned int lookups = m_hits + m_misses;
+    if (lookups % LAYOUT_CACHE_REPORT == 0)
+      CLog::Log(LOGDEBUG, "%s - %u lookups, %.1f%% hits, %u layouts cached", __FUNCTION__,
+                lookups, 100.0f * m_hits / lookups, (unsigned int)m_entries.size());
+  }
+
+  Map              m_entries;
+  LRUList          m_lru;
+  long             m_generation;
+  unsigned int     m_hits;
+  unsigned int     m_misses;
+  CCriticalSection m_critSection;
+};
+
+static CTextLayoutCache g_layoutCache;
+
 CGUIString::CGUIString(iString start, iString end, bool carriageReturn)
 {
   m_text.assign(start, end);
@@ -208,6 +388,15 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   if (text.Equals(m_lastText) && !forceUpdate)
     return false;
 
+  // another control may already have laid out the same text
+  bool cacheable = m_font && text.size() <= LAYOUT_CACHE_MAX_TEXT;
+  CTextLayoutCache::CKey key(cacheable ? text : CStdStringW(), *this, maxWidth, forceLTRReadingOrder);
+  if (cacheable && g_layoutCache.Get(key, *this))
+  {
+    m_lastText = text;
+    return true;
+  }
+
   vecText parsedText;
 
   // empty out our previous string
@@ -236,6 +425,9 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   // and cache the width and height for later reading
   CalcTextExtent();
 
+  if (cacheable)
+    g_layoutCache.Add(key, *this);
+
   m_lastText = text;
   return true;
 }
@@ -627,6 +819,16 @@ void CGUITextLayout::AppendToUTF32(const CStdString &utf8, character_t colStyle,
   AppendToUTF32(utf16, colStyle, utf32);
 }
 
+void CGUITextLayout::ClearCache()
+{
+  AtomicIncrement(&g_layoutCacheGeneration);
+}
+
+void CGUITextLayout::GetCacheStats(unsigned int &hits, unsigned int &misses)
+{
+  g_layoutCache.GetStats(hits, misses);
+}
+
 void CGUITextLayout::Reset()
 {
   m_lines.clear();
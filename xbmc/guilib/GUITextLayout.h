@@ -100,6 +100,19 @@ public:
   static void DrawText(CGUIFont *font, float x, float y, color_t color, color_t shadowColor, const CStdString &text, uint32_t align);
   static void Filter(CStdString &text);
 
+  /*! \brief Drop all cached layouts
+   Layouts are shared between controls through a cache keyed by the text, font and
+   wrapping parameters.  It must be cleared whenever fonts or colors are (re)loaded,
+   as fonts may be recreated at the same address.
+   */
+  static void ClearCache();
+
+  /*! \brief Retrieve the number of layout requests served from and missing the cache
+   \param hits [out] number of layouts taken from the cache
+   \param misses [out] number of layouts that had to be computed
+   */
+  static void GetCacheStats(unsigned int &hits, unsigned int &misses);
+
 protected:
   void ParseText(const CStdStringW &text, vecText &parsedText);
   void LineBreakText(const vecText &text, std::vector<CGUIString> &lines);
@@ -140,5 +153,7 @@ private:
   static void ParseText(const CStdStringW &text, uint32_t defaultStyle, vecColors &colors, vecText &parsedText);
 
   static void utf8ToW(const CStdString &utf8, CStdStringW &utf16);
+
+  friend class CTextLayoutCache;
 };
 
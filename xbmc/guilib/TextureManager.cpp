@@ -477,6 +477,13 @@ void CGUITextureManager::Cleanup()
   FreeUnusedTextures();
 }
 
+void CGUITextureManager::OpenBundles()
+{
+  // bundles are opened on the first lookup, which reads the whole file index
+  for (int i = 0; i < 2; i++)
+    m_TexBundle[i].HasFile("");
+}
+
 void CGUITextureManager::Dump() const
 {
   CStdString strLog;
@@ -21,6 +21,8 @@
 
 #include "AnnouncementManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
 #include <stdio.h>
 #include "utils/log.h"
 #include "utils/Variant.h"
@@ -31,8 +33,39 @@
 using namespace std;
 using namespace ANNOUNCEMENT;
 
+// announcements waiting for delivery before the oldest ones are dropped
+#define ANNOUNCEMENT_QUEUE_LIMIT 1000
+
 CCriticalSection CAnnouncementManager::m_critSection;
 vector<IAnnouncer *> CAnnouncementManager::m_announcers;
+deque<CAnnouncementManager::CAnnouncement> CAnnouncementManager::m_queue;
+CCriticalSection CAnnouncementManager::m_queueSection;
+CEvent CAnnouncementManager::m_queueEvent;
+AnnouncementStatistics CAnnouncementManager::m_stats = { 0, 0, 0, 0, 0, 0 };
+
+namespace ANNOUNCEMENT
+{
+  /*! \brief Delivers queued announcements to the announcers, so producers never
+   wait for a slow announcer such as a JSON-RPC client.
+   */
+  class CAnnouncementThread : public CThread
+  {
+  public:
+    CAnnouncementThread() : CThread("CAnnouncementThread") { }
+  protected:
+    virtual void Process()
+    {
+      while (!m_bStop)
+      {
+        CAnnouncementManager::m_queueEvent.WaitMSec(500);
+        CAnnouncementManager::DeliverQueued();
+      }
+    }
+  };
+}
+
+static CAnnouncementThread *g_announcementThread = NULL;
+static bool g_announcementThreadStopped = false;
 
 void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
 {
@@ -62,9 +95,45 @@ void CAnnouncementManager::Announce(EAnnouncementFlag flag, const char *sender,
 void CAnnouncementManager::Announce(EAnnouncementFlag flag, const char *sender, const char *message, CVariant &data)
 {
   CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
-  CSingleLock lock (m_critSection);
-  for (unsigned int i = 0; i < m_announcers.size(); i++)
-    m_announcers[i]->Announce(flag, sender, message, data);
+
+  CAnnouncement announcement;
+  announcement.flag    = flag;
+  announcement.sender  = sender;
+  announcement.message = message;
+  announcement.data    = data;
+  announcement.time    = XbmcThreads::SystemClockMillis();
+
+  // system announcements (OnQuit, OnSleep, ...) are delivered before the
+  // caller goes on, after everything that was announced before them
+  if (flag == System || g_announcementThreadStopped)
+  {
+    CSingleLock lock(m_critSection);
+    DeliverQueued();
+    Deliver(announcement);
+    return;
+  }
+
+  {
+    CSingleLock lock(m_queueSection);
+    if (Coalesce(announcement))
+      return;
+
+    if (m_queue.size() >= ANNOUNCEMENT_QUEUE_LIMIT)
+    {
+      if (m_stats.dropped++ == 0)
+        CLog::Log(LOGWARNING, "CAnnouncementManager - queue is full, dropping announcements");
+      m_queue.pop_front();
+    }
+    m_queue.push_back(announcement);
+    m_stats.queued = m_queue.size();
+
+    if (!g_announcementThread)
+    {
+      g_announcementThread = new CAnnouncementThread();
+      g_announcementThread->Create();
+    }
+  }
+  m_queueEvent.Set();
 }
 
 void CAnnouncementManager::Announce(EAnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item)
@@ -139,3 +208,99 @@ void CAnnouncementManager::Announce(EAnnouncementFlag flag, const char *sender,
 
   Announce(flag, sender, message, object);
 }
+
+void CAnnouncementManager::Deinitialize()
+{
+  CAnnouncementThread *thread = NULL;
+  {
+    CSingleLock lock(m_queueSection);
+    thread = g_announcementThread;
+    g_announcementThread = NULL;
+    g_announcementThreadStopped = true;
+  }
+  if (thread)
+  {
+    thread->StopThread();
+    delete thread;
+  }
+
+  // hand out what is left on the caller's thread
+  {
+    CSingleLock lock(m_critSection);
+    DeliverQueued();
+  }
+
+  AnnouncementStatistics stats;
+  GetStatistics(stats);
+  CLog::Log(LOGDEBUG, "CAnnouncementManager - %u announcements delivered, %u coalesced, %u dropped, maximum delay %u ms",
+            stats.delivered, stats.coalesced, stats.dropped, stats.maxLag);
+}
+
+void CAnnouncementManager::GetStatistics(AnnouncementStatistics &stats)
+{
+  CSingleLock lock(m_queueSection);
+  stats = m_stats;
+}
+
+bool CAnnouncementManager::Coalesce(const CAnnouncement &announcement)
+{
+  // only updates of a single item with the same fields replace each other
+  if (!announcement.data.isObject() || !announcement.data.isMember("item") || !announcement.data["item"].isMember("id"))
+    return false;
+
+  // look for the latest queued announcement about the same item
+  for (deque<CAnnouncement>::reverse_iterator it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+  {
+    if (!it->data.isObject() || !it->data.isMember("item") || !(it->data["item"] == announcement.data["item"]))
+      continue;
+
+    if (it->flag != announcement.flag || it->message != announcement.message || it->sender != announcement.sender ||
+        it->data.size() != announcement.data.size())
+      return false;
+
+    for (CVariant::const_iterator_map field = announcement.data.begin_map(); field != announcement.data.end_map(); field++)
+    {
+      if (!it->data.isMember(field->first))
+        return false;
+    }
+
+    it->data = announcement.data;
+    m_stats.coalesced++;
+    return true;
+  }
+  return false;
+}
+
+void CAnnouncementManager::DeliverQueued()
+{
+  // m_critSection is held so that announcements are delivered in order
+  CSingleLock lock(m_critSection);
+  while (true)
+  {
+    CAnnouncement announcement;
+    {
+      CSingleLock queueLock(m_queueSection);
+      if (m_queue.empty())
+        break;
+      announcement = m_queue.front();
+      m_queue.pop_front();
+      m_stats.queued = m_queue.size();
+    }
+    Deliver(announcement);
+  }
+}
+
+void CAnnouncementManager::Deliver(const CAnnouncement &announcement)
+{
+  unsigned int lag = XbmcThreads::SystemClockMillis() - announcement.time;
+
+  CSingleLock lock(m_critSection);
+  for (unsigned int i = 0; i < m_announcers.size(); i++)
+    m_announcers[i]->Announce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.data);
+
+  CSingleLock queueLock(m_queueSection);
+  m_stats.delivered++;
+  m_stats.lastLag = lag;
+  if (lag > m_stats.maxLag)
+    m_stats.maxLag = lag;
+}
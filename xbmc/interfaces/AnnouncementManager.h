@@ -23,10 +23,25 @@
 #include "IAnnouncer.h"
 #include "FileItem.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/Variant.h"
+#include <deque>
+#include <string>
 #include <vector>
 
 namespace ANNOUNCEMENT
 {
+  /*! \brief Delivery counters of the announcement queue */
+  struct AnnouncementStatistics
+  {
+    unsigned int queued;     ///< announcements currently waiting for delivery
+    unsigned int delivered;  ///< announcements delivered to the announcers
+    unsigned int coalesced;  ///< announcements merged into a queued one for the same item
+    unsigned int dropped;    ///< announcements dropped because the queue was full
+    unsigned int lastLag;    ///< time in ms the last delivered announcement waited in the queue
+    unsigned int maxLag;     ///< highest such time seen
+  };
+
   class CAnnouncementManager
   {
   public:
@@ -36,8 +51,32 @@ namespace ANNOUNCEMENT
     static void Announce(EAnnouncementFlag flag, const char *sender, const char *message, CVariant &data);
     static void Announce(EAnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item);
     static void Announce(EAnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data);
+
+    /*! \brief Deliver all queued announcements and stop the delivery thread */
+    static void Deinitialize();
+    static void GetStatistics(AnnouncementStatistics &stats);
   private:
+    friend class CAnnouncementThread;
+
+    struct CAnnouncement
+    {
+      EAnnouncementFlag flag;
+      std::string       sender;
+      std::string       message;
+      CVariant          data;
+      unsigned int      time;
+    };
+
+    static bool Coalesce(const CAnnouncement &announcement);
+    static void Deliver(const CAnnouncement &announcement);
+    static void DeliverQueued();
+
     static std::vector<IAnnouncer *> m_announcers;
     static CCriticalSection m_critSection;
+
+    static std::deque<CAnnouncement> m_queue;
+    static CCriticalSection m_queueSection;
+    static CEvent m_queueEvent;
+    static AnnouncementStatistics m_stats;
   };
 }
@@ -39,6 +39,37 @@ using namespace MUSIC_INFO;
 using namespace JSONRPC;
 using namespace XFILE;
 
+/*! \brief Items of a list that are only serialized while the response is written
+ Every item is released once it has been written.
+ */
+class CFileItemHandler::CDeferredItemList : public IDeferredResult
+{
+public:
+  CDeferredItemList(const char *ID, bool allowFile, const char *resultname, const CVariant &parameterObject)
+    : m_ID(ID ? ID : ""), m_allowFile(allowFile), m_resultname(resultname), m_parameterObject(parameterObject)
+  {
+  }
+
+  virtual const char *GetName() const { return m_resultname.c_str(); }
+  virtual unsigned int Size() const { return m_items.size(); }
+
+  virtual void GetItem(unsigned int index, CVariant &item)
+  {
+    CVariant result;
+    HandleFileItem(m_ID.empty() ? NULL : m_ID.c_str(), m_allowFile, m_resultname.c_str(), m_items[index], m_parameterObject, m_parameterObject["fields"], result, false);
+    item = result[m_resultname];
+    m_items[index].reset();
+  }
+
+  std::vector<CFileItemPtr> m_items;
+
+private:
+  std::string m_ID;
+  bool        m_allowFile;
+  std::string m_resultname;
+  CVariant    m_parameterObject;
+};
+
 void CFileItemHandler::FillDetails(ISerializable* info, CFileItemPtr item, const CVariant& fields, CVariant &result)
 {
   if (info == NULL || fields.size() == 0)
@@ -88,7 +119,7 @@ void CFileItemHandler::FillDetails(ISerializable* info, CFileItemPtr item, const
   }
 }
 
-void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result)
+void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, bool deferrable /* = true */)
 {
   int size  = items.Size();
   int start = (int)parameterObject["limits"]["start"].asInteger();
@@ -102,6 +133,17 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
   result["limits"]["end"]   = end;
   result["limits"]["total"] = size;
 
+  if (deferrable && resultname && start < end)
+  {
+    CDeferredItemList *list = new CDeferredItemList(ID, allowFile, resultname, parameterObject);
+    DeferredResultPtr deferred(list);
+    for (int i = start; i < end; i++)
+      list->m_items.push_back(items.Get(i));
+
+    if (CJSONRPC::Defer(deferred))
+      return;
+  }
+
   for (int i = start; i < end; i++)
   {
     CVariant object;
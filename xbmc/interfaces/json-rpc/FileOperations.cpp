@@ -139,14 +139,14 @@ JSON_STATUS CFileOperations::GetDirectory(const CStdString &method, ITransportLa
     if (!hasFileField)
       param["fields"].append("file");
 
-    HandleFileItemList(NULL, true, "files", filteredDirectories, param, result);
+    HandleFileItemList(NULL, true, "files", filteredDirectories, param, result, false);
     for (unsigned int index = 0; index < result["files"].size(); index++)
     {
       result["files"][index]["filetype"] = "directory";
     }
     int count = (int)result["limits"]["total"].asInteger();
 
-    HandleFileItemList("id", true, "files", filteredFiles, param, result);
+    HandleFileItemList("id", true, "files", filteredFiles, param, result, false);
     for (unsigned int index = count; index < result["files"].size(); index++)
     {
       result["files"][index]["filetype"] = "file";
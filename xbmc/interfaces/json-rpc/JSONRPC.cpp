@@ -20,11 +20,13 @@
  */
 
 #include "JSONRPC.h"
+#include "JSONResponseWriter.h"
 #include "settings/AdvancedSettings.h"
 #include "interfaces/AnnouncementManager.h"
 #include "interfaces/AnnouncementUtils.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
+#include "threads/ThreadLocal.h"
 #include <string.h>
 #include "ServiceDescription.h"
 
@@ -32,6 +34,9 @@ using namespace ANNOUNCEMENT;
 using namespace JSONRPC;
 using namespace std;
 
+// lists deferred by the call executing on the current thread, if the transport supports it
+static XbmcThreads::ThreadLocal<DeferredResults> deferredResults;
+
 bool CJSONRPC::m_initialized = false;
 
 void CJSONRPC::Initialize()
@@ -149,30 +154,20 @@ JSON_STATUS CJSONRPC::NotifyAll(const CStdString &method, ITransportLayer *trans
 
 CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client)
 {
-  CVariant inputroot, outputroot, result;
+  CVariant inputroot, outputroot;
   bool hasResponse = false;
 
-  inputroot = CJSONVariantParser::Parse((unsigned char *)inputString.c_str(), inputString.length());
-  if (!inputroot.isNull())
+  if (ParseCall(inputString, inputroot, outputroot))
   {
     if (inputroot.isArray())
     {
-      if (inputroot.size() <= 0)
-      {
-        CLog::Log(LOGERROR, "JSONRPC: Empty batch call\n");
-        BuildResponse(inputroot, InvalidRequest, CVariant(), outputroot);
-        hasResponse = true;
-      }
-      else
+      for (CVariant::const_iterator_array itr = inputroot.begin_array(); itr != inputroot.end_array(); itr++)
       {
-        for (CVariant::const_iterator_array itr = inputroot.begin_array(); itr != inputroot.end_array(); itr++)
+        CVariant response;
+        if (HandleMethodCall(*itr, response, transport, client))
         {
-          CVariant response;
-          if (HandleMethodCall(*itr, response, transport, client))
-          {
-            outputroot.append(response);
-            hasResponse = true;
-          }
+          outputroot.append(response);
+          hasResponse = true;
         }
       }
     }
@@ -180,17 +175,97 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
       hasResponse = HandleMethodCall(inputroot, outputroot, transport, client);
   }
   else
-  {
-    CLog::Log(LOGERROR, "JSONRPC: Failed to parse '%s'\n", inputString.c_str());
-    BuildResponse(inputroot, ParseError, CVariant(), outputroot);
     hasResponse = true;
-  }
 
   CStdString str = hasResponse ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
   return str;
 }
 
+CJSONResponseWriter *CJSONRPC::StreamMethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client)
+{
+  CVariant inputroot, response;
+  DeferredResults deferred;
+
+  if (!ParseCall(inputString, inputroot, response))
+  {
+    CJSONResponseWriter *writer = new CJSONResponseWriter(false, g_advancedSettings.m_jsonOutputCompact);
+    writer->AddResponse(response, deferred);
+    return writer;
+  }
+
+  CJSONResponseWriter *writer = new CJSONResponseWriter(inputroot.isArray(), g_advancedSettings.m_jsonOutputCompact);
+  if (inputroot.isArray())
+  {
+    for (CVariant::const_iterator_array itr = inputroot.begin_array(); itr != inputroot.end_array(); itr++)
+    {
+      CVariant response;
+      if (HandleMethodCall(*itr, response, deferred, transport, client))
+        writer->AddResponse(response, deferred);
+    }
+  }
+  else if (HandleMethodCall(inputroot, response, deferred, transport, client))
+    writer->AddResponse(response, deferred);
+
+  return writer;
+}
+
+bool CJSONRPC::ParseCall(const CStdString &inputString, CVariant &call, CVariant &response)
+{
+  call = CJSONVariantParser::Parse((unsigned char *)inputString.c_str(), inputString.length());
+  if (call.isNull())
+  {
+    CLog::Log(LOGERROR, "JSONRPC: Failed to parse '%s'\n", inputString.c_str());
+    BuildResponse(call, ParseError, CVariant(), response);
+    return false;
+  }
+
+  if (call.isArray() && call.size() <= 0)
+  {
+    CLog::Log(LOGERROR, "JSONRPC: Empty batch call\n");
+    BuildResponse(call, InvalidRequest, CVariant(), response);
+    return false;
+  }
+
+  return true;
+}
+
+bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, DeferredResults &deferred, ITransportLayer *transport, IClient *client)
+{
+  deferred.clear();
+
+  DeferredResults *previous = deferredResults.get();
+  deferredResults.set(&deferred);
+  bool hasResponse = ExecuteMethodCall(request, response, transport, client);
+  deferredResults.set(previous);
+
+  // an error response has no result to attach the lists to
+  if (!response.isMember("result"))
+    deferred.clear();
+
+  return hasResponse;
+}
+
+bool CJSONRPC::Defer(const DeferredResultPtr &result)
+{
+  DeferredResults *deferred = deferredResults.get();
+  if (deferred == NULL)
+    return false;
+
+  deferred->push_back(result);
+  return true;
+}
+
 bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
+{
+  DeferredResults *previous = deferredResults.get();
+  deferredResults.set(NULL);
+  bool hasResponse = ExecuteMethodCall(request, response, transport, client);
+  deferredResults.set(previous);
+
+  return hasResponse;
+}
+
+bool CJSONRPC::ExecuteMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
 {
   JSON_STATUS errorCode = OK;
   CVariant result;
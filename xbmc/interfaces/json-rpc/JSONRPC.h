@@ -25,6 +25,8 @@
 #include <stdio.h>
 #include <string>
 #include <iostream>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include "ITransportLayer.h"
 #include "interfaces/IAnnouncer.h"
 #include "JSONUtils.h"
@@ -32,6 +34,31 @@
 
 namespace JSONRPC
 {
+  /*!
+   \ingroup jsonrpc
+   \brief List in the result of a call whose elements are only serialized
+   while the response is being written
+
+   Handlers producing potentially large lists can hand them over with
+   CJSONRPC::Defer() instead of adding every element to the result, so the
+   elements exist one at a time while the response is streamed out.
+   */
+  class IDeferredResult
+  {
+  public:
+    virtual ~IDeferredResult() {}
+
+    /*! \brief Name of the member of the result object holding the list */
+    virtual const char *GetName() const = 0;
+    virtual unsigned int Size() const = 0;
+    virtual void GetItem(unsigned int index, CVariant &item) = 0;
+  };
+
+  typedef boost::shared_ptr<IDeferredResult> DeferredResultPtr;
+  typedef std::vector<DeferredResultPtr> DeferredResults;
+
+  class CJSONResponseWriter;
+
   /*!
    \ingroup jsonrpc
    \brief JSON RPC handler
@@ -63,6 +90,56 @@ namespace JSONRPC
      */
     static CStdString MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client);
 
+    /*!
+     \brief Handles an incoming JSON RPC request and streams the response
+     \param inputString received JSON RPC request
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \return writer generating the response on demand, to be deleted by the caller
+
+     Same as MethodCall() except that the response is not serialized as a
+     whole, and handlers may defer the items of large results until they are
+     written.
+     */
+    static CJSONResponseWriter *StreamMethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client);
+
+    /*!
+     \brief Parses an incoming JSON RPC request without executing it
+     \param inputString received JSON RPC request
+     \param call [out] the parsed call, or an array of calls for a batch request
+     \param response [out] the error response if the request can't be executed
+     \return true if call holds the call(s) to execute, false if response has to be sent back instead
+
+     Together with HandleMethodCall() this allows transports to execute the
+     calls of a request elsewhere than where it was received.
+     */
+    static bool ParseCall(const CStdString &inputString, CVariant &call, CVariant &response);
+
+    /*!
+     \brief Executes a single parsed call
+     \param request the call, as returned by ParseCall() or an element of a batch
+     \param response [out] the JSON RPC response of the call
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \return true if the response has to be sent back, false if the call was a notification
+     */
+    static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
+
+    /*!
+     \brief Executes a single parsed call, allowing the result to contain deferred lists
+     \param deferred [out] lists that belong in the result object of the response and
+     have to be written along with it, e.g. by a CJSONResponseWriter
+     \sa HandleMethodCall(), Defer()
+     */
+    static bool HandleMethodCall(const CVariant& request, CVariant& response, DeferredResults &deferred, ITransportLayer *transport, IClient *client);
+
+    /*!
+     \brief Hands over a list of the result of the call being executed on this thread
+     \param result the list to serialize once the response is written
+     \return true if the list was taken, false if the caller has to add it to the result itself
+     */
+    static bool Defer(const DeferredResultPtr &result);
+
     static JSON_STATUS Introspect(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSON_STATUS Version(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSON_STATUS Permission(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
@@ -73,7 +150,7 @@ namespace JSONRPC
   
   private:
     static void setup();
-    static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
+    static bool ExecuteMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
     static inline bool IsProperJSONRPC(const CVariant& inputroot);
 
     inline static void BuildResponse(const CVariant& request, JSON_STATUS code, const CVariant& result, CVariant& response);
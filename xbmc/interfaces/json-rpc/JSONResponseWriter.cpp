@@ -0,0 +1,178 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "JSONResponseWriter.h"
+#include "utils/log.h"
+#include <string.h>
+
+using namespace JSONRPC;
+using namespace std;
+
+CJSONResponseWriter::CJSONResponseWriter(bool batch, bool compact)
+  : m_batch(batch), m_writer(compact)
+{
+  m_state = StateBegin;
+  m_response = 0;
+  m_list = 0;
+  m_item = 0;
+  m_listOpen = false;
+  m_bufferPos = 0;
+}
+
+void CJSONResponseWriter::AddResponse(const CVariant &response, const DeferredResults &deferred)
+{
+  Response entry;
+  entry.response = response;
+  entry.deferred = deferred;
+  m_responses.push_back(entry);
+}
+
+bool CJSONResponseWriter::Read(string &output, unsigned int size)
+{
+  while (m_writer.Pending() < size && WriteNext()) ;
+
+  if (m_state == StateDone && m_writer.Pending() == 0)
+    return false;
+
+  m_writer.Take(output);
+  return true;
+}
+
+unsigned int CJSONResponseWriter::Read(char *buffer, unsigned int size)
+{
+  if (m_bufferPos >= m_buffer.size())
+  {
+    m_buffer.clear();
+    m_bufferPos = 0;
+    if (!Read(m_buffer))
+      return 0;
+  }
+
+  unsigned int length = min((size_t)size, m_buffer.size() - m_bufferPos);
+  memcpy(buffer, m_buffer.c_str() + m_bufferPos, length);
+  m_bufferPos += length;
+  return length;
+}
+
+bool CJSONResponseWriter::WriteNext()
+{
+  bool success = true;
+
+  switch (m_state)
+  {
+  case StateBegin:
+    if (m_batch)
+      success = m_writer.BeginArray();
+    m_state = StateResponse;
+    break;
+
+  case StateResponse:
+    if (m_response >= m_responses.size())
+    {
+      m_state = StateEnd;
+      break;
+    }
+
+    if (m_responses[m_response].deferred.empty())
+    {
+      success = m_writer.Value(m_responses[m_response].response);
+      m_responses[m_response].response = CVariant();
+      m_response++;
+    }
+    else
+    { // everything but the deferred lists, which go last into the result
+      const CVariant &response = m_responses[m_response].response;
+      success = m_writer.BeginObject();
+      for (CVariant::const_iterator_map itr = response.begin_map(); itr != response.end_map() && success; itr++)
+      {
+        if (itr->first == "result")
+          continue;
+        success = m_writer.Key(itr->first) && m_writer.Value(itr->second);
+      }
+
+      const CVariant &result = response["result"];
+      success = success && m_writer.Key("result") && m_writer.BeginObject();
+      for (CVariant::const_iterator_map itr = result.begin_map(); itr != result.end_map() && success; itr++)
+        success = m_writer.Key(itr->first) && m_writer.Value(itr->second);
+
+      m_list = 0;
+      m_item = 0;
+      m_listOpen = false;
+      m_state = StateItems;
+    }
+    break;
+
+  case StateItems:
+    {
+      Response &response = m_responses[m_response];
+      if (m_list >= response.deferred.size())
+      {
+        success = m_writer.EndObject() && m_writer.EndObject();
+        response.response = CVariant();
+        response.deferred.clear();
+        m_response++;
+        m_state = StateResponse;
+        break;
+      }
+
+      IDeferredResult *list = response.deferred[m_list].get();
+      if (!m_listOpen)
+      {
+        success = m_writer.Key(list->GetName()) && m_writer.BeginArray();
+        m_listOpen = true;
+      }
+
+      if (success && m_item < list->Size())
+      {
+        CVariant item;
+        list->GetItem(m_item++, item);
+        success = m_writer.Value(item);
+      }
+      else if (success)
+      {
+        success = m_writer.EndArray();
+        m_listOpen = false;
+        m_item = 0;
+        m_list++;
+      }
+    }
+    break;
+
+  case StateEnd:
+    if (m_batch)
+      success = m_writer.EndArray();
+    m_state = StateDone;
+    break;
+
+  case StateDone:
+  default:
+    return false;
+  }
+
+  if (!success)
+  {
+    CLog::Log(LOGERROR, "JSONRPC: Failed to generate the response");
+    m_state = StateDone;
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+#include "JSONRPC.h"
+#include "utils/JSONStreamWriter.h"
+#include "utils/Variant.h"
+
+// amount of response text generated in one go
+#define JSONRPC_RESPONSE_CHUNK (16 * 1024)
+
+namespace JSONRPC
+{
+  /*!
+   \ingroup jsonrpc
+   \brief Serializes the response to a request piece by piece
+
+   The responses of the executed calls are added in order, along with the
+   lists their handlers deferred, and the text is then generated on demand
+   by Read().  The elements of deferred lists are only created while they're
+   written, so the memory needed doesn't grow with the size of a result.
+   */
+  class CJSONResponseWriter
+  {
+  public:
+    /*!
+     \param batch whether the responses belong to a batch request and are written as an array
+     \param compact whether to write compact or human readable output
+     */
+    CJSONResponseWriter(bool batch, bool compact);
+
+    /*! \brief Add the response of a call, written after all responses added before */
+    void AddResponse(const CVariant &response, const DeferredResults &deferred);
+
+    /*! \brief Whether there is nothing to send back, e.g. as all calls were notifications */
+    bool IsEmpty() const { return m_responses.empty(); }
+
+    /*!
+     \brief Generate the next part of the response
+     \param output [out] string the generated text is appended to
+     \param size amount of text to generate at least, unless the response ends before
+     \return false if the whole response was generated already, true otherwise
+     */
+    bool Read(std::string &output, unsigned int size = JSONRPC_RESPONSE_CHUNK);
+
+    /*!
+     \brief Copy the next part of the response into a buffer
+     \return number of bytes copied, 0 once the whole response was read
+     */
+    unsigned int Read(char *buffer, unsigned int size);
+
+  private:
+    bool WriteNext();
+
+    enum State
+    {
+      StateBegin,
+      StateResponse,
+      StateItems,
+      StateEnd,
+      StateDone
+    };
+
+    struct Response
+    {
+      CVariant        response;
+      DeferredResults deferred;
+    };
+
+    std::vector<Response> m_responses;
+    bool                  m_batch;
+    CJSONStreamWriter     m_writer;
+    State                 m_state;
+    unsigned int          m_response; ///< response being written
+    unsigned int          m_list;     ///< deferred list of the response being written
+    unsigned int          m_item;     ///< next element of that list
+    bool                  m_listOpen;
+    std::string           m_buffer;   ///< text generated but not yet copied out by Read(char*, ...)
+    size_t                m_bufferPos;
+  };
+}
@@ -0,0 +1,227 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "system.h"
+
+#ifdef HAVE_INOTIFY
+#include "FileStateWatcher.h"
+#include "MediaSource.h"
+#include "settings/Settings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#include <sys/inotify.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+
+// quiet period after the last change of a source before it is queued for an update
+#define WATCHER_SETTLE_TIME 10000
+
+#define WATCHER_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_ONLYDIR)
+
+using namespace std;
+
+CFileStateWatcher::CFileStateWatcher() : CThread("CFileStateWatcher")
+{
+  m_fd = -1;
+}
+
+CFileStateWatcher::~CFileStateWatcher()
+{
+  Stop();
+}
+
+void CFileStateWatcher::Start()
+{
+  Stop();
+
+  m_videoSources.clear();
+  m_musicSources.clear();
+
+  for (unsigned int i = 0; i < g_settings.m_videoSources.size(); i++)
+  {
+    const CMediaSource &source = g_settings.m_videoSources[i];
+    for (unsigned int j = 0; j < source.vecPaths.size(); j++)
+      if (URIUtils::IsHD(source.vecPaths[j]) && source.vecPaths[j].Left(1) == "/")
+        m_videoSources.push_back(source.vecPaths[j]);
+  }
+  for (unsigned int i = 0; i < g_settings.m_musicSources.size(); i++)
+  {
+    const CMediaSource &source = g_settings.m_musicSources[i];
+    for (unsigned int j = 0; j < source.vecPaths.size(); j++)
+      if (URIUtils::IsHD(source.vecPaths[j]) && source.vecPaths[j].Left(1) == "/")
+        m_musicSources.push_back(source.vecPaths[j]);
+  }
+
+  if (m_videoSources.empty() && m_musicSources.empty())
+    return;
+
+  Create();
+}
+
+void CFileStateWatcher::Stop()
+{
+  StopThread();
+
+  CSingleLock lock(m_critSection);
+  m_pendingVideo.clear();
+  m_pendingMusic.clear();
+}
+
+bool CFileStateWatcher::GetNextChange(bool video, CStdString &path)
+{
+  CSingleLock lock(m_critSection);
+  map<CStdString, unsigned int> &pending = video ? m_pendingVideo : m_pendingMusic;
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  for (map<CStdString, unsigned int>::iterator it = pending.begin(); it != pending.end(); ++it)
+  {
+    if (now - it->second >= WATCHER_SETTLE_TIME)
+    {
+      path = it->first;
+      pending.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+void CFileStateWatcher::Process()
+{
+  m_fd = inotify_init();
+  if (m_fd < 0)
+  {
+    CLog::Log(LOGERROR, "%s - unable to initialize inotify (%s)", __FUNCTION__, strerror(errno));
+    return;
+  }
+
+  m_fileState.Open();
+
+  for (unsigned int i = 0; i < m_videoSources.size() && !m_bStop; i++)
+    AddWatch(m_videoSources[i], m_videoSources[i], true);
+  for (unsigned int i = 0; i < m_musicSources.size() && !m_bStop; i++)
+    AddWatch(m_musicSources[i], m_musicSources[i], false);
+
+  CLog::Log(LOGNOTICE, "%s - watching %u directories of local sources", __FUNCTION__, (unsigned int)m_watches.size());
+
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  while (!m_bStop)
+  {
+    struct pollfd fds = { m_fd, POLLIN, 0 };
+    if (poll(&fds, 1, 500) <= 0)
+      continue;
+
+    ssize_t len = read(m_fd, buffer, sizeof(buffer));
+    if (len <= 0)
+      continue;
+
+    for (char *ptr = buffer; ptr < buffer + len; )
+    {
+      const struct inotify_event *event = (const struct inotify_event *)ptr;
+      HandleEvent(event->wd, event->mask, event->len ? event->name : "");
+      ptr += sizeof(struct inotify_event) + event->len;
+    }
+  }
+
+  m_fileState.Close();
+  m_watches.clear();
+  close(m_fd);
+  m_fd = -1;
+}
+
+void CFileStateWatcher::AddWatch(const CStdString &path, const CStdString &source, bool video)
+{
+  int wd = inotify_add_watch(m_fd, path.c_str(), WATCHER_EVENTS);
+  if (wd < 0)
+  {
+    if (errno == ENOSPC)
+      CLog::Log(LOGWARNING, "%s - inotify watch limit reached at '%s', raise fs.inotify.max_user_watches", __FUNCTION__, path.c_str());
+    return;
+  }
+
+  WatchedDir &dir = m_watches[wd];
+  dir.path   = path;
+  dir.source = source;
+  dir.video  = video;
+
+  DIR *dirp = opendir(path.c_str());
+  if (!dirp)
+    return;
+
+  struct dirent *entry;
+  while ((entry = readdir(dirp)) != NULL && !m_bStop)
+  {
+    // hidden folders are skipped by the scanners as well
+    if (entry->d_name[0] == '.')
+      continue;
+
+    CStdString child;
+    URIUtils::AddFileToFolder(path, entry->d_name, child);
+    URIUtils::AddSlashAtEnd(child);
+    if (entry->d_type == DT_DIR)
+      AddWatch(child, source, video);
+    else if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK)
+    {
+      struct stat st;
+      if (stat(child.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+        AddWatch(child, source, video);
+    }
+  }
+  closedir(dirp);
+}
+
+void CFileStateWatcher::HandleEvent(int wd, unsigned int mask, const char *name)
+{
+  map<int, WatchedDir>::iterator it = m_watches.find(wd);
+  if (it == m_watches.end())
+    return;
+
+  WatchedDir dir = it->second;
+  if (mask & (IN_IGNORED | IN_MOVE_SELF))
+  { // the directory itself is gone
+    if (mask & IN_MOVE_SELF)
+      inotify_rm_watch(m_fd, wd);
+    m_watches.erase(it);
+    m_fileState.InvalidatePath(dir.path, true);
+  }
+  else
+  {
+    m_fileState.InvalidatePath(dir.path);
+
+    if ((mask & IN_ISDIR) && *name && name[0] != '.')
+    {
+      CStdString child;
+      URIUtils::AddFileToFolder(dir.path, name, child);
+      URIUtils::AddSlashAtEnd(child);
+      if (mask & (IN_CREATE | IN_MOVED_TO))
+        AddWatch(child, dir.source, dir.video);
+      else if (mask & (IN_DELETE | IN_MOVED_FROM))
+        m_fileState.InvalidatePath(child, true);
+    }
+  }
+
+  CSingleLock lock(m_critSection);
+  (dir.video ? m_pendingVideo : m_pendingMusic)[dir.source] = XbmcThreads::SystemClockMillis();
+}
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/Thread.h"
+#include "threads/CriticalSection.h"
+#include "utils/StdString.h"
+#include "FileStateDatabase.h"
+
+#include <map>
+#include <vector>
+
+/*! \brief Watches local library sources with inotify
+ Changes below a watched source invalidate the affected directory listings in
+ the file state index as they happen, and the source is queued for a library
+ update once no further changes have been seen for a while.
+ */
+class CFileStateWatcher : public CThread
+{
+public:
+  CFileStateWatcher();
+  virtual ~CFileStateWatcher();
+
+  /*! \brief (Re)start watching the local video and music sources of the current profile */
+  void Start();
+  void Stop();
+
+  /*! \brief Retrieve the next source that has settled after a change
+   \param video true to fetch a video source, false for a music source
+   \param path [out] the source path to update
+   \return true if a source was queued, false otherwise
+   */
+  bool GetNextChange(bool video, CStdString &path);
+
+protected:
+  virtual void Process();
+
+private:
+  struct WatchedDir
+  {
+    CStdString path;
+    CStdString source;
+    bool       video;
+  };
+
+  void AddWatch(const CStdString &path, const CStdString &source, bool video);
+  void HandleEvent(int wd, unsigned int mask, const char *name);
+
+  int                                 m_fd;
+  std::map<int, WatchedDir>           m_watches;
+  std::vector<CStdString>             m_videoSources;
+  std::vector<CStdString>             m_musicSources;
+  std::map<CStdString, unsigned int>  m_pendingVideo; ///< source -> time of last change
+  std::map<CStdString, unsigned int>  m_pendingMusic;
+  CFileStateDatabase                  m_fileState;
+  CCriticalSection                    m_critSection;
+};
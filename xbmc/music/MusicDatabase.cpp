@@ -3040,6 +3040,13 @@ bool CMusicDatabase::GetSongsByYear(const CStdString& baseDir, CFileItemList& it
   return GetSongsByWhere(baseDir, where, items);
 }
 
+bool CMusicDatabase::GetSongsPage(const CStdString& strBaseDir, CFileItemList& items, unsigned int start, unsigned int count, bool descending)
+{
+  CStdString order = PrepareSQL("order by strTitle %s limit %u,%u", descending ? "desc" : "asc", start, count);
+  // an empty page past the last song isn't an error
+  return GetSongsByWhere(strBaseDir, order, items) || start >= (unsigned int)GetSongsCount();
+}
+
 bool CMusicDatabase::GetSongsNav(const CStdString& strBaseDir, CFileItemList& items, int idGenre, int idArtist,int idAlbum)
 {
   CStdString strWhere;
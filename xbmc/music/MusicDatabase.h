@@ -163,6 +163,11 @@ public:
   bool GetSongsNav(const CStdString& strBaseDir, CFileItemList& items, int idGenre, int idArtist,int idAlbum);
   bool GetSongsByYear(const CStdString& baseDir, CFileItemList& items, int year);
   bool GetSongsByWhere(const CStdString &baseDir, const CStdString &whereClause, CFileItemList& items);
+  /*! \brief Retrieve a page of all songs ordered by title
+   \param start index of the first song to retrieve
+   \param count maximum number of songs to retrieve
+   */
+  bool GetSongsPage(const CStdString& strBaseDir, CFileItemList& items, unsigned int start, unsigned int count, bool descending = false);
   bool GetAlbumsByWhere(const CStdString &baseDir, const CStdString &where, const CStdString &order, CFileItemList &items);
   bool GetRandomSong(CFileItem* item, int& idSong, const CStdString& strWhere);
   int GetKaraokeSongsCount();
@@ -90,6 +90,9 @@ void CMusicInfoScanner::Process()
     {
       CLog::Log(LOGDEBUG, "%s - Starting scan", __FUNCTION__);
 
+      if (g_advancedSettings.m_bFileStateIndex)
+        m_fileState.Open();
+
       if (m_pObserver)
         m_pObserver->OnStateChanged(READING_MUSIC_INFO);
 
@@ -151,6 +154,7 @@ void CMusicInfoScanner::Process()
       g_directoryCache.ClearMusicThumbCache();
 
       m_musicDatabase.Close();
+      m_fileState.Close();
       CLog::Log(LOGDEBUG, "%s - Finished scan", __FUNCTION__);
 
       tick = XbmcThreads::SystemClockMillis() - tick;
@@ -353,7 +357,7 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
 
   // load subfolder
   CFileItemList items;
-  CDirectory::GetDirectory(strDirectory, items, g_settings.m_musicExtensions + "|.jpg|.tbn|.lrc|.cdg");
+  m_fileState.GetDirectory(strDirectory, items, g_settings.m_musicExtensions + "|.jpg|.tbn|.lrc|.cdg");
 
   // sort and get the path hash.  Note that we don't filter .cue sheet items here as we want
   // to detect changes in the .cue sheet as well.  The .cue sheet items only need filtering
@@ -730,10 +734,15 @@ void CMusicInfoScanner::UpdateFolderThumb(const VECSONGS &songs, const CStdStrin
 // This function is run by another thread
 void CMusicInfoScanner::Run()
 {
+  if (g_advancedSettings.m_bFileStateIndex)
+    m_countFileState.Open();
+
   int count = 0;
   while (!m_bStop && m_pathsToCount.size())
     count+=CountFilesRecursively(*m_pathsToCount.begin());
   m_itemCount = count;
+
+  m_countFileState.Close();
 }
 
 // Recurse through all folders we scan and count files
@@ -742,7 +751,7 @@ int CMusicInfoScanner::CountFilesRecursively(const CStdString& strPath)
   // load subfolder
   CFileItemList items;
 //  CLog::Log(LOGDEBUG, __FUNCTION__" - processing dir: %s", strPath.c_str());
-  CDirectory::GetDirectory(strPath, items, g_settings.m_musicExtensions, false);
+  m_countFileState.GetDirectory(strPath, items, g_settings.m_musicExtensions, false);
 
   if (m_bStop)
     return 0;
@@ -21,6 +21,7 @@
  */
 #include "threads/Thread.h"
 #include "music/MusicDatabase.h"
+#include "FileStateDatabase.h"
 #include "MusicAlbumInfo.h"
 
 class CAlbum;
@@ -82,6 +83,8 @@ protected:
   bool m_needsCleanup;
   int m_scanType; // 0 - load from files, 1 - albums, 2 - artists
   CMusicDatabase m_musicDatabase;
+  CFileStateDatabase m_fileState;
+  CFileStateDatabase m_countFileState; // used by the file counting thread
 
   std::set<CStdString> m_pathsToScan;
   std::set<CAlbum> m_albumsToScan;
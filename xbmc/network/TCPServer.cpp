@@ -2,14 +2,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <errno.h>
+#include <algorithm>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/ioctl.h>
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
+#include "interfaces/json-rpc/JSONResponseWriter.h"
 #include "interfaces/AnnouncementManager.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/JobManager.h"
 #include "threads/SingleLock.h"
 
 static const char     bt_service_name[] = "XBMC JSON-RPC";
@@ -34,6 +43,101 @@ using namespace ANNOUNCEMENT;
 //using namespace std; On VS2010, bind conflicts with std::bind
 
 #define RECEIVEBUFFER 1024
+// queued outgoing data per client above which announcements are dropped
+#define SENDBUFFERLIMIT (512 * 1024)
+// queued response data per client above which the rest of the response is generated once the client caught up
+#define SENDBUFFERLOW (64 * 1024)
+#define MAXEVENTS 64
+// reads per client and wake-up, so a client that keeps sending can't starve the others
+#define MAXREADS 16
+
+#ifdef HAVE_EPOLL
+static bool WatchSocket(int epoll, SOCKET socket, uint32_t events)
+{
+  struct epoll_event event = {};
+  event.events  = events;
+  event.data.fd = socket;
+  return epoll_ctl(epoll, EPOLL_CTL_ADD, socket, &event) == 0;
+}
+
+static bool RearmSocket(int epoll, SOCKET socket, uint32_t events)
+{
+  // modifying an edge triggered socket reports it again if it is still ready
+  struct epoll_event event = {};
+  event.events  = events;
+  event.data.fd = socket;
+  return epoll_ctl(epoll, EPOLL_CTL_MOD, socket, &event) == 0;
+}
+#endif
+
+static inline bool WouldBlock()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+/*! \brief Executes one call of a request on the job manager */
+class CTCPServer::CRequestJob : public CJob
+{
+public:
+  CRequestJob(CTCPServer *host, const CRequestPtr &request, unsigned int index)
+    : m_host(host), m_request(request), m_index(index), m_answered(false)
+  {
+    m_host->JobStarted();
+  }
+
+  virtual ~CRequestJob()
+  {
+    m_host->JobFinished();
+  }
+
+  virtual bool DoWork()
+  {
+    const CVariant &call = m_request->batch ? m_request->call[m_index] : m_request->call;
+    m_answered = CJSONRPC::HandleMethodCall(call, m_response, m_deferred, m_host, m_request->client.get());
+    return true;
+  }
+
+  virtual const char *GetType() const { return "jsonrpc"; }
+
+  CTCPServer     *m_host;
+  CRequestPtr     m_request;
+  unsigned int    m_index;
+  bool            m_answered;
+  CVariant        m_response;
+  DeferredResults m_deferred;
+};
+
+/*! \brief Continues streaming a response once the client has taken the queued part */
+class CTCPServer::CStreamJob : public CJob
+{
+public:
+  CStreamJob(CTCPServer *host, const CTCPClientPtr &client)
+    : m_host(host), m_client(client)
+  {
+    m_host->JobStarted();
+  }
+
+  virtual ~CStreamJob()
+  {
+    m_host->JobFinished();
+  }
+
+  virtual bool DoWork()
+  {
+    m_host->StreamResponse(m_client);
+    return true;
+  }
+
+  virtual const char *GetType() const { return "jsonrpcstream"; }
+
+private:
+  CTCPServer    *m_host;
+  CTCPClientPtr  m_client;
+};
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -69,84 +173,381 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("CTCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+  m_epoll = -1;
+  m_jobs = 0;
 }
 
 void CTCPServer::Process()
 {
   m_bStop = false;
 
+#ifdef HAVE_EPOLL
+  m_epoll = epoll_create(MAXEVENTS);
+  if (m_epoll < 0)
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to create epoll instance (%s), falling back to select", strerror(errno));
+  else
+  {
+    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+      WatchSocket(m_epoll, *it, EPOLLIN);
+  }
+#endif
+
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
+    std::vector<SOCKET> readable, writable;
+    if (!WaitForEvents(readable, writable))
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Waiting for socket events failed");
+      Sleep(1000);
+      Initialize();
+#ifdef HAVE_EPOLL
+      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end() && m_epoll >= 0; it++)
+        WatchSocket(m_epoll, *it, EPOLLIN);
+#endif
+      continue;
+    }
 
-    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+    for (unsigned int i = 0; i < writable.size(); i++)
     {
-      FD_SET(*it, &rfds);
-      if ((intptr_t)*it > (intptr_t)max_fd)
-        max_fd = *it;
+      CSingleLock lock (m_critSection);
+      ConnectionMap::iterator it = m_connections.find(writable[i]);
+      if (it == m_connections.end())
+        continue;
+      CTCPClientPtr client = it->second;
+      lock.Leave();
+
+      ResumeStream(client);
     }
 
-    for (unsigned int i = 0; i < m_connections.size(); i++)
+    for (unsigned int i = 0; i < readable.size(); i++)
     {
-      FD_SET(m_connections[i].m_socket, &rfds);
-      if ((intptr_t)m_connections[i].m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i].m_socket;
+      if (std::find(m_servers.begin(), m_servers.end(), readable[i]) != m_servers.end())
+      {
+        Accept(readable[i]);
+        continue;
+      }
+
+      CSingleLock lock (m_critSection);
+      ConnectionMap::iterator it = m_connections.find(readable[i]);
+      if (it == m_connections.end())
+        continue;
+      CTCPClientPtr client = it->second;
+      lock.Leave();
+
+      Receive(client);
     }
+  }
+
+  Deinitialize();
+
+#ifdef HAVE_EPOLL
+  if (m_epoll >= 0)
+    close(m_epoll);
+  m_epoll = -1;
+#endif
+}
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+bool CTCPServer::WaitForEvents(std::vector<SOCKET> &readable, std::vector<SOCKET> &writable)
+{
+#ifdef HAVE_EPOLL
+  if (m_epoll >= 0)
+  {
+    // clients are registered edge triggered, so a response a worker couldn't
+    // send completely is picked up as soon as the socket drains
+    struct epoll_event events[MAXEVENTS];
+    int res = epoll_wait(m_epoll, events, MAXEVENTS, 1000);
     if (res < 0)
+      return errno == EINTR;
+
+    for (int i = 0; i < res; i++)
     {
-      CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
-      Sleep(1000);
-      Initialize();
+      if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        readable.push_back(events[i].data.fd);
+      if (events[i].events & EPOLLOUT)
+        writable.push_back(events[i].data.fd);
     }
-    else if (res > 0)
+    return true;
+  }
+#endif
+
+  SOCKET          max_fd = 0;
+  fd_set          rfds, wfds;
+  struct timeval  to     = {1, 0};
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+  {
+    FD_SET(*it, &rfds);
+    if ((intptr_t)*it > (intptr_t)max_fd)
+      max_fd = *it;
+  }
+
+  CSingleLock lock (m_critSection);
+  for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end(); it++)
+  {
+    FD_SET(it->first, &rfds);
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
-      {
-        int socket = m_connections[i].m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          if (nread > 0)
-          {
-            m_connections[i].PushBuffer(this, buffer, nread);
-          }
-          if (nread <= 0)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i].Disconnect();
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
-      }
+      CSingleLock clientLock (it->second->m_critSection);
+      if (it->second->HasPendingData())
+        FD_SET(it->first, &wfds);
+    }
+    if ((intptr_t)it->first > (intptr_t)max_fd)
+      max_fd = it->first;
+  }
+  lock.Leave();
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
-      {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient newconnection;
-          newconnection.m_socket = accept(*it, (sockaddr*)&newconnection.m_cliaddr, &newconnection.m_addrlen);
-
-          if (newconnection.m_socket == INVALID_SOCKET)
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed");
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
-        }
-      }
+  // responses are written by the workers, so don't sleep long while any are busy
+  {
+    CSingleLock jobLock (m_jobSection);
+    if (m_jobs > 0)
+      to.tv_sec = 0, to.tv_usec = 50000;
+  }
+
+  int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
+  if (res < 0)
+    return false;
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end() && res > 0; it++)
+  {
+    if (FD_ISSET(*it, &rfds))
+      readable.push_back(*it);
+  }
+
+  lock.Enter();
+  for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end() && res > 0; it++)
+  {
+    if (FD_ISSET(it->first, &rfds))
+      readable.push_back(it->first);
+    if (FD_ISSET(it->first, &wfds))
+      writable.push_back(it->first);
+  }
+  return true;
+}
+
+void CTCPServer::Accept(SOCKET server)
+{
+  CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+  CTCPClientPtr newconnection(new CTCPClient());
+  newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+  if (newconnection->m_socket == INVALID_SOCKET)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed");
+    return;
+  }
+
+  CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+
+  // a client that doesn't read must never block the server or the announcements
+  unsigned long nonblocking = 1;
+  ioctlsocket(newconnection->m_socket, FIONBIO, &nonblocking);
+
+  CSingleLock lock (m_critSection);
+  m_connections[newconnection->m_socket] = newconnection;
+  lock.Leave();
+
+#ifdef HAVE_EPOLL
+  if (m_epoll >= 0 && !WatchSocket(m_epoll, newconnection->m_socket, EPOLLIN | EPOLLOUT | EPOLLET))
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch new connection (%s)", strerror(errno));
+    RemoveClient(newconnection->m_socket);
+  }
+#endif
+}
+
+void CTCPServer::Receive(const CTCPClientPtr &client)
+{
+  // read until the socket is drained or the client had its share of this wake-up
+  char buffer[RECEIVEBUFFER];
+  int  nread = 0;
+  int  reads = 0;
+  bool queued = false;
+  do
+  {
+    nread = recv(client->m_socket, buffer, RECEIVEBUFFER, 0);
+    if (nread > 0)
+      queued |= client->PushBuffer(buffer, nread);
+  } while (nread > 0 && ++reads < MAXREADS && !m_bStop);
+
+  if (queued)
+    Dispatch(client);
+
+  if (nread == 0 || (nread < 0 && !WouldBlock()))
+  {
+    CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+    RemoveClient(client->m_socket);
+  }
+#ifdef HAVE_EPOLL
+  else if (nread > 0 && m_epoll >= 0)
+  {
+    // edge triggered events don't repeat for the data left behind, so re-arm
+    if (!RearmSocket(m_epoll, client->m_socket, EPOLLIN | EPOLLOUT | EPOLLET))
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Failed to re-arm connection (%s)", strerror(errno));
+      RemoveClient(client->m_socket);
     }
   }
+#endif
+}
 
-  Deinitialize();
+void CTCPServer::RemoveClient(SOCKET socket)
+{
+  CSingleLock lock (m_critSection);
+  ConnectionMap::iterator it = m_connections.find(socket);
+  if (it == m_connections.end())
+    return;
+
+  // requests still running hold on to the client, their responses go nowhere
+  CTCPClientPtr client = it->second;
+  m_connections.erase(it);
+  lock.Leave();
+
+  client->Disconnect();
+}
+
+void CTCPServer::Dispatch(const CTCPClientPtr &client)
+{
+  CSingleLock lock (client->m_critSection);
+  while (!client->m_busy && !client->m_requests.empty() && client->m_socket != INVALID_SOCKET && !m_bStop)
+  {
+    CRequestPtr request = client->m_requests.front();
+    client->m_requests.pop_front();
+
+    if (request->pending == 0)
+    { // nothing to execute, the request couldn't be parsed
+      client->Send(request->output, false);
+      continue;
+    }
+
+    client->m_busy = true;
+    request->client = client;
+    for (unsigned int i = 0; i < request->pending; i++)
+      CJobManager::GetInstance().AddJob(new CRequestJob(this, request, i), this, CJob::PRIORITY_HIGH);
+  }
+}
+
+void CTCPServer::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CRequestJob *requestJob = (CRequestJob *)job;
+  CRequestPtr request = requestJob->m_request;
+
+  CSingleLock lock (request->critSection);
+  if (success)
+  {
+    request->responses[requestJob->m_index] = requestJob->m_response;
+    request->deferred[requestJob->m_index] = requestJob->m_deferred;
+    request->answered[requestJob->m_index] = requestJob->m_answered;
+  }
+  else
+  { // a cancelled or failed call isn't answered
+    CLog::Log(LOGERROR, "JSONRPC Server: Call %u of a request failed", requestJob->m_index);
+    request->answered[requestJob->m_index] = false;
+  }
+  if (--request->pending > 0)
+    return;
+  lock.Leave();
+
+  FinishRequest(request);
+}
+
+void CTCPServer::FinishRequest(const CRequestPtr &request)
+{
+  if (std::find(request->answered.begin(), request->answered.end(), true) == request->answered.end())
+  { // nothing to send, e.g. all calls failed or were notifications
+    CTCPClientPtr client = request->client;
+    request->client.reset();
+    request->responses.clear();
+    request->deferred.clear();
+
+    CSingleLock lock (client->m_critSection);
+    client->m_busy = false;
+    lock.Leave();
+
+    Dispatch(client);
+    return;
+  }
+
+  CJSONResponseWriter *writer = new CJSONResponseWriter(request->batch, g_advancedSettings.m_jsonOutputCompact);
+  for (unsigned int i = 0; i < request->responses.size(); i++)
+  {
+    if (request->answered[i])
+      writer->AddResponse(request->responses[i], request->deferred[i]);
+  }
+
+  CTCPClientPtr client = request->client;
+  request->client.reset();
+  request->responses.clear();
+  request->deferred.clear();
+
+  CSingleLock lock (client->m_critSection);
+  client->SetStream(writer);
+  lock.Leave();
+
+  StreamResponse(client);
+}
+
+void CTCPServer::StreamResponse(const CTCPClientPtr &client)
+{
+  CSingleLock lock (client->m_critSection);
+  CJSONResponseWriter *writer = client->GetStream();
+  lock.Leave();
+
+  // the response is generated outside of the lock so announcements aren't held up
+  std::string chunk;
+  bool more = writer && !writer->IsEmpty();
+  while (more)
+  {
+    chunk.clear();
+    more = writer->Read(chunk);
+
+    lock.Enter();
+    if (client->m_socket == INVALID_SOCKET || m_bStop)
+    {
+      more = false;
+      lock.Leave();
+      break;
+    }
+    client->Send(chunk, false);
+    if (more && client->GetPendingSize() >= SENDBUFFERLOW)
+    { // continued by ResumeStream() once the client caught up
+      client->m_streamWaiting = true;
+      return;
+    }
+    lock.Leave();
+  }
+
+  lock.Enter();
+  client->SetStream(NULL);
+  client->m_busy = false;
+  lock.Leave();
+
+  Dispatch(client);
+}
+
+void CTCPServer::ResumeStream(const CTCPClientPtr &client)
+{
+  CSingleLock lock (client->m_critSection);
+  client->Flush();
+  if (client->m_streamWaiting && client->GetPendingSize() < SENDBUFFERLOW && !m_bStop)
+  {
+    client->m_streamWaiting = false;
+    CJobManager::GetInstance().AddJob(new CStreamJob(this, client), NULL, CJob::PRIORITY_HIGH);
+  }
+}
+
+void CTCPServer::JobStarted()
+{
+  CSingleLock lock (m_jobSection);
+  m_jobs++;
+  m_jobsDone.Reset();
+}
+
+void CTCPServer::JobFinished()
+{
+  CSingleLock lock (m_jobSection);
+  if (--m_jobs == 0)
+    m_jobsDone.Set();
 }
 
 bool CTCPServer::Download(const char *path, CVariant &result)
@@ -163,20 +564,14 @@ void CTCPServer::Announce(EAnnouncementFlag flag, const char *sender, const char
 {
   std::string str = AnnouncementToJSON(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
 
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  CSingleLock serverLock (m_critSection);
+  for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end(); it++)
   {
-    {
-      CSingleLock lock (m_connections[i].m_critSection);
-      if ((m_connections[i].GetAnnouncementFlags() & flag) == 0)
-        continue;
-    }
+    CSingleLock lock (it->second->m_critSection);
+    if ((it->second->GetAnnouncementFlags() & flag) == 0)
+      continue;
 
-    unsigned int sent = 0;
-    do
-    {
-      CSingleLock lock (m_connections[i].m_critSection);
-      sent += send(m_connections[i].m_socket, str.c_str(), str.size() - sent, sent);
-    } while (sent < str.size());
+    it->second->Send(str, true);
   }
 }
 
@@ -418,12 +813,25 @@ bool CTCPServer::InitializeTCP()
   return true;
 }
 
+
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
-    m_connections[i].Disconnect();
+  CSingleLock lock (m_critSection);
+  for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end(); it++)
+    it->second->Disconnect();
 
   m_connections.clear();
+  lock.Leave();
+
+  // running calls refer to the server as their transport
+  CSingleLock jobLock (m_jobSection);
+  while (m_jobs > 0)
+  {
+    jobLock.Leave();
+    m_jobsDone.WaitMSec(100);
+    jobLock.Enter();
+  }
+  jobLock.Leave();
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
@@ -439,27 +847,31 @@ void CTCPServer::Deinitialize()
   CAnnouncementManager::RemoveAnnouncer(this);
 }
 
+CTCPServer::CRequest::CRequest()
+{
+  batch = false;
+  pending = 0;
+}
+
 CTCPServer::CTCPClient::CTCPClient()
 {
   m_announcementflags = ANNOUNCE_ALL;
   m_socket = INVALID_SOCKET;
+  m_busy = false;
+  m_streamWaiting = false;
+  m_stream = NULL;
   m_beginBrackets = 0;
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_dropped = 0;
 
   m_addrlen = sizeof(m_cliaddr);
 }
 
-CTCPServer::CTCPClient::CTCPClient(const CTCPClient& client)
-{
-  Copy(client);
-}
-
-CTCPServer::CTCPClient& CTCPServer::CTCPClient::operator=(const CTCPClient& client)
+CTCPServer::CTCPClient::~CTCPClient()
 {
-  Copy(client);
-  return *this;
+  delete m_stream;
 }
 
 int CTCPServer::CTCPClient::GetPermissionFlags()
@@ -478,8 +890,9 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
   return true;
 }
 
-void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
+bool CTCPServer::CTCPClient::PushBuffer(const char *buffer, int length)
 {
+  bool queued = false;
   for (int i = 0; i < length; i++)
   {
     char c = buffer[i];
@@ -504,37 +917,96 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
         m_endBrackets++;
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
+        CRequestPtr request(new CRequest());
+        CVariant error;
+        if (CJSONRPC::ParseCall(m_buffer, request->call, error))
+        {
+          request->batch   = request->call.isArray();
+          request->pending = request->batch ? request->call.size() : 1;
+          request->responses.resize(request->pending);
+          request->deferred.resize(request->pending);
+          request->answered.resize(request->pending, false);
+        }
+        else
+          request->output = CJSONVariantWriter::Write(error, g_advancedSettings.m_jsonOutputCompact);
+
         CSingleLock lock (m_critSection);
-        send(m_socket, line.c_str(), line.size(), 0);
+        m_requests.push_back(request);
+        queued = true;
+
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
     }
   }
+  return queued;
+}
+
+bool CTCPServer::CTCPClient::Send(const std::string &data, bool mayDrop)
+{
+  if (mayDrop && m_stream)
+  { // don't interleave with the response being streamed
+    if (m_heldBuffer.size() >= SENDBUFFERLIMIT)
+    {
+      if (m_dropped++ == 0)
+        CLog::Log(LOGWARNING, "JSONRPC Server: Client is not reading, dropping announcements");
+      return false;
+    }
+    m_heldBuffer.append(data);
+    return true;
+  }
+
+  if (mayDrop && m_sendBuffer.size() >= SENDBUFFERLIMIT)
+  {
+    if (m_dropped++ == 0)
+      CLog::Log(LOGWARNING, "JSONRPC Server: Client is not reading, dropping announcements");
+    return false;
+  }
+
+  m_sendBuffer.append(data);
+  Flush();
+  return true;
+}
+
+void CTCPServer::CTCPClient::SetStream(CJSONResponseWriter *stream)
+{
+  delete m_stream;
+  m_stream = stream;
+  m_streamWaiting = false;
+
+  if (!m_stream && !m_heldBuffer.empty())
+  {
+    m_sendBuffer.append(m_heldBuffer);
+    m_heldBuffer.clear();
+    Flush();
+  }
+}
+
+void CTCPServer::CTCPClient::Flush()
+{
+  while (!m_sendBuffer.empty() && m_socket != INVALID_SOCKET)
+  {
+    int sent = send(m_socket, m_sendBuffer.c_str(), m_sendBuffer.size(), 0);
+    if (sent <= 0)
+      break; // the socket is full, the server thread continues once it's writable
+
+    m_sendBuffer.erase(0, sent);
+  }
 }
 
 void CTCPServer::CTCPClient::Disconnect()
 {
+  if (m_dropped > 0)
+    CLog::Log(LOGINFO, "JSONRPC Server: %u announcements were dropped for a client that wasn't reading", m_dropped);
+
+  CSingleLock lock (m_critSection);
+  m_requests.clear();
+  m_sendBuffer.clear();
+  m_heldBuffer.clear();
   if (m_socket > 0)
   {
-    CSingleLock lock (m_critSection);
     shutdown(m_socket, SHUT_RDWR);
     closesocket(m_socket);
     m_socket = INVALID_SOCKET;
   }
 }
-
-void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
-{
-  m_socket            = client.m_socket;
-  m_cliaddr           = client.m_cliaddr;
-  m_addrlen           = client.m_addrlen;
-  m_announcementflags = client.m_announcementflags;
-  m_beginBrackets     = client.m_beginBrackets;
-  m_endBrackets       = client.m_endBrackets;
-  m_beginChar         = client.m_beginChar;
-  m_endChar           = client.m_endChar;
-  m_buffer            = client.m_buffer;
-}
-
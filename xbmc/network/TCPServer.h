@@ -1,15 +1,32 @@
 #pragma once
 #include <vector>
+#include <map>
+#include <deque>
 #include <sys/socket.h>
+#include <boost/shared_ptr.hpp>
 #include "interfaces/IAnnouncer.h"
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/Thread.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "interfaces/json-rpc/JSONUtils.h"
+#include "interfaces/json-rpc/JSONRPC.h"
+#include "utils/Job.h"
+#include "utils/Variant.h"
 
 namespace JSONRPC
 {
-  class CTCPServer : public ITransportLayer, public ANNOUNCEMENT::IAnnouncer, public CThread, protected CJSONUtils
+  /*! \brief JSON-RPC server for raw TCP (and bluetooth) connections
+   Socket I/O and the framing of requests happen on the server thread, which
+   waits on all sockets with epoll where available and select otherwise.  The
+   calls themselves are executed on the job manager's workers, so a slow call
+   doesn't hold up other clients.  The requests of a client are answered one
+   after another in the order they were received, while the calls of a batch
+   request are executed concurrently.  Responses are generated in chunks
+   whenever the client has taken the previous ones, so large results are
+   never held in memory as a whole.
+   */
+  class CTCPServer : public ITransportLayer, public ANNOUNCEMENT::IAnnouncer, public CThread, public IJobCallback, protected CJSONUtils
   {
   public:
     static bool StartServer(int port, bool nonlocal);
@@ -19,6 +36,8 @@ namespace JSONRPC
     virtual int GetCapabilities();
 
     virtual void Announce(ANNOUNCEMENT::EAnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
   protected:
     void Process();
   private:
@@ -28,38 +47,110 @@ namespace JSONRPC
     bool InitializeTCP();
     void Deinitialize();
 
+    class CTCPClient;
+    class CRequestJob;
+    class CStreamJob;
+    typedef boost::shared_ptr<CTCPClient> CTCPClientPtr;
+
+    /*! \brief A complete request of a client, either a single call or a batch */
+    class CRequest
+    {
+    public:
+      CRequest();
+
+      CTCPClientPtr         client;
+      CVariant              call;      ///< the parsed call, or the array of calls of a batch
+      bool                  batch;
+      std::vector<CVariant> responses; ///< responses of the calls, in the order of the calls
+      std::vector<DeferredResults> deferred; ///< lists deferred by the call at the same index
+      std::vector<bool>     answered;  ///< whether the call at the same index has a response
+      unsigned int          pending;   ///< calls still to be executed
+      std::string           output;    ///< the error response if the request couldn't be parsed
+      CCriticalSection      critSection;
+    };
+    typedef boost::shared_ptr<CRequest> CRequestPtr;
+
     class CTCPClient : public IClient
     {
     public:
       CTCPClient();
-      //Copying a CCriticalSection is not allowed, so copy everything but that
-      //when adding a member variable, make sure to copy it in CTCPClient::Copy
-      CTCPClient(const CTCPClient& client);
-      CTCPClient& operator=(const CTCPClient& client);
+      virtual ~CTCPClient();
       virtual int  GetPermissionFlags();
       virtual int  GetAnnouncementFlags();
       virtual bool SetAnnouncementFlags(int flags);
-      void PushBuffer(CTCPServer *host, const char *buffer, int length);
+
+      /*! \brief Split received data into requests and queue them for execution
+       \return true if a complete request was queued, false otherwise
+       */
+      bool PushBuffer(const char *buffer, int length);
       void Disconnect();
 
+      /*! \brief Queue data for the client and send as much of it as the socket takes
+       Data that may be dropped (announcements) is held back while a response is
+       being streamed and queued once the response is complete.
+       \param data the data to send
+       \param mayDrop whether the data is dropped instead if the client is too far behind
+       \return false if the data was dropped, true otherwise
+       */
+      bool Send(const std::string &data, bool mayDrop);
+      void Flush();
+      bool HasPendingData() const { return !m_sendBuffer.empty(); }
+      size_t GetPendingSize() const { return m_sendBuffer.size(); }
+
+      /*! \brief Start or finish streaming a response, see Send() */
+      void SetStream(CJSONResponseWriter *stream);
+      CJSONResponseWriter *GetStream() const { return m_stream; }
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
       CCriticalSection m_critSection;
 
+      std::deque<CRequestPtr> m_requests; ///< received requests waiting for the previous one to finish
+      bool                    m_busy;     ///< whether a request of the client is being executed
+      bool                    m_streamWaiting; ///< whether the response waits for the client to take queued data
+
     private:
-      void Copy(const CTCPClient& client);
+      CTCPClient(const CTCPClient& client);
+      CTCPClient& operator=(const CTCPClient& client);
+
       int m_announcementflags;
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_sendBuffer;
+      std::string m_heldBuffer;
+      CJSONResponseWriter *m_stream;
+      unsigned int m_dropped;
     };
 
-    std::vector<CTCPClient> m_connections;
+    bool WaitForEvents(std::vector<SOCKET> &readable, std::vector<SOCKET> &writable);
+    void Accept(SOCKET server);
+    void Receive(const CTCPClientPtr &client);
+    void RemoveClient(SOCKET socket);
+
+    /*! \brief Start executing the next queued request of a client unless one is already running */
+    void Dispatch(const CTCPClientPtr &client);
+    void FinishRequest(const CRequestPtr &request);
+    /*! \brief Generate and queue the response being streamed to a client until it has enough data queued */
+    void StreamResponse(const CTCPClientPtr &client);
+    void ResumeStream(const CTCPClientPtr &client);
+
+    void JobStarted();
+    void JobFinished();
+
+    typedef std::map<SOCKET, CTCPClientPtr> ConnectionMap;
+    ConnectionMap m_connections;
+    CCriticalSection m_critSection; ///< guards m_connections against announcements
     std::vector<SOCKET> m_servers;
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
+    int m_epoll;
+
+    unsigned int m_jobs;            ///< calls queued to or running on the job manager
+    CCriticalSection m_jobSection;
+    CEvent m_jobsDone;
 
     static CTCPServer *ServerInstance;
   };
@@ -69,6 +69,10 @@ NPT_SET_LOCAL_LOGGER("xbmc.upnp")
 #define UPNP_DEFAULT_MAX_RETURNED_ITEMS 200
 #define UPNP_DEFAULT_MIN_RETURNED_ITEMS 30
 
+// containers are kept around this long for clients paging through them
+#define UPNP_CONTAINER_CACHE_TIME  30000
+#define UPNP_CONTAINER_CACHE_SIZE  16
+
 /*
 # Play speed
 #    1 normal
@@ -305,6 +309,40 @@ private:
                                    const NPT_List<NPT_String>&   sort_criteria,
                                    const PLT_HttpRequestContext& context,
                                    const char*                   parent_id /* = NULL */);
+    NPT_Result       BuildPage(PLT_ActionReference&          action,
+                               CFileItemList&                items,
+                               NPT_UInt32                    first,
+                               NPT_UInt32                    last,
+                               NPT_UInt32                    total_matches,
+                               const char*                   filter,
+                               const PLT_HttpRequestContext& context,
+                               const char*                   parent_id);
+
+    // containers of the library that are paged by the database instead of being listed as a whole
+    bool             GetLibraryPage(const CStdString& path,
+                                    NPT_UInt32        starting_index,
+                                    NPT_UInt32        count,
+                                    bool              descending,
+                                    CFileItemList&    page,
+                                    NPT_UInt32&       total_matches);
+
+    struct CachedContainer
+    {
+        boost::shared_ptr<CFileItemList> items; // sorted children of a container listed through the vfs
+        int                              total; // number of children of a paged library container
+        unsigned int                     time;
+    };
+    bool             GetCachedContainer(const CStdString& key, CachedContainer& container);
+    void             SetCachedContainer(const CStdString& key, const CachedContainer& container);
+
+    static NPT_UInt32 GetMaxCount(NPT_UInt32 requested_count) {
+        // 0 requested means as many as possible
+        return (requested_count == 0)?m_MaxReturnedItems:min((unsigned long)requested_count, (unsigned long)m_MaxReturnedItems);
+    }
+    static bool IsSortedDescending(const NPT_List<NPT_String>& sort_criteria) {
+        // only the direction of the first criterion is honoured, everything is sorted by title
+        return sort_criteria.GetItemCount() > 0 && sort_criteria.GetFirstItem()->StartsWith("-");
+    }
 
     // class methods
     static NPT_String GetParentFolder(NPT_String file_path) {
@@ -320,6 +358,9 @@ private:
     NPT_Mutex                       m_FileMutex;
     NPT_Map<NPT_String, NPT_String> m_FileMap;
 
+    NPT_Mutex                           m_CacheMutex;
+    std::map<CStdString, CachedContainer> m_ContainerCache;
+
 public:
     // class members
     static NPT_UInt32 m_MaxReturnedItems;
@@ -1061,56 +1102,198 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
                                     const NPT_List<NPT_String>&   sort_criteria,
                                     const PLT_HttpRequestContext& context)
 {
-    CFileItemList items;
     NPT_String    parent_id = TranslateWMPObjectId(object_id);
+    bool          descending = IsSortedDescending(sort_criteria);
+    CStdString    key;
 
     CLog::Log(LOGINFO, "Received UPnP Browse DirectChildren request for object '%s'", (const char*)object_id);
 
-    items.SetPath(CStdString(parent_id));
-    if (!items.Load()) {
-        // cache anything that takes more than a second to retrieve
-      unsigned int time = XbmcThreads::SystemClockMillis();
+    // Don't pass parent_id if action is Search not BrowseDirectChildren, as
+    // we want the engine to determine the best parent id, not necessarily the one
+    // passed
+    NPT_String action_name = action->GetActionDesc().GetName();
+    const char* response_parent_id = (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars();
+
+    // large library containers are paged by the database
+    CFileItemList page;
+    NPT_UInt32    total_matches;
+    if (GetLibraryPage((const char*)parent_id, starting_index, GetMaxCount(requested_count), descending, page, total_matches)) {
+        return BuildPage(action, page, 0, page.Size(), total_matches, filter, context, response_parent_id);
+    }
 
-        if (parent_id.StartsWith("virtualpath://upnproot")) {
-            CFileItemPtr item;
+    // everything else is listed as a whole, and kept for clients paging through it
+    key.Format("%s|%s", (const char*)parent_id, descending ? "desc" : "asc");
+    CachedContainer container;
+    if (!GetCachedContainer(key, container) || !container.items) {
+        container.items.reset(new CFileItemList);
+        container.total = -1;
 
-            // music library
-            item.reset(new CFileItem("musicdb://", true));
-            item->SetLabel("Music Library");
-            item->SetLabelPreformated(true);
-            items.Add(item);
+        CFileItemList& items = *container.items;
+        items.SetPath(CStdString(parent_id));
+        if (!items.Load()) {
+            // cache anything that takes more than a second to retrieve
+            unsigned int time = XbmcThreads::SystemClockMillis();
 
-            // video library
-            item.reset(new CFileItem("videodb://", true));
-            item->SetLabel("Video Library");
-            item->SetLabelPreformated(true);
-            items.Add(item);
+            if (parent_id.StartsWith("virtualpath://upnproot")) {
+                CFileItemPtr item;
 
-        } else {
-            CDirectory::GetDirectory((const char*)parent_id, items);
+                // music library
+                item.reset(new CFileItem("musicdb://", true));
+                item->SetLabel("Music Library");
+                item->SetLabelPreformated(true);
+                items.Add(item);
+
+                // video library
+                item.reset(new CFileItem("videodb://", true));
+                item->SetLabel("Video Library");
+                item->SetLabelPreformated(true);
+                items.Add(item);
+
+            } else {
+                CDirectory::GetDirectory((const char*)parent_id, items);
+            }
+
+            if (items.CacheToDiscAlways() || (items.CacheToDiscIfSlow() && (XbmcThreads::SystemClockMillis() - time) > 1000 )) {
+                items.Save();
+            }
         }
 
-        if (items.CacheToDiscAlways() || (items.CacheToDiscIfSlow() && (XbmcThreads::SystemClockMillis() - time) > 1000 )) {
-            items.Save();
+        // Always sort by label
+        items.Sort(SORT_METHOD_LABEL, descending ? SORT_ORDER_DESC : SORT_ORDER_ASC);
+        SetCachedContainer(key, container);
+    }
+
+    // building the response modifies the items, so it works on copies of the requested ones
+    const CFileItemList& items = *container.items;
+    NPT_UInt32 stop_index = min((unsigned long)(starting_index + GetMaxCount(requested_count)), (unsigned long)items.Size());
+    for (NPT_UInt32 i = starting_index; i < stop_index; ++i)
+        page.Add(CFileItemPtr(new CFileItem(*items[i])));
+
+    return BuildPage(action, page, 0, page.Size(), items.Size(), filter, context, response_parent_id);
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetLibraryPage
++---------------------------------------------------------------------*/
+bool
+CUPnPServer::GetLibraryPage(const CStdString& path,
+                            NPT_UInt32        starting_index,
+                            NPT_UInt32        count,
+                            bool              descending,
+                            CFileItemList&    page,
+                            NPT_UInt32&       total_matches)
+{
+    // the database can't apply locks before limiting the results
+    if (g_settings.GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE)
+        return false;
+
+    enum { NONE, SONGS, MOVIES, MUSICVIDEOS } type = NONE;
+    if (path.Left(10).Equals("musicdb://")) {
+        if (CMusicDatabaseDirectory::GetDirectoryType(path) == MUSICDATABASEDIRECTORY::NODE_TYPE_SONG &&
+            CMusicDatabaseDirectory::GetDirectoryParentType(path) == MUSICDATABASEDIRECTORY::NODE_TYPE_OVERVIEW)
+            type = SONGS;
+    } else if (path.Left(10).Equals("videodb://")) {
+        VIDEODATABASEDIRECTORY::NODE_TYPE node = CVideoDatabaseDirectory::GetDirectoryType(path);
+        VIDEODATABASEDIRECTORY::NODE_TYPE parent = CVideoDatabaseDirectory::GetDirectoryParentType(path);
+        if (node == VIDEODATABASEDIRECTORY::NODE_TYPE_TITLE_MOVIES && parent == VIDEODATABASEDIRECTORY::NODE_TYPE_MOVIES_OVERVIEW &&
+            g_guiSettings.GetBool("videolibrary.flattenmoviesets"))
+            type = MOVIES;
+        else if (node == VIDEODATABASEDIRECTORY::NODE_TYPE_TITLE_MUSICVIDEOS && parent == VIDEODATABASEDIRECTORY::NODE_TYPE_MUSICVIDEOS_OVERVIEW)
+            type = MUSICVIDEOS;
+    }
+    if (type == NONE)
+        return false;
+
+    // the number of children is kept for the following pages
+    CachedContainer container;
+    bool have_total = GetCachedContainer(path, container) && container.total >= 0;
+
+    bool success = false;
+    if (type == SONGS) {
+        CMusicDatabase db;
+        if (!db.Open())
+            return false;
+        success = db.GetSongsPage(path, page, starting_index, count, descending);
+        if (success && !have_total)
+            container.total = db.GetSongsCount();
+    } else {
+        CVideoDatabase db;
+        if (!db.Open())
+            return false;
+        if (type == MOVIES) {
+            success = db.GetMoviesPage(path, page, starting_index, count, descending);
+            if (success && !have_total)
+                container.total = db.GetMovieCount();
+        } else {
+            success = db.GetMusicVideosPage(path, page, starting_index, count, descending);
+            if (success && !have_total)
+                container.total = db.GetMusicVideoCount("");
         }
     }
 
-    // Always sort by label
-    items.Sort(SORT_METHOD_LABEL, SORT_ORDER_ASC);
+    if (!success) {
+        page.Clear();
+        return false;
+    }
 
-    // Don't pass parent_id if action is Search not BrowseDirectChildren, as
-    // we want the engine to determine the best parent id, not necessarily the one
-    // passed
-    NPT_String action_name = action->GetActionDesc().GetName();
-    return BuildResponse(
-        action,
-        items,
-        filter,
-        starting_index,
-        requested_count,
-        sort_criteria,
-        context,
-        (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars());
+    if (!have_total) {
+        container.items.reset();
+        SetCachedContainer(path, container);
+    }
+
+    total_matches = container.total;
+    CLog::Log(LOGDEBUG, "UPnP paged %d of %d items of '%s' from the database", page.Size(), container.total, path.c_str());
+    return true;
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetCachedContainer
++---------------------------------------------------------------------*/
+bool
+CUPnPServer::GetCachedContainer(const CStdString& key, CachedContainer& container)
+{
+    NPT_AutoLock lock(m_CacheMutex);
+
+    std::map<CStdString, CachedContainer>::iterator it = m_ContainerCache.find(key);
+    if (it == m_ContainerCache.end())
+        return false;
+
+    if (XbmcThreads::SystemClockMillis() - it->second.time > UPNP_CONTAINER_CACHE_TIME) {
+        m_ContainerCache.erase(it);
+        return false;
+    }
+
+    container = it->second;
+    return true;
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::SetCachedContainer
++---------------------------------------------------------------------*/
+void
+CUPnPServer::SetCachedContainer(const CStdString& key, const CachedContainer& container)
+{
+    NPT_AutoLock lock(m_CacheMutex);
+
+    unsigned int now = XbmcThreads::SystemClockMillis();
+
+    // drop expired containers, and the oldest one if the cache is still full
+    std::map<CStdString, CachedContainer>::iterator oldest = m_ContainerCache.end();
+    for (std::map<CStdString, CachedContainer>::iterator it = m_ContainerCache.begin(); it != m_ContainerCache.end(); ) {
+        if (now - it->second.time > UPNP_CONTAINER_CACHE_TIME) {
+            m_ContainerCache.erase(it++);
+            continue;
+        }
+        if (oldest == m_ContainerCache.end() || it->second.time < oldest->second.time)
+            oldest = it;
+        ++it;
+    }
+    if (m_ContainerCache.size() >= UPNP_CONTAINER_CACHE_SIZE && oldest != m_ContainerCache.end() && oldest->first != key)
+        m_ContainerCache.erase(oldest);
+
+    CachedContainer& entry = m_ContainerCache[key];
+    entry = container;
+    entry.time = now;
 }
 
 /*----------------------------------------------------------------------
@@ -1134,14 +1317,29 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
         requested_count);
 
     // won't return more than UPNP_MAX_RETURNED_ITEMS items at a time to keep things smooth
-    // 0 requested means as many as possible
-    NPT_UInt32 max_count  = (requested_count == 0)?m_MaxReturnedItems:min((unsigned long)requested_count, (unsigned long)m_MaxReturnedItems);
+    NPT_UInt32 max_count  = GetMaxCount(requested_count);
     NPT_UInt32 stop_index = min((unsigned long)(starting_index + max_count), (unsigned long)items.Size()); // don't return more than we can
 
+    return BuildPage(action, items, starting_index, stop_index, items.Size(), filter, context, parent_id);
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::BuildPage
++---------------------------------------------------------------------*/
+NPT_Result
+CUPnPServer::BuildPage(PLT_ActionReference&          action,
+                       CFileItemList&                items,
+                       NPT_UInt32                    first,
+                       NPT_UInt32                    last,
+                       NPT_UInt32                    total_matches,
+                       const char*                   filter,
+                       const PLT_HttpRequestContext& context,
+                       const char*                   parent_id)
+{
     NPT_Cardinal count = 0;
     NPT_String didl = didl_header;
     PLT_MediaObjectReference object;
-    for (unsigned long i=starting_index; i<stop_index; ++i) {
+    for (unsigned long i=first; i<last; ++i) {
         object = Build(items[i], true, context, parent_id);
         if (object.IsNull()) {
             continue;
@@ -1162,11 +1360,11 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
 
     CLog::Log(LOGDEBUG, "Returning UPnP response with %d items out of %d total matches",
         count,
-        items.Size());
+        total_matches);
 
     NPT_CHECK(action->SetArgumentValue("Result", didl));
     NPT_CHECK(action->SetArgumentValue("NumberReturned", NPT_String::FromInteger(count)));
-    NPT_CHECK(action->SetArgumentValue("TotalMatches", NPT_String::FromInteger(items.Size())));
+    NPT_CHECK(action->SetArgumentValue("TotalMatches", NPT_String::FromInteger(total_matches)));
     NPT_CHECK(action->SetArgumentValue("UpdateId", "0"));
     return NPT_SUCCESS;
 }
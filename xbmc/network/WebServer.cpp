@@ -23,15 +23,18 @@
 #ifdef HAS_WEB_SERVER
 #include "interfaces/http-api/HttpApi.h"
 #include "interfaces/json-rpc/JSONRPC.h"
+#include "interfaces/json-rpc/JSONResponseWriter.h"
 #include "filesystem/File.h"
 #include "filesystem/Directory.h"
 #include "URL.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
+#include "utils/HttpRangeUtils.h"
 #include "utils/Variant.h"
 #include "threads/SingleLock.h"
 #include "XBDateTime.h"
 #include "addons/AddonManager.h"
+#include "filesystem/SpecialProtocol.h"
 
 #ifdef _WIN32
 #pragma comment(lib, "libmicrohttpd.dll.lib")
@@ -43,6 +46,22 @@
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
 #define DEFAULT_PAGE        "index.html"
 
+// buffer size for file downloads that are read through the VFS
+#define FILE_READ_BLOCK 32768
+
+// responses from a file descriptor are sent with sendfile() where available
+#if !defined(_WIN32) && (MHD_VERSION >= 0x00091600)
+#define HAS_FILE_DESCRIPTOR_RESPONSE
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef MHD_SIZE_UNKNOWN
+#define JSONRPC_RESPONSE_SIZE MHD_SIZE_UNKNOWN
+#else
+#define JSONRPC_RESPONSE_SIZE -1
+#endif
+
 using namespace ADDON;
 using namespace XFILE;
 using namespace std;
@@ -253,9 +272,19 @@ int CWebServer::JSONRPC(CWebServer *server, void **con_cls, struct MHD_Connectio
     CStdString *jsoncall = (CStdString *)(*con_cls);
 
     CHTTPClient client;
-    CStdString jsonresponse = CJSONRPC::MethodCall(*jsoncall, server, &client);
+    CJSONResponseWriter *writer = CJSONRPC::StreamMethodCall(*jsoncall, server, &client);
 
-    struct MHD_Response *response = MHD_create_response_from_data(jsonresponse.length(), (void *) jsonresponse.c_str(), MHD_NO, MHD_YES);
+    // the response is generated while it's sent, as chunks if the client supports it
+    struct MHD_Response *response;
+    if (writer->IsEmpty())
+    {
+      delete writer;
+      response = MHD_create_response_from_data(0, NULL, MHD_NO, MHD_NO);
+    }
+    else
+      response = MHD_create_response_from_callback(JSONRPC_RESPONSE_SIZE, JSONRPC_RESPONSE_CHUNK,
+                                                   &CWebServer::JSONRPCReaderCallback, writer,
+                                                   &CWebServer::JSONRPCReaderFreeCallback);
     int ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
     MHD_add_response_header(response, "Content-Type", "application/json");
     MHD_destroy_response(response);
@@ -297,47 +326,154 @@ int CWebServer::CreateRedirect(struct MHD_Connection *connection, const CStdStri
 
 int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, const CStdString &strURL, HTTPMethod methodType)
 {
-  int ret = MHD_NO;
   CFile *file = new CFile();
 
-  if (file->Open(strURL, READ_NO_CACHE))
+  // network files are read ahead by the file cache, so seeks and round trips don't stall the transfer
+  if (!file->Open(strURL, URIUtils::IsRemote(strURL) ? READ_CACHED : READ_NO_CACHE))
   {
-    struct MHD_Response *response;
-    if (methodType != HEAD)
-    {
-      response = MHD_create_response_from_callback ( file->GetLength(),
-                                                     2048,
-                                                     &CWebServer::ContentReaderCallback, file,
-                                                     &CWebServer::ContentReaderFreeCallback); 
-    } else {
-      file->Close();
-      delete file;
-      response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
-    }
+    delete file;
+    CLog::Log(LOGERROR, "WebServer: Failed to open %s", strURL.c_str());
+    return CreateErrorResponse(connection, MHD_HTTP_NOT_FOUND, GET); /* GET Assumed Temporarily */
+  }
 
-    CStdString ext = URIUtils::GetExtension(strURL);
-    ext = ext.ToLower();
-    const char *mime = CreateMimeTypeFromExtension(ext.c_str());
-    if (mime)
-      MHD_add_response_header(response, "Content-Type", mime);
+  int64_t fileLength = file->GetLength();
+  CStdString etag;
+  time_t lastModified = 0;
+  struct __stat64 statBuffer;
+  if (file->Stat(&statBuffer) == 0 && statBuffer.st_mtime > 0)
+  {
+    lastModified = (time_t)statBuffer.st_mtime;
+    etag.Format("\"%llx-%llx\"", (unsigned long long)fileLength, (unsigned long long)statBuffer.st_mtime);
+  }
 
-    CDateTime expiryTime = CDateTime::GetCurrentDateTime();
-    expiryTime += CDateTimeSpan(1, 0, 0, 0);
-    MHD_add_response_header(response, "Expires", expiryTime.GetAsRFC1123DateTime());
+  int status = MHD_HTTP_OK;
+  int64_t first = 0, last = fileLength - 1;
+  CStdString contentRange;
+  struct MHD_Response *response = NULL;
 
-    ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
+  if (IsNotModified(connection, etag, lastModified))
+    status = MHD_HTTP_NOT_MODIFIED;
+  else
+  {
+    const char *range   = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_RANGE);
+    const char *ifRange = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_RANGE);
+    switch (HttpRangeUtils::GetRequestedRange(range, ifRange, fileLength, etag, lastModified, first, last))
+    {
+    case HttpRangeUtils::RangeValid:
+      status = MHD_HTTP_PARTIAL_CONTENT;
+      contentRange.Format("bytes %"PRId64"-%"PRId64"/%"PRId64, first, last, fileLength);
+      break;
+    case HttpRangeUtils::RangeUnsatisfiable:
+      status = MHD_HTTP_REQUESTED_RANGE_NOT_SATISFIABLE;
+      contentRange.Format("bytes */%"PRId64, fileLength);
+      break;
+    default:
+      break;
+    }
+  }
 
-    MHD_destroy_response(response);
+  if (methodType != HEAD && (status == MHD_HTTP_OK || status == MHD_HTTP_PARTIAL_CONTENT))
+  {
+    response = CreateLocalFileResponse(strURL, first, last - first + 1);
+    if (!response)
+    {
+      FileReader *reader = new FileReader;
+      reader->file   = file;
+      reader->offset = first;
+      file = NULL;
+      response = MHD_create_response_from_callback(last - first + 1,
+                                                   FILE_READ_BLOCK,
+                                                   &CWebServer::ContentReaderCallback, reader,
+                                                   &CWebServer::ContentReaderFreeCallback);
+    }
   }
   else
+    response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
+
+  if (file)
   {
+    file->Close();
     delete file;
-    CLog::Log(LOGERROR, "WebServer: Failed to open %s", strURL.c_str());
-    return CreateErrorResponse(connection, MHD_HTTP_NOT_FOUND, GET); /* GET Assumed Temporarily */
   }
+
+  if (!response)
+    return MHD_NO;
+
+  CStdString ext = URIUtils::GetExtension(strURL);
+  ext = ext.ToLower();
+  const char *mime = CreateMimeTypeFromExtension(ext.c_str());
+  if (mime && status != MHD_HTTP_NOT_MODIFIED)
+    MHD_add_response_header(response, "Content-Type", mime);
+
+  MHD_add_response_header(response, MHD_HTTP_HEADER_ACCEPT_RANGES, "bytes");
+  if (!contentRange.IsEmpty())
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_RANGE, contentRange.c_str());
+  if (!etag.IsEmpty())
+    MHD_add_response_header(response, MHD_HTTP_HEADER_ETAG, etag.c_str());
+  if (lastModified > 0)
+  {
+    CDateTime modified;
+    modified.SetFromUTCDateTime(lastModified);
+    MHD_add_response_header(response, MHD_HTTP_HEADER_LAST_MODIFIED, modified.GetAsRFC1123DateTime());
+  }
+
+  CDateTime expiryTime = CDateTime::GetCurrentDateTime();
+  expiryTime += CDateTimeSpan(1, 0, 0, 0);
+  MHD_add_response_header(response, "Expires", expiryTime.GetAsRFC1123DateTime());
+
+  int ret = MHD_queue_response(connection, status, response);
+  MHD_destroy_response(response);
   return ret;
 }
 
+struct MHD_Response *CWebServer::CreateLocalFileResponse(const CStdString &strURL, int64_t offset, int64_t length)
+{
+#ifdef HAS_FILE_DESCRIPTOR_RESPONSE
+  // files on local disks are handed to the kernel instead of being copied through the VFS,
+  // except for ranges that don't fit the size_t length, which a 32 bit build has
+  if ((int64_t)(size_t)length != length)
+    return NULL;
+
+  CStdString path = CSpecialProtocol::TranslatePath(strURL);
+  if (!URIUtils::IsHD(path) || URIUtils::IsInArchive(path))
+    return NULL;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || offset + length > (int64_t)st.st_size)
+  {
+    close(fd);
+    return NULL;
+  }
+
+  // the response owns the descriptor from here on
+  struct MHD_Response *response = MHD_create_response_from_fd_at_offset(length, fd, offset);
+  if (!response)
+    close(fd);
+  return response;
+#else
+  return NULL;
+#endif
+}
+
+bool CWebServer::IsNotModified(struct MHD_Connection *connection, const CStdString &etag, time_t lastModified)
+{
+  // If-None-Match takes precedence over If-Modified-Since
+  const char *noneMatch = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_NONE_MATCH);
+  if (noneMatch)
+    return !etag.IsEmpty() && (strcmp(noneMatch, "*") == 0 || strstr(noneMatch, etag.c_str()) != NULL);
+
+  const char *modifiedSince = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_MODIFIED_SINCE);
+  time_t since;
+  if (!modifiedSince || lastModified <= 0 || !HttpRangeUtils::ParseHTTPDate(modifiedSince, since))
+    return false;
+
+  return lastModified <= since;
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method)
 {
   int ret = MHD_NO;
@@ -401,10 +537,11 @@ int CWebServer::ContentReaderCallback(void *cls, uint64_t pos, char *buf, int ma
 int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
 #endif
 {
-  CFile *file = (CFile *)cls;
-  if((unsigned int)pos != file->GetPosition())
-    file->Seek(pos);
-  unsigned res = file->Read(buf, max);
+  FileReader *reader = (FileReader *)cls;
+  int64_t position = reader->offset + (int64_t)pos;
+  if (position != reader->file->GetPosition())
+    reader->file->Seek(position);
+  unsigned res = reader->file->Read(buf, max);
   if(res == 0)
     return -1;
   return res;
@@ -412,10 +549,31 @@ int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
 
 void CWebServer::ContentReaderFreeCallback(void *cls)
 {
-  CFile *file = (CFile *)cls;
-  file->Close();
+  FileReader *reader = (FileReader *)cls;
+  reader->file->Close();
 
-  delete file;
+  delete reader->file;
+  delete reader;
+}
+
+#if (MHD_VERSION >= 0x00090200)
+ssize_t CWebServer::JSONRPCReaderCallback(void *cls, uint64_t pos, char *buf, size_t max)
+#elif (MHD_VERSION >= 0x00040001)
+int CWebServer::JSONRPCReaderCallback(void *cls, uint64_t pos, char *buf, int max)
+#else   //libmicrohttpd < 0.4.0
+int CWebServer::JSONRPCReaderCallback(void *cls, size_t pos, char *buf, int max)
+#endif
+{
+  CJSONResponseWriter *writer = (CJSONResponseWriter *)cls;
+  unsigned int res = writer->Read(buf, max);
+  if (res == 0)
+    return -1;
+  return res;
+}
+
+void CWebServer::JSONRPCReaderFreeCallback(void *cls)
+{
+  delete (CJSONResponseWriter *)cls;
 }
 
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
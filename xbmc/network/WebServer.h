@@ -38,6 +38,9 @@
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
 
+class CDateTime;
+namespace XFILE { class CFile; }
+
 class CWebServer : public JSONRPC::ITransportLayer
 {
 public:
@@ -57,6 +60,13 @@ private:
     GET,
     HEAD
   };
+  /*! \brief Position of the response of a file download in the file */
+  struct FileReader
+  {
+    XFILE::CFile *file;
+    int64_t       offset;
+  };
+
   struct MHD_Daemon* StartMHD(unsigned int flags, int port);
   static int AskForAuthentication (struct MHD_Connection *connection);
   static bool IsAuthenticated (CWebServer *server, struct MHD_Connection *connection);
@@ -69,6 +79,15 @@ private:
   static int ContentReaderCallback (void *cls, size_t pos, char *buf, int max);
 #endif
 
+#if (MHD_VERSION >= 0x00090200)
+  static ssize_t JSONRPCReaderCallback (void *cls, uint64_t pos, char *buf, size_t max);
+#elif (MHD_VERSION >= 0x00040001)
+  static int JSONRPCReaderCallback (void *cls, uint64_t pos, char *buf, int max);
+#else
+  static int JSONRPCReaderCallback (void *cls, size_t pos, char *buf, int max);
+#endif
+  static void JSONRPCReaderFreeCallback (void *cls);
+
 #if (MHD_VERSION >= 0x00040001)
   static int JSONRPC(CWebServer *server, void **con_cls, struct MHD_Connection *connection, const char *upload_data, size_t *upload_data_size);
   static int AnswerToConnection (void *cls, struct MHD_Connection *connection,
@@ -87,6 +106,12 @@ private:
   static HTTPMethod GetMethod(const char *method);
   static int CreateRedirect(struct MHD_Connection *connection, const CStdString &strURL);
   static int CreateFileDownloadResponse(struct MHD_Connection *connection, const CStdString &strURL, HTTPMethod methodType);
+  static struct MHD_Response *CreateLocalFileResponse(const CStdString &strURL, int64_t offset, int64_t length);
+
+  /*! \brief Check the If-None-Match and If-Modified-Since headers of a request against a file
+   \return true if the client's copy is current and a 304 should be sent, false otherwise
+   */
+  static bool IsNotModified(struct MHD_Connection *connection, const CStdString &etag, time_t lastModified);
   static int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method);
   static int CreateMemoryDownloadResponse(struct MHD_Connection *connection, void *data, size_t size);
   static int CreateAddonsListResponse(struct MHD_Connection *connection);
@@ -215,6 +215,9 @@ void CAdvancedSettings::Initialize()
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoScannerIgnoreErrors = false;
 
+  m_bFileStateIndex = false;
+  m_bFileStateWatchLocal = false;
+
   m_iTuxBoxStreamtsPort = 31339;
   m_bTuxBoxAudioChannelSelection = false;
   m_bTuxBoxSubMenuSelection = false;
@@ -293,6 +296,7 @@ void CAdvancedSettings::Initialize()
   m_measureRefreshrate = false;
 
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  m_musicPrefetchSize = 1024 * 1024 * 32;
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
@@ -303,6 +307,7 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 0;
   m_guiDirtyRegionNoFlipTimeout = -1;
+  m_guiPrewarmFonts = true;
 }
 
 bool CAdvancedSettings::Load()
@@ -588,6 +593,13 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "ignoreerrors", m_bVideoScannerIgnoreErrors);
   }
 
+  pElement = pRootElement->FirstChildElement("filestateindex");
+  if (pElement)
+  {
+    XMLUtils::GetBoolean(pElement, "enabled", m_bFileStateIndex);
+    XMLUtils::GetBoolean(pElement, "watchlocalsources", m_bFileStateWatchLocal);
+  }
+
   // Backward-compatibility of ExternalPlayer config
   pElement = pRootElement->FirstChildElement("externalplayer");
   if (pElement)
@@ -625,6 +637,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    XMLUtils::GetUInt(pElement, "musicprefetchsize", m_musicPrefetchSize);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -976,6 +989,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetBoolean(pElement, "prewarmfonts",          m_guiPrewarmFonts);
   }
 
   // load in the GUISettings overrides:
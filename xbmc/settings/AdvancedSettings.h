@@ -222,6 +222,9 @@ class CAdvancedSettings
 
     bool m_bVideoScannerIgnoreErrors;
 
+    bool m_bFileStateIndex;
+    bool m_bFileStateWatchLocal;
+
     std::vector<CStdString> m_vecTokens; // cleaning strings tied to language
     //TuxBox
     int m_iTuxBoxStreamtsPort;
@@ -311,8 +314,10 @@ class CAdvancedSettings
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    bool m_guiPrewarmFonts;
 
     unsigned int m_cacheMemBufferSize;
+    unsigned int m_musicPrefetchSize; ///< bytes of the next music track read ahead into memory, 0 to disable
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
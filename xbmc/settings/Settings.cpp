@@ -42,6 +42,7 @@
 #include "dialogs/GUIDialogYesNo.h"
 #include "filesystem/Directory.h"
 #include "FileItem.h"
+#include "FileStateDatabase.h"
 #include "LangInfo.h"
 #include "guilib/LocalizeStrings.h"
 #include "utils/StringUtils.h"
@@ -1235,6 +1236,24 @@ bool CSettings::DeleteSource(const CStdString &strType, const CStdString strName
     }
   }
 
+  // drop the indexed listings of the source, they would never be used again
+  if (found && g_advancedSettings.m_bFileStateIndex)
+  {
+    vector<CStdString> paths;
+    if (URIUtils::IsMultiPath(strPath))
+      CMultiPathDirectory::GetPaths(strPath, paths);
+    else
+      paths.push_back(strPath);
+
+    CFileStateDatabase fileState;
+    if (fileState.Open())
+    {
+      for (unsigned int i = 0; i < paths.size(); i++)
+        fileState.InvalidatePath(paths[i], true);
+      fileState.Close();
+    }
+  }
+
   if (virtualSource)
     return found;
 
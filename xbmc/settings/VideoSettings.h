@@ -63,6 +63,8 @@ enum EINTERLACEMETHOD
   VS_INTERLACEMETHOD_DXVA_BOB = 17,
   VS_INTERLACEMETHOD_DXVA_BEST = 18,
   VS_INTERLACEMETHOD_DXVA_ANY = 19,
+
+  VS_INTERLACEMETHOD_DEINTERLACE_TEMPORAL_HALF = 20,
 };
 
 enum ESCALINGMETHOD
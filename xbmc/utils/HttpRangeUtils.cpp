@@ -0,0 +1,118 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "HttpRangeUtils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+HttpRangeUtils::RangeRequest HttpRangeUtils::GetRequestedRange(const char *range, const char *ifRange, int64_t fileLength, const CStdString &etag, time_t lastModified, int64_t &first, int64_t &last)
+{
+  if (!range || strncmp(range, "bytes=", 6) != 0 || fileLength <= 0)
+    return RangeNone;
+
+  // a range is only applied to the version of the file the client has
+  if (ifRange)
+  {
+    time_t date;
+    if (ifRange[0] == '"' || ifRange[0] == 'W')
+    {
+      if (etag.IsEmpty() || etag != ifRange)
+        return RangeNone;
+    }
+    else if (lastModified <= 0 || !ParseHTTPDate(ifRange, date) || lastModified != date)
+      return RangeNone;
+  }
+
+  // multiple ranges would need a multipart response, the whole file is sent instead
+  const char *spec = range + 6;
+  if (strchr(spec, ','))
+    return RangeNone;
+
+  char *end;
+  if (*spec == '-')
+  { // the last n bytes
+    int64_t suffix = strtoll(spec + 1, &end, 10);
+    if (end == spec + 1 || *end != '\0')
+      return RangeNone;
+    if (suffix <= 0)
+      return RangeUnsatisfiable;
+    first = suffix < fileLength ? fileLength - suffix : 0;
+    last  = fileLength - 1;
+    return RangeValid;
+  }
+
+  first = strtoll(spec, &end, 10);
+  if (end == spec || *end != '-')
+    return RangeNone;
+
+  const char *lastSpec = end + 1;
+  if (*lastSpec == '\0')
+    last = fileLength - 1;
+  else
+  {
+    last = strtoll(lastSpec, &end, 10);
+    if (*end != '\0' || last < first)
+      return RangeNone;
+    if (last >= fileLength)
+      last = fileLength - 1;
+  }
+
+  if (first >= fileLength)
+    return RangeUnsatisfiable;
+
+  return RangeValid;
+}
+
+bool HttpRangeUtils::ParseHTTPDate(const char *date, time_t &time)
+{
+  static const char *months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+  static const int monthDays[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+  // only the RFC 1123 format is accepted, which is what all current clients send
+  char month[4];
+  int day, year, hour, minute, second;
+  const char *comma = strchr(date, ',');
+  if (!comma || sscanf(comma + 1, " %d %3s %d %d:%d:%d GMT", &day, month, &year, &hour, &minute, &second) != 6)
+    return false;
+
+  int mon = 0;
+  while (mon < 12 && strcmp(month, months[mon]) != 0)
+    mon++;
+  if (mon == 12)
+    return false;
+
+  bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  if (year < 1970 || day < 1 || day > monthDays[mon] + (mon == 1 && leap ? 1 : 0) ||
+      hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60)
+    return false;
+
+  // days since the epoch, without going through the local time zone as mktime() would
+  int64_t days = 0;
+  for (int y = 1970; y < year; y++)
+    days += ((y % 4 == 0 && y % 100 != 0) || y % 400 == 0) ? 366 : 365;
+  for (int m = 0; m < mon; m++)
+    days += monthDays[m] + (m == 1 && leap ? 1 : 0);
+  days += day - 1;
+
+  time = (time_t)(((days * 24 + hour) * 60 + minute) * 60 + second);
+  return true;
+}
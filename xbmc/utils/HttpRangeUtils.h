@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include "StdString.h"
+
+/*! \brief Parsing of the conditional and range headers of HTTP requests for files */
+class HttpRangeUtils
+{
+public:
+  enum RangeRequest
+  {
+    RangeNone,          ///< no (usable) Range header, the whole file is sent
+    RangeValid,
+    RangeUnsatisfiable
+  };
+
+  /*! \brief Retrieve the single byte range requested by a Range header, honouring If-Range
+   \param range the value of the Range header, may be NULL
+   \param ifRange the value of the If-Range header, may be NULL
+   \param fileLength the length of the file
+   \param etag the entity tag of the file, empty if it has none
+   \param lastModified the modification time of the file, 0 if unknown
+   \param first [out] offset of the first byte to send
+   \param last [out] offset of the last byte to send
+   */
+  static RangeRequest GetRequestedRange(const char *range, const char *ifRange, int64_t fileLength, const CStdString &etag, time_t lastModified, int64_t &first, int64_t &last);
+
+  /*! \brief Parse an RFC 1123 date as sent in HTTP headers
+   \param date the date, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+   \param time [out] the date as UTC time
+   \return true if the date could be parsed, false otherwise
+   */
+  static bool ParseHTTPDate(const char *date, time_t &time);
+};
@@ -0,0 +1,102 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "JSONStreamWriter.h"
+
+using namespace std;
+
+CJSONStreamWriter::CJSONStreamWriter(bool compact)
+{
+#if YAJL_MAJOR == 2
+  m_gen = yajl_gen_alloc(NULL);
+  yajl_gen_config(m_gen, yajl_gen_beautify, compact ? 0 : 1);
+  yajl_gen_config(m_gen, yajl_gen_indent_string, "\t");
+#else
+  yajl_gen_config conf = { compact ? 0 : 1, "\t" };
+  m_gen = yajl_gen_alloc(&conf, NULL);
+#endif
+}
+
+CJSONStreamWriter::~CJSONStreamWriter()
+{
+  yajl_gen_free(m_gen);
+}
+
+bool CJSONStreamWriter::BeginObject()
+{
+  return yajl_gen_status_ok == yajl_gen_map_open(m_gen);
+}
+
+bool CJSONStreamWriter::EndObject()
+{
+  return yajl_gen_status_ok == yajl_gen_map_close(m_gen);
+}
+
+bool CJSONStreamWriter::BeginArray()
+{
+  return yajl_gen_status_ok == yajl_gen_array_open(m_gen);
+}
+
+bool CJSONStreamWriter::EndArray()
+{
+  return yajl_gen_status_ok == yajl_gen_array_close(m_gen);
+}
+
+bool CJSONStreamWriter::Key(const string &key)
+{
+#if YAJL_MAJOR == 2
+  return yajl_gen_status_ok == yajl_gen_string(m_gen, (const unsigned char*)key.c_str(), (size_t)key.length());
+#else
+  return yajl_gen_status_ok == yajl_gen_string(m_gen, (const unsigned char*)key.c_str(), key.length());
+#endif
+}
+
+bool CJSONStreamWriter::Value(const CVariant &value)
+{
+  return CJSONVariantWriter::InternalWrite(m_gen, value);
+}
+
+unsigned int CJSONStreamWriter::Pending() const
+{
+  const unsigned char *buffer;
+#if YAJL_MAJOR == 2
+  size_t length = 0;
+#else
+  unsigned int length = 0;
+#endif
+  yajl_gen_get_buf(m_gen, &buffer, &length);
+  return (unsigned int)length;
+}
+
+void CJSONStreamWriter::Take(string &output)
+{
+  const unsigned char *buffer;
+#if YAJL_MAJOR == 2
+  size_t length = 0;
+#else
+  unsigned int length = 0;
+#endif
+  yajl_gen_get_buf(m_gen, &buffer, &length);
+  output.append((const char *)buffer, length);
+
+  // only drops the generated text, the generator keeps its state
+  yajl_gen_clear(m_gen);
+}
@@ -0,0 +1,57 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "JSONVariantWriter.h"
+#include <string>
+
+/*! \brief Incremental JSON generator
+ Values are appended to a yajl generator as they are produced and the text
+ generated so far is taken out with Take(), so only the part that hasn't been
+ consumed yet is held in memory.  Objects and arrays may be opened and closed
+ explicitly, which allows writing containers whose elements don't all exist
+ at the same time.
+ */
+class CJSONStreamWriter
+{
+public:
+  CJSONStreamWriter(bool compact);
+  ~CJSONStreamWriter();
+
+  bool BeginObject();
+  bool EndObject();
+  bool BeginArray();
+  bool EndArray();
+  bool Key(const std::string &key);
+  bool Value(const CVariant &value);
+
+  /*! \brief Number of generated bytes that haven't been taken yet */
+  unsigned int Pending() const;
+
+  /*! \brief Append the generated bytes to the given string and drop them from the generator */
+  void Take(std::string &output);
+
+private:
+  CJSONStreamWriter(const CJSONStreamWriter&);
+  CJSONStreamWriter& operator=(const CJSONStreamWriter&);
+
+  yajl_gen m_gen;
+};
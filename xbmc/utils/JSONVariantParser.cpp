@@ -189,8 +189,9 @@ void CJSONVariantParser::PushObject(CVariant variant)
 {
   if (m_status == ParseObject)
   {
-    (*m_parse[m_parse.size() - 1])[m_key] = variant;
-    m_parse.push_back(&(*m_parse[m_parse.size() - 1])[m_key]);
+    CVariant &member = (*m_parse[m_parse.size() - 1])[m_key];
+    member.swap(variant);
+    m_parse.push_back(&member);
   }
   else if (m_status == ParseArray)
   {
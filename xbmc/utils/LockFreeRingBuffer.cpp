@@ -0,0 +1,183 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "LockFreeRingBuffer.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+// data must be complete before an index is published, and an index must be
+// read before the data it covers
+#if defined(_WIN32)
+#define RINGBUFFER_BARRIER() MemoryBarrier()
+#else
+#define RINGBUFFER_BARRIER() __sync_synchronize()
+#endif
+
+CLockFreeRingBuffer::CLockFreeRingBuffer()
+{
+  m_buffer = NULL;
+  m_size = 0;
+  m_readPtr = 0;
+  m_writePtr = 0;
+  m_readWaiting = false;
+  m_writeWaiting = false;
+}
+
+CLockFreeRingBuffer::~CLockFreeRingBuffer()
+{
+  Destroy();
+}
+
+bool CLockFreeRingBuffer::Create(unsigned int size)
+{
+  Destroy();
+  m_buffer = (char*)malloc(size + 1);
+  if (m_buffer != NULL)
+  {
+    m_size = size;
+    return true;
+  }
+  return false;
+}
+
+void CLockFreeRingBuffer::Destroy()
+{
+  if (m_buffer != NULL)
+  {
+    free(m_buffer);
+    m_buffer = NULL;
+  }
+  m_size = 0;
+  Clear();
+}
+
+void CLockFreeRingBuffer::Clear()
+{
+  m_readPtr = 0;
+  m_writePtr = 0;
+  m_readWaiting = false;
+  m_writeWaiting = false;
+  RINGBUFFER_BARRIER();
+}
+
+unsigned int CLockFreeRingBuffer::GetFill(long readPtr, long writePtr) const
+{
+  if (writePtr >= readPtr)
+    return writePtr - readPtr;
+  return m_size + 1 - (readPtr - writePtr);
+}
+
+unsigned int CLockFreeRingBuffer::getMaxReadSize() const
+{
+  long writePtr = m_writePtr;
+  RINGBUFFER_BARRIER();
+  return GetFill(m_readPtr, writePtr);
+}
+
+unsigned int CLockFreeRingBuffer::getMaxWriteSize() const
+{
+  long readPtr = m_readPtr;
+  RINGBUFFER_BARRIER();
+  return m_size - GetFill(readPtr, m_writePtr);
+}
+
+bool CLockFreeRingBuffer::ReadData(char *buf, unsigned int size)
+{
+  if (size > getMaxReadSize())
+    return false;
+
+  unsigned int readPtr = m_readPtr;
+  unsigned int chunk = std::min(size, m_size + 1 - readPtr);
+  memcpy(buf, m_buffer + readPtr, chunk);
+  if (chunk < size)
+    memcpy(buf + chunk, m_buffer, size - chunk);
+
+  readPtr += size;
+  if (readPtr > m_size)
+    readPtr -= m_size + 1;
+
+  // the copy must be done before the producer may overwrite the space
+  RINGBUFFER_BARRIER();
+  m_readPtr = readPtr;
+  RINGBUFFER_BARRIER();
+  if (m_writeWaiting)
+    m_writeEvent.Set();
+  return true;
+}
+
+bool CLockFreeRingBuffer::WriteData(const char *buf, unsigned int size)
+{
+  if (size > getMaxWriteSize())
+    return false;
+
+  unsigned int writePtr = m_writePtr;
+  unsigned int chunk = std::min(size, m_size + 1 - writePtr);
+  memcpy(m_buffer + writePtr, buf, chunk);
+  if (chunk < size)
+    memcpy(m_buffer, buf + chunk, size - chunk);
+
+  writePtr += size;
+  if (writePtr > m_size)
+    writePtr -= m_size + 1;
+
+  // the data must be visible before the consumer sees the new index
+  RINGBUFFER_BARRIER();
+  m_writePtr = writePtr;
+  RINGBUFFER_BARRIER();
+  if (m_readWaiting)
+    m_readEvent.Set();
+  return true;
+}
+
+bool CLockFreeRingBuffer::WaitForRead(unsigned int size, unsigned int timeoutMs)
+{
+  if (getMaxReadSize() >= size)
+    return true;
+  if (size > m_size)
+    return false;
+
+  // announce the wait before checking again, so a write in between can't be missed
+  m_readWaiting = true;
+  RINGBUFFER_BARRIER();
+  bool ready = getMaxReadSize() >= size;
+  while (!ready && m_readEvent.WaitMSec(timeoutMs))
+    ready = getMaxReadSize() >= size;
+  m_readWaiting = false;
+  return ready || getMaxReadSize() >= size;
+}
+
+bool CLockFreeRingBuffer::WaitForWrite(unsigned int size, unsigned int timeoutMs)
+{
+  if (getMaxWriteSize() >= size)
+    return true;
+  if (size > m_size)
+    return false;
+
+  m_writeWaiting = true;
+  RINGBUFFER_BARRIER();
+  bool ready = getMaxWriteSize() >= size;
+  while (!ready && m_writeEvent.WaitMSec(timeoutMs))
+    ready = getMaxWriteSize() >= size;
+  m_writeWaiting = false;
+  return ready || getMaxWriteSize() >= size;
+}
@@ -0,0 +1,92 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/Event.h"
+
+// keeps the indices of the producer and the consumer on separate cache lines
+#define RINGBUFFER_CACHE_LINE 64
+
+/*! \brief Single producer, single consumer ring buffer without locks
+ One thread writes and one other thread reads; each side only ever updates
+ its own index, so neither reads nor writes take a lock.  A side only blocks
+ in WaitForRead()/WaitForWrite(), i.e. when the buffer is actually empty or
+ full, and is woken by the other side as soon as data or space is available.
+ Reads and writes are all or nothing, as with CRingBuffer.
+
+ Create(), Destroy() and Clear() must not be called while the other side is
+ accessing the buffer.
+ */
+class CLockFreeRingBuffer
+{
+public:
+  CLockFreeRingBuffer();
+  ~CLockFreeRingBuffer();
+
+  bool Create(unsigned int size);
+  void Destroy();
+  void Clear();
+
+  /*! \brief Read data from the buffer (consumer side)
+   \return false if less than size bytes are available, true otherwise
+   */
+  bool ReadData(char *buf, unsigned int size);
+
+  /*! \brief Write data to the buffer (producer side)
+   \return false if less than size bytes of space are available, true otherwise
+   */
+  bool WriteData(const char *buf, unsigned int size);
+
+  /*! \brief Wait until at least size bytes can be read (consumer side)
+   \return true if the data is available, false on timeout
+   */
+  bool WaitForRead(unsigned int size, unsigned int timeoutMs);
+
+  /*! \brief Wait until at least size bytes can be written (producer side)
+   \return true if the space is available, false on timeout
+   */
+  bool WaitForWrite(unsigned int size, unsigned int timeoutMs);
+
+  unsigned int getSize() const { return m_size; }
+  unsigned int getMaxReadSize() const;
+  unsigned int getMaxWriteSize() const;
+
+private:
+  CLockFreeRingBuffer(const CLockFreeRingBuffer&);
+  CLockFreeRingBuffer& operator=(const CLockFreeRingBuffer&);
+
+  unsigned int GetFill(long readPtr, long writePtr) const;
+
+  char         *m_buffer;
+  unsigned int  m_size;      ///< capacity, one byte less than allocated to tell full from empty
+
+  // each side's index shares its line with the flag that side sets while it waits
+  char          m_pad0[RINGBUFFER_CACHE_LINE];
+  volatile long m_writePtr;  ///< only updated by the producer
+  volatile bool m_writeWaiting;
+  char          m_pad1[RINGBUFFER_CACHE_LINE];
+  volatile long m_readPtr;   ///< only updated by the consumer
+  volatile bool m_readWaiting;
+  char          m_pad2[RINGBUFFER_CACHE_LINE];
+
+  CEvent        m_readEvent;  ///< set by the producer when the consumer waits for data
+  CEvent        m_writeEvent; ///< set by the consumer when the producer waits for space
+};
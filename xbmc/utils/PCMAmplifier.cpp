@@ -21,11 +21,13 @@
 
 #include "PCMAmplifier.h"
 #include "settings/Settings.h"
+#include "utils/CPUInfo.h"
 
 #include <math.h>
 
 CPCMAmplifier::CPCMAmplifier() : m_nVolume(VOLUME_MAXIMUM), m_dFactor(0)
 {
+  m_scaleFunc = PCMKernels::GetScaleInt16(g_cpuInfo.GetCPUFeatures());
 }
 
 CPCMAmplifier::~CPCMAmplifier()
@@ -61,11 +63,5 @@ void CPCMAmplifier::DeAmplify(short *pcm, int nSamples)
     return;
   }
 
-  for (int nSample=0; nSample<nSamples; nSample++)
-  {
-    int nSampleValue = pcm[nSample]; // must be int. so that we can check over/under flow
-    nSampleValue = (int)((double)nSampleValue * m_dFactor);
-
-    pcm[nSample] = (short)nSampleValue;
-  }
+  m_scaleFunc((int16_t*)pcm, nSamples, m_dFactor);
 }
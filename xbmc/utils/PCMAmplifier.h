@@ -22,6 +22,8 @@
  *
  */
 
+#include "PCMKernels.h"
+
 class CPCMAmplifier {
 public:
   CPCMAmplifier();
@@ -36,6 +38,7 @@ public:
 protected:
   int m_nVolume;
   double m_dFactor;
+  PCMScaleInt16Func m_scaleFunc;
 
 };
 
@@ -0,0 +1,287 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#define __STDC_LIMIT_MACROS
+
+#include "PCMKernels.h"
+#include "CPUInfo.h"
+#include "MathUtils.h"
+
+#if defined(HAS_PCM_KERNELS_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(HAS_PCM_KERNELS_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifndef INT16_MAX
+#define INT16_MAX (32767)
+#define INT16_MIN (-32767-1)
+#endif
+
+void PCMKernels::RemapInt16_C(const PCMMixChannel *mix, unsigned int outChannels,
+                              const int16_t *in, unsigned int inChannels,
+                              int16_t *out, unsigned int frames)
+{
+  for (unsigned int i = 0; i < frames; ++i)
+  {
+    for (unsigned int ch = 0; ch < outChannels; ++ch)
+    {
+      const PCMMixChannel &m = mix[ch];
+
+      /* the output may have channels the input does not have */
+      if (m.taps == 0)
+      {
+        out[ch] = 0;
+        continue;
+      }
+
+      /* if it is a 1-1 map, we just copy the data to avoid rounding errors */
+      if (m.copy)
+      {
+        out[ch] = in[m.input[0]];
+        continue;
+      }
+
+      float value = 0;
+      for (int t = 0; t < m.taps; ++t)
+        value += (float)in[m.input[t]] * m.level[t];
+
+      //convert to signed int and clamp to 16 bit
+      int outvalue = MathUtils::round_int(value);
+      if (outvalue > INT16_MAX)
+        outvalue = INT16_MAX;
+      else if (outvalue < INT16_MIN)
+        outvalue = INT16_MIN;
+
+      out[ch] = outvalue;
+    }
+
+    in  += inChannels;
+    out += outChannels;
+  }
+}
+
+void PCMKernels::ScaleInt16_C(int16_t *pcm, int samples, double factor)
+{
+  for (int i = 0; i < samples; i++)
+  {
+    int value = pcm[i]; // must be int. so that we can check over/under flow
+    value = (int)((double)value * factor);
+
+    pcm[i] = (int16_t)value;
+  }
+}
+
+#if defined(HAS_PCM_KERNELS_SSE2)
+void PCMKernels::RemapInt16_SSE2(const PCMMixChannel *mix, unsigned int outChannels,
+                                 const int16_t *in, unsigned int inChannels,
+                                 int16_t *out, unsigned int frames)
+{
+  const __m128 half = _mm_set1_ps(0.5f);
+  unsigned int blocks = frames / 4;
+
+  for (unsigned int b = 0; b < blocks; ++b)
+  {
+    const int16_t *f0 = in;
+    const int16_t *f1 = f0 + inChannels;
+    const int16_t *f2 = f1 + inChannels;
+    const int16_t *f3 = f2 + inChannels;
+
+    for (unsigned int ch = 0; ch < outChannels; ++ch)
+    {
+      const PCMMixChannel &m = mix[ch];
+      int16_t *o = out + ch;
+
+      if (m.taps == 0)
+      {
+        o[0] = o[outChannels] = o[2 * outChannels] = o[3 * outChannels] = 0;
+        continue;
+      }
+
+      if (m.copy)
+      {
+        int idx = m.input[0];
+        o[0]               = f0[idx];
+        o[outChannels]     = f1[idx];
+        o[2 * outChannels] = f2[idx];
+        o[3 * outChannels] = f3[idx];
+        continue;
+      }
+
+      /* same operations in the same order as the C version, one frame per lane */
+      __m128 value = _mm_setzero_ps();
+      for (int t = 0; t < m.taps; ++t)
+      {
+        int idx = m.input[t];
+        __m128 sample = _mm_cvtepi32_ps(_mm_setr_epi32(f0[idx], f1[idx], f2[idx], f3[idx]));
+        value = _mm_add_ps(value, _mm_mul_ps(sample, _mm_set1_ps(m.level[t])));
+      }
+
+      /* round to nearest with halves up as MathUtils::round_int, i.e. floor(value + 0.5).
+         value + 0.5f would round in single precision, so take the floor first and
+         compare the (exact) fraction instead */
+      __m128i result = _mm_cvttps_epi32(value);
+      result = _mm_add_epi32(result, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(result), value)));
+      __m128  frac   = _mm_sub_ps(value, _mm_cvtepi32_ps(result));
+      result = _mm_sub_epi32(result, _mm_castps_si128(_mm_cmpge_ps(frac, half)));
+
+      /* clamp to 16 bit */
+      result = _mm_packs_epi32(result, result);
+
+      o[0]               = (int16_t)_mm_extract_epi16(result, 0);
+      o[outChannels]     = (int16_t)_mm_extract_epi16(result, 1);
+      o[2 * outChannels] = (int16_t)_mm_extract_epi16(result, 2);
+      o[3 * outChannels] = (int16_t)_mm_extract_epi16(result, 3);
+    }
+
+    in  += 4 * inChannels;
+    out += 4 * outChannels;
+  }
+
+  RemapInt16_C(mix, outChannels, in, inChannels, out, frames - blocks * 4);
+}
+
+void PCMKernels::ScaleInt16_SSE2(int16_t *pcm, int samples, double factor)
+{
+  const __m128d f = _mm_set1_pd(factor);
+  int blocks = samples / 8;
+
+  for (int b = 0; b < blocks; ++b)
+  {
+    __m128i s  = _mm_loadu_si128((const __m128i*)pcm);
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+
+    /* multiply in double precision and truncate, exactly as the C version */
+    __m128i lo0 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(lo), f));
+    __m128i lo1 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2))), f));
+    __m128i hi0 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(hi), f));
+    __m128i hi1 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2))), f));
+
+    /* the factor is below 1, so packing can't saturate */
+    s = _mm_packs_epi32(_mm_unpacklo_epi64(lo0, lo1), _mm_unpacklo_epi64(hi0, hi1));
+    _mm_storeu_si128((__m128i*)pcm, s);
+
+    pcm += 8;
+  }
+
+  ScaleInt16_C(pcm, samples - blocks * 8, factor);
+}
+#endif
+
+#if defined(HAS_PCM_KERNELS_NEON)
+void PCMKernels::RemapInt16_NEON(const PCMMixChannel *mix, unsigned int outChannels,
+                                 const int16_t *in, unsigned int inChannels,
+                                 int16_t *out, unsigned int frames)
+{
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  unsigned int blocks = frames / 4;
+  int32_t samples[4];
+  int16_t results[4];
+
+  for (unsigned int b = 0; b < blocks; ++b)
+  {
+    const int16_t *f0 = in;
+    const int16_t *f1 = f0 + inChannels;
+    const int16_t *f2 = f1 + inChannels;
+    const int16_t *f3 = f2 + inChannels;
+
+    for (unsigned int ch = 0; ch < outChannels; ++ch)
+    {
+      const PCMMixChannel &m = mix[ch];
+      int16_t *o = out + ch;
+
+      if (m.taps == 0)
+      {
+        o[0] = o[outChannels] = o[2 * outChannels] = o[3 * outChannels] = 0;
+        continue;
+      }
+
+      if (m.copy)
+      {
+        int idx = m.input[0];
+        o[0]               = f0[idx];
+        o[outChannels]     = f1[idx];
+        o[2 * outChannels] = f2[idx];
+        o[3 * outChannels] = f3[idx];
+        continue;
+      }
+
+      /* same operations in the same order as the C version, one frame per lane */
+      float32x4_t value = vdupq_n_f32(0.0f);
+      for (int t = 0; t < m.taps; ++t)
+      {
+        int idx = m.input[t];
+        samples[0] = f0[idx];
+        samples[1] = f1[idx];
+        samples[2] = f2[idx];
+        samples[3] = f3[idx];
+        float32x4_t sample = vcvtq_f32_s32(vld1q_s32(samples));
+        value = vaddq_f32(value, vmulq_f32(sample, vdupq_n_f32(m.level[t])));
+      }
+
+      /* round to nearest with halves up as MathUtils::round_int, i.e. floor(value + 0.5).
+         value + 0.5f would round in single precision, so take the floor first and
+         compare the (exact) fraction instead */
+      int32x4_t   result = vcvtq_s32_f32(value);
+      result = vaddq_s32(result, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(result), value)));
+      float32x4_t frac   = vsubq_f32(value, vcvtq_f32_s32(result));
+      result = vsubq_s32(result, vreinterpretq_s32_u32(vcgeq_f32(frac, half)));
+
+      /* clamp to 16 bit */
+      vst1_s16(results, vqmovn_s32(result));
+
+      o[0]               = results[0];
+      o[outChannels]     = results[1];
+      o[2 * outChannels] = results[2];
+      o[3 * outChannels] = results[3];
+    }
+
+    in  += 4 * inChannels;
+    out += 4 * outChannels;
+  }
+
+  RemapInt16_C(mix, outChannels, in, inChannels, out, frames - blocks * 4);
+}
+#endif
+
+PCMRemapInt16Func PCMKernels::GetRemapInt16(unsigned int cpuFeatures)
+{
+#if defined(HAS_PCM_KERNELS_SSE2)
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+    return RemapInt16_SSE2;
+#endif
+#if defined(HAS_PCM_KERNELS_NEON)
+  return RemapInt16_NEON;
+#else
+  return RemapInt16_C;
+#endif
+}
+
+PCMScaleInt16Func PCMKernels::GetScaleInt16(unsigned int cpuFeatures)
+{
+#if defined(HAS_PCM_KERNELS_SSE2)
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+    return ScaleInt16_SSE2;
+#endif
+  return ScaleInt16_C;
+}
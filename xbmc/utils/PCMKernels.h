@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+
+/*! \brief Sample processing loops of CPCMRemap and CPCMAmplifier
+ Each loop has a portable C version and, where the target supports it,
+ SSE2 and NEON versions that produce bit identical output.  The vector
+ versions process four frames (remap) or eight samples (scale) at a time and
+ hand the remainder to the C version.
+ */
+
+#define PCM_MIX_MAX_INPUTS 18
+
+/*! \brief The mix of one output channel */
+struct PCMMixChannel
+{
+  int   taps;                         ///< number of inputs mixed, 0 for silence
+  bool  copy;                         ///< the single input is copied unchanged
+  int   input[PCM_MIX_MAX_INPUTS];    ///< sample index of each input within a frame
+  float level[PCM_MIX_MAX_INPUTS];    ///< level of each input
+};
+
+/*! \brief Remap interleaved 16 bit frames
+ \param mix the mix of each output channel
+ \param outChannels number of output channels
+ \param in input frames
+ \param inChannels number of input channels
+ \param out output frames
+ \param frames number of frames to process
+ */
+typedef void (*PCMRemapInt16Func)(const PCMMixChannel *mix, unsigned int outChannels,
+                                  const int16_t *in, unsigned int inChannels,
+                                  int16_t *out, unsigned int frames);
+
+/*! \brief Scale 16 bit samples in place, truncating towards zero */
+typedef void (*PCMScaleInt16Func)(int16_t *pcm, int samples, double factor);
+
+namespace PCMKernels
+{
+  void RemapInt16_C(const PCMMixChannel *mix, unsigned int outChannels,
+                    const int16_t *in, unsigned int inChannels,
+                    int16_t *out, unsigned int frames);
+  void ScaleInt16_C(int16_t *pcm, int samples, double factor);
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#define HAS_PCM_KERNELS_SSE2
+  void RemapInt16_SSE2(const PCMMixChannel *mix, unsigned int outChannels,
+                       const int16_t *in, unsigned int inChannels,
+                       int16_t *out, unsigned int frames);
+  void ScaleInt16_SSE2(int16_t *pcm, int samples, double factor);
+#endif
+
+#if defined(__ARM_NEON__)
+#define HAS_PCM_KERNELS_NEON
+  void RemapInt16_NEON(const PCMMixChannel *mix, unsigned int outChannels,
+                       const int16_t *in, unsigned int inChannels,
+                       int16_t *out, unsigned int frames);
+#endif
+
+  /*! \brief Select the fastest loops for the given CPU
+   \param cpuFeatures the CPU_FEATURE_* flags of the CPU, see CCPUInfo
+   */
+  PCMRemapInt16Func GetRemapInt16(unsigned int cpuFeatures);
+  PCMScaleInt16Func GetScaleInt16(unsigned int cpuFeatures);
+}
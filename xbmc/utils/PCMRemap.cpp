@@ -26,9 +26,9 @@
 #include <stdio.h>
 #include <math.h>
 
-#include "MathUtils.h"
 #include "PCMRemap.h"
 #include "utils/log.h"
+#include "utils/CPUInfo.h"
 #include "settings/GUISettings.h"
 #ifdef _WIN32
 #include "../win32/PlatformDefs.h"
@@ -169,6 +169,8 @@ CPCMRemap::CPCMRemap() :
   m_inSampleSize(0),
   m_ignoreLayout(false)
 {
+  m_remapFunc = PCMKernels::GetRemapInt16(g_cpuInfo.GetCPUFeatures());
+  memset(m_mix, 0, sizeof(m_mix));
   Dispose();
 }
 
@@ -407,6 +409,10 @@ void CPCMRemap::BuildMap()
     }
     CLog::Log(LOGDEBUG, "CPCMRemap: %s = %s\n", PCMChannelStr(m_outMap[out_ch]).c_str(), s.c_str());
   }
+
+  /* flatten the map for the remap loop */
+  for(out_ch = 0; out_ch < m_outChannels; ++out_ch)
+    FlattenMapInfo(m_lookupMap[m_outMap[out_ch]], m_inSampleSize, m_mix[out_ch]);
 }
 
 void CPCMRemap::DumpMap(CStdString info, unsigned int channels, enum PCMChannels *channelMap)
@@ -495,57 +501,7 @@ void CPCMRemap::SetOutputFormat(unsigned int channels, enum PCMChannels *channel
 /* remap the supplied data into out, which must be pre-allocated */
 void CPCMRemap::Remap(void *data, void *out, unsigned int samples)
 {
-  unsigned int i, ch;
-  uint8_t      *insample, *outsample;
-  uint8_t      *src, *dst;
-
-  insample  = (uint8_t*)data;
-  outsample = (uint8_t*)out;
-
-  /*
-    the output may have channels the input does not have, so zero the data
-    to stop random data being sent to them.
-  */
-  memset(out, 0, samples * (m_inSampleSize * m_outChannels));
-  for(i = 0; i < samples; ++i)
-  {
-    for(ch = 0; ch < m_outChannels; ++ch)
-    {
-      struct PCMMapInfo *info;
-      float value = 0;
-
-      info = m_lookupMap[m_outMap[ch]];
-      if (info->channel == PCM_INVALID) continue;
-
-      /* if it is a 1-1 map, we just copy the data to avoid rounding errors */
-      if (info->copy)
-      {
-        src = insample  + info->in_offset;
-        dst = outsample + ch * m_inSampleSize;
-        *(int16_t*)dst = *(int16_t*)src;
-        continue;
-      }
-
-      for(; info->channel != PCM_INVALID; ++info)
-      {
-        src    = insample + info->in_offset;
-        value += (float)(*(int16_t*)src) * info->level;
-      }
-      dst = outsample + ch * m_inSampleSize;
-
-      //convert to signed int and clamp to 16 bit
-      int outvalue = MathUtils::round_int(value);
-      if (outvalue > INT16_MAX)
-        outvalue = INT16_MAX;
-      else if (outvalue < INT16_MIN)
-        outvalue = INT16_MIN;
-
-      *(int16_t*)dst = outvalue;
-    }
-
-    insample  += m_inStride;
-    outsample += m_outStride;
-  }
+  m_remapFunc(m_mix, m_outChannels, (const int16_t*)data, m_inChannels, (int16_t*)out, samples);
 }
 
 bool CPCMRemap::CanRemap()
@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <vector>
 #include "StdString.h"
+#include "PCMKernels.h"
 
 #define PCM_MAX_CH 18
 enum PCMChannels
@@ -103,6 +104,8 @@ protected:
   int                m_inStride, m_outStride;
   struct PCMMapInfo  m_lookupMap[PCM_MAX_CH + 1][PCM_MAX_CH + 1];
   int                m_counts[PCM_MAX_CH];
+  struct PCMMixChannel m_mix[PCM_MAX_CH];      //!< m_lookupMap flattened per output channel for the remap loop
+  PCMRemapInt16Func  m_remapFunc;
 
   struct PCMMapInfo* ResolveChannel(enum PCMChannels channel, float level, bool ifExists, std::vector<enum PCMChannels> path, struct PCMMapInfo *tablePtr);
   void               ResolveChannels(); //!< Partial BuildMap(), just enough to see which output channels are active
@@ -120,6 +123,23 @@ public:
   enum PCMChannels *SetInputFormat (unsigned int channels, enum PCMChannels *channelMap, unsigned int sampleSize);
   void SetOutputFormat(unsigned int channels, enum PCMChannels *channelMap, bool ignoreLayout = false);
   void Remap(void *data, void *out, unsigned int samples);
+
+  /*! \brief Flatten a PCM_INVALID terminated lookup list into the form the remap kernels use
+   \param info the lookup list of an output channel
+   \param inSampleSize the size in bytes of an input sample, in_offset is in bytes
+   \param mix the flattened output channel
+   */
+  static void FlattenMapInfo(const struct PCMMapInfo *info, unsigned int inSampleSize, struct PCMMixChannel &mix)
+  {
+    mix.taps = 0;
+    mix.copy = info->copy;
+    for(; info->channel != PCM_INVALID && mix.taps < PCM_MIX_MAX_INPUTS; ++info)
+    {
+      mix.input[mix.taps] = info->in_offset / inSampleSize;
+      mix.level[mix.taps] = info->level;
+      mix.taps++;
+    }
+  }
   bool CanRemap();
   int  InBytesToFrames (int bytes );
   int  FramesToOutBytes(int frames);
@@ -0,0 +1,154 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "StartupTasks.h"
+#include "JobManager.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+using namespace std;
+
+/*! \brief Wraps the job of a stage to record its span and signal its completion */
+class CStartupTasks::CStageJob : public CJob
+{
+public:
+  CStageJob(const CSpanPtr &span, CJob *job) : m_span(span), m_job(job) {}
+  virtual ~CStageJob() { delete m_job; }
+
+  virtual bool DoWork()
+  {
+    m_span->start = CStartupTasks::Get().Now();
+    m_span->result = m_job->DoWork();
+    m_span->end = CStartupTasks::Get().Now();
+    m_span->done.Set();
+    return m_span->result;
+  }
+
+  virtual const char *GetType() const { return "startup"; }
+
+private:
+  CSpanPtr m_span;
+  CJob    *m_job;
+};
+
+CStartupTasks::CSpan::CSpan(const string &stage, bool isBackground) : done(true)
+{
+  name = stage;
+  background = isBackground;
+  start = end = waited = 0;
+  result = false;
+}
+
+CStartupTasks::CStartupTasks()
+{
+  m_origin = XbmcThreads::SystemClockMillis();
+}
+
+CStartupTasks &CStartupTasks::Get()
+{
+  static CStartupTasks startupTasks;
+  return startupTasks;
+}
+
+unsigned int CStartupTasks::Now() const
+{
+  return XbmcThreads::SystemClockMillis() - m_origin;
+}
+
+void CStartupTasks::Run(const string &stage, CJob *job, bool background)
+{
+  CSpanPtr span = AddSpan(stage, background);
+  span->start = Now();
+  if (background)
+    CJobManager::GetInstance().AddJob(new CStageJob(span, job), NULL, CJob::PRIORITY_HIGH);
+  else
+  {
+    CStageJob stageJob(span, job);
+    stageJob.DoWork();
+  }
+}
+
+bool CStartupTasks::Wait(const string &stage)
+{
+  CSpanPtr span = FindSpan(stage);
+  if (!span)
+    return false;
+
+  unsigned int start = Now();
+  span->done.Wait();
+  span->waited = Now() - start;
+  return span->result;
+}
+
+void CStartupTasks::BeginSpan(const string &stage)
+{
+  CSpanPtr span = AddSpan(stage, false);
+  span->start = Now();
+}
+
+void CStartupTasks::EndSpan(const string &stage)
+{
+  CSpanPtr span = FindSpan(stage);
+  if (span)
+  {
+    span->end = Now();
+    span->done.Set();
+  }
+}
+
+void CStartupTasks::Dump()
+{
+  CSingleLock lock(m_critSection);
+  for (vector<CSpanPtr>::iterator it = m_spans.begin(); it != m_spans.end(); ++it)
+  {
+    CSpan &span = **it;
+    if (!span.done.WaitMSec(0))
+      CLog::Log(LOGNOTICE, "Startup: %-16s %6u ms - running%s", span.name.c_str(), span.start,
+                span.background ? " (background)" : "");
+    else
+      CLog::Log(LOGNOTICE, "Startup: %-16s %6u ms - %6u ms, took %5u ms%s, waited %u ms", span.name.c_str(),
+                span.start, span.end, span.end - span.start, span.background ? " (background)" : "", span.waited);
+  }
+  m_spans.clear();
+}
+
+CStartupTasks::CSpanPtr CStartupTasks::AddSpan(const string &stage, bool background)
+{
+  CSingleLock lock(m_critSection);
+  if (m_spans.empty())
+    m_origin = XbmcThreads::SystemClockMillis();
+  CSpanPtr span(new CSpan(stage, background));
+  m_spans.push_back(span);
+  return span;
+}
+
+CStartupTasks::CSpanPtr CStartupTasks::FindSpan(const string &stage) const
+{
+  CSingleLock lock(m_critSection);
+  // the latest span of a stage wins, as stages such as the skin are run again on reload
+  for (vector<CSpanPtr>::const_reverse_iterator it = m_spans.rbegin(); it != m_spans.rend(); ++it)
+  {
+    if ((*it)->name == stage)
+      return *it;
+  }
+  return CSpanPtr();
+}
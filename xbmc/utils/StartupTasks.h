@@ -0,0 +1,95 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/Job.h"
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+/*! \brief Runs independent stages of the startup concurrently and records their timing
+ A stage is either a job started with Run(), which runs on the job manager while
+ the calling thread carries on, or a section of the calling thread marked with
+ BeginSpan()/EndSpan().  Dependencies between stages are expressed by calling
+ Wait() before the code that needs the result of a stage.
+
+ Every stage is recorded as a span relative to the first stage, and the spans,
+ along with the time spent waiting on background stages, are written to the log
+ by Dump().
+ */
+class CStartupTasks
+{
+public:
+  static CStartupTasks &Get();
+
+  /*! \brief Run a stage on the job manager
+   \param stage name of the stage, used by Wait() and in the timings
+   \param job the work of the stage.  The job is deleted once it has finished.
+   \param background whether to run the job on the job manager.  If false the
+   job is run on the calling thread before Run() returns, for callers that hold
+   locks the job manager's workers may be waiting on.
+   */
+  void Run(const std::string &stage, CJob *job, bool background = true);
+
+  /*! \brief Wait for a stage started with Run() to finish
+   \param stage name of the stage
+   \return the result of the job's DoWork(), false if the stage is unknown
+   */
+  bool Wait(const std::string &stage);
+
+  /*! \brief Mark the start and end of a stage run on the calling thread */
+  void BeginSpan(const std::string &stage);
+  void EndSpan(const std::string &stage);
+
+  /*! \brief Write the recorded spans to the log and forget them */
+  void Dump();
+
+private:
+  CStartupTasks();
+
+  class CSpan
+  {
+  public:
+    CSpan(const std::string &stage, bool background);
+
+    std::string  name;
+    bool         background;
+    unsigned int start;
+    unsigned int end;
+    unsigned int waited;  ///< time the caller of Wait() spent blocked on the stage
+    bool         result;
+    CEvent       done;
+  };
+  typedef boost::shared_ptr<CSpan> CSpanPtr;
+
+  class CStageJob;
+
+  CSpanPtr AddSpan(const std::string &stage, bool background);
+  CSpanPtr FindSpan(const std::string &stage) const;
+  unsigned int Now() const;
+
+  std::vector<CSpanPtr> m_spans;
+  unsigned int          m_origin;
+  CCriticalSection      m_critSection;
+};
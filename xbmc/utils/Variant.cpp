@@ -20,14 +20,16 @@
  */
 #include "Variant.h"
 #include <string.h>
+#include <algorithm>
 
 using namespace std;
 
-CVariant CVariant::ConstNullVariant = CVariant::VariantTypeConstNull;
+CVariant CVariant::ConstNullVariant(CVariant::VariantTypeConstNull);
 
 CVariant::CVariant(VariantType type)
 {
   m_type = type;
+  m_shortLength = 0;
 
   switch (type)
   {
@@ -41,7 +43,7 @@ CVariant::CVariant(VariantType type)
       m_data.boolean = false;
       break;
     case VariantTypeString:
-      m_data.string = NULL;
+      m_data.shortString[0] = '\0';
       break;
     case VariantTypeDouble:
       m_data.dvalue = 0.0;
@@ -61,88 +63,139 @@ CVariant::CVariant(VariantType type)
 CVariant::CVariant(int integer)
 {
   m_type = VariantTypeInteger;
+  m_shortLength = 0;
   m_data.integer = integer;
 }
 
 CVariant::CVariant(int64_t integer)
 {
   m_type = VariantTypeInteger;
+  m_shortLength = 0;
   m_data.integer = integer;
 }
 
 CVariant::CVariant(unsigned int unsignedinteger)
 {
   m_type = VariantTypeUnsignedInteger;
+  m_shortLength = 0;
   m_data.unsignedinteger = unsignedinteger;
 }
 
 CVariant::CVariant(uint64_t unsignedinteger)
 {
   m_type = VariantTypeUnsignedInteger;
+  m_shortLength = 0;
   m_data.unsignedinteger = unsignedinteger;
 }
 
 CVariant::CVariant(double value)
 {
   m_type = VariantTypeDouble;
+  m_shortLength = 0;
   m_data.dvalue = value;
 }
 
 CVariant::CVariant(float value)
 {
   m_type = VariantTypeDouble;
+  m_shortLength = 0;
   m_data.dvalue = (double)value;
 }
 
 CVariant::CVariant(bool boolean)
 {
   m_type = VariantTypeBoolean;
+  m_shortLength = 0;
   m_data.boolean = boolean;
 }
 
 CVariant::CVariant(const char *str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str);
+  setString(str, strlen(str));
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str, length);
+  setString(str, length);
 }
 
 CVariant::CVariant(const string &str)
 {
-  m_type = VariantTypeString;
-  m_data.string = new string(str);
+  setString(str.c_str(), str.length());
 }
 
 CVariant::CVariant(const CVariant &variant)
 {
-  m_type = variant.m_type;
-  *this = variant;
+  m_shortLength = variant.m_shortLength;
+
+  switch (variant.m_type)
+  {
+  case VariantTypeString:
+    m_type = VariantTypeString;
+    if (variant.m_shortLength == LongString)
+      m_data.string = new string(*variant.m_data.string);
+    else
+      m_data = variant.m_data;
+    break;
+  case VariantTypeArray:
+    m_type = VariantTypeArray;
+    m_data.array = new VariantArray(*variant.m_data.array);
+    break;
+  case VariantTypeObject:
+    m_type = VariantTypeObject;
+    m_data.map = new VariantMap(*variant.m_data.map);
+    break;
+  case VariantTypeConstNull:
+    // copies are regular values, only the shared null returned by failed lookups is immutable
+    m_type = VariantTypeNull;
+    memset(&m_data, 0, sizeof(m_data));
+    break;
+  default:
+    m_type = variant.m_type;
+    m_data = variant.m_data;
+    break;
+  }
 }
 
 CVariant::~CVariant()
 {
-  if (m_type == VariantTypeString && m_data.string)
-  {
+  reset();
+}
+
+void CVariant::reset()
+{
+  if (m_type == VariantTypeString && m_shortLength == LongString)
     delete m_data.string;
-    m_data.string = NULL;
-  }
-  else if (m_type == VariantTypeArray && m_data.array)
-  {
+  else if (m_type == VariantTypeArray)
     delete m_data.array;
-    m_data.array = NULL;
+  else if (m_type == VariantTypeObject)
+    delete m_data.map;
+
+  m_type = VariantTypeNull;
+  m_shortLength = 0;
+  memset(&m_data, 0, sizeof(m_data));
+}
+
+void CVariant::setString(const char *str, size_t length)
+{
+  m_type = VariantTypeString;
+  if (length <= ShortStringLength)
+  {
+    m_shortLength = (unsigned char)length;
+    memcpy(m_data.shortString, str, length);
+    m_data.shortString[length] = '\0';
   }
-  else if (m_type == VariantTypeObject && m_data.map)
+  else
   {
-    delete m_data.map;
-    m_data.map = NULL;
+    m_shortLength = LongString;
+    m_data.string = new string(str, length);
   }
 }
 
+size_t CVariant::stringLength() const
+{
+  return m_shortLength == LongString ? m_data.string->length() : m_shortLength;
+}
 bool CVariant::isInteger() const
 {
   return m_type == VariantTypeInteger;
@@ -231,31 +284,19 @@ bool CVariant::asBoolean(bool fallback) const
 const char *CVariant::asString(const char *fallback) const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return c_str();
   else
     return fallback;
 }
 
-CVariant &CVariant::operator[](string key)
+CVariant &CVariant::operator[](const string &key)
 {
-  if (m_type == VariantTypeNull)
-  {
-    m_type = VariantTypeObject;
-    m_data.map = new VariantMap();
-  }
-
-  if (m_type == VariantTypeObject)
-    return (*m_data.map)[key];
-  else
-    return ConstNullVariant;
+  return member(key.c_str(), key.length());
 }
 
-const CVariant &CVariant::operator[](std::string key) const
+const CVariant &CVariant::operator[](const string &key) const
 {
-  if (m_type == VariantTypeObject)
-    return (*m_data.map)[key];
-  else
-    return ConstNullVariant;
+  return member(key.c_str(), key.length());
 }
 
 CVariant &CVariant::operator[](unsigned int position)
@@ -276,37 +317,12 @@ const CVariant &CVariant::operator[](unsigned int position) const
 
 CVariant &CVariant::operator=(const CVariant &rhs)
 {
-  if (m_type == VariantTypeConstNull)
+  if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
 
-  m_type = rhs.m_type;
-
-  switch (m_type)
-  {
-  case VariantTypeInteger:
-    m_data.integer = rhs.m_data.integer;
-    break;
-  case VariantTypeUnsignedInteger:
-    m_data.integer = rhs.m_data.unsignedinteger;
-    break;
-  case VariantTypeBoolean:
-    m_data.boolean = rhs.m_data.boolean;
-    break;
-  case VariantTypeDouble:
-    m_data.dvalue = rhs.m_data.dvalue;
-    break;
-  case VariantTypeString:
-    m_data.string = new string(rhs.m_data.string->c_str());
-    break;
-  case VariantTypeArray:
-    m_data.array = new VariantArray(rhs.m_data.array->begin(), rhs.m_data.array->end());
-    break;
-  case VariantTypeObject:
-    m_data.map = new VariantMap(rhs.m_data.map->begin(), rhs.m_data.map->end());
-    break;
-  default:
-    break;
-  }
+  // copy first, rhs may be part of this variant
+  CVariant copy(rhs);
+  swap(copy);
 
   return *this;
 }
@@ -330,7 +346,7 @@ bool CVariant::operator==(const CVariant &rhs) const
       return m_data.dvalue == rhs.m_data.dvalue;
       break;
     case VariantTypeString:
-      return (*m_data.string) == (*rhs.m_data.string);
+      return stringLength() == rhs.stringLength() && memcmp(c_str(), rhs.c_str(), stringLength()) == 0;
       break;
     case VariantTypeArray:
       return (*m_data.array) == (*rhs.m_data.array);
@@ -355,34 +371,136 @@ void CVariant::push_back(CVariant variant)
   }
 
   if (m_type == VariantTypeArray)
-    m_data.array->push_back(variant);
+  {
+    grow(*m_data.array);
+    m_data.array->push_back(CVariant());
+    m_data.array->back().swap(variant);
+  }
 }
 
 void CVariant::append(CVariant variant)
 {
-  push_back(variant);
+  push_back(CVariant());
+  if (m_type == VariantTypeArray)
+    m_data.array->back().swap(variant);
 }
 
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return m_shortLength == LongString ? m_data.string->c_str() : m_data.shortString;
   else
     return NULL;
 }
 
 void CVariant::swap(CVariant &rhs)
 {
-  VariantType  temp_type = m_type;
-  VariantUnion temp_data = m_data;
+  VariantType   temp_type   = m_type;
+  unsigned char temp_length = m_shortLength;
+  VariantUnion  temp_data   = m_data;
 
   m_type = rhs.m_type;
+  m_shortLength = rhs.m_shortLength;
   m_data = rhs.m_data;
 
   rhs.m_type = temp_type;
+  rhs.m_shortLength = temp_length;
   rhs.m_data = temp_data;
 }
 
+void CVariant::grow(VariantArray &array)
+{
+  if (array.size() < array.capacity())
+    return;
+
+  // a plain reallocation would deep copy every element
+  VariantArray grown;
+  grown.reserve(max((size_t)4, array.capacity() * 2));
+  grown.resize(array.size());
+  for (unsigned int i = 0; i < array.size(); i++)
+    grown[i].swap(array[i]);
+  array.swap(grown);
+}
+
+void CVariant::grow(VariantMap &map)
+{
+  if (map.size() < map.capacity())
+    return;
+
+  VariantMap grown;
+  grown.reserve(max((size_t)4, map.capacity() * 2));
+  grown.resize(map.size());
+  for (unsigned int i = 0; i < map.size(); i++)
+  {
+    grown[i].first.swap(map[i].first);
+    grown[i].second.swap(map[i].second);
+  }
+  map.swap(grown);
+}
+
+CVariant::VariantMap::iterator CVariant::find(const char *key, size_t length) const
+{
+  // binary search for the first member not ordered before key
+  VariantMap::iterator first = m_data.map->begin();
+  size_t count = m_data.map->size();
+  while (count > 0)
+  {
+    size_t step = count / 2;
+    VariantMap::iterator it = first + step;
+    const string &name = it->first;
+    int cmp = memcmp(name.c_str(), key, min(name.length(), length));
+    if (cmp < 0 || (cmp == 0 && name.length() < length))
+    {
+      first = it + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+  return first;
+}
+
+CVariant &CVariant::member(const char *key, size_t length)
+{
+  if (m_type == VariantTypeNull)
+  {
+    m_type = VariantTypeObject;
+    m_data.map = new VariantMap();
+  }
+
+  if (m_type != VariantTypeObject)
+    return ConstNullVariant;
+
+  VariantMap &map = *m_data.map;
+  VariantMap::iterator it = find(key, length);
+  if (it != map.end() && it->first.length() == length && memcmp(it->first.c_str(), key, length) == 0)
+    return it->second;
+
+  // insert by moving the members behind the new one up by one
+  size_t position = it - map.begin();
+  grow(map);
+  map.push_back(VariantMember());
+  for (size_t i = map.size() - 1; i > position; i--)
+  {
+    map[i].first.swap(map[i - 1].first);
+    map[i].second.swap(map[i - 1].second);
+  }
+  map[position].first.assign(key, length);
+  return map[position].second;
+}
+
+const CVariant &CVariant::member(const char *key, size_t length) const
+{
+  if (m_type != VariantTypeObject)
+    return ConstNullVariant;
+
+  VariantMap::iterator it = find(key, length);
+  if (it != m_data.map->end() && it->first.length() == length && memcmp(it->first.c_str(), key, length) == 0)
+    return it->second;
+
+  return ConstNullVariant;
+}
+
 CVariant::iterator_array CVariant::begin_array()
 {
   if (m_type == VariantTypeArray)
@@ -454,7 +572,7 @@ unsigned int CVariant::size() const
   else if (m_type == VariantTypeArray)
     return m_data.array->size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return stringLength();
   else
     return 0;
 }
@@ -477,7 +595,12 @@ void CVariant::clear()
     m_data.array->clear();
 }
 
-void CVariant::erase(std::string key)
+void CVariant::erase(const string &key)
+{
+  erase(key.c_str(), key.length());
+}
+
+void CVariant::erase(const char *key, size_t length)
 {
   if (m_type == VariantTypeNull)
   {
@@ -485,7 +608,19 @@ void CVariant::erase(std::string key)
     m_data.map = new VariantMap();
   }
   else if (m_type == VariantTypeObject)
-    m_data.map->erase(key);
+  {
+    VariantMap &map = *m_data.map;
+    VariantMap::iterator it = find(key, length);
+    if (it == map.end() || it->first.length() != length || memcmp(it->first.c_str(), key, length) != 0)
+      return;
+
+    for (size_t i = it - map.begin(); i + 1 < map.size(); i++)
+    {
+      map[i].first.swap(map[i + 1].first);
+      map[i].second.swap(map[i + 1].second);
+    }
+    map.pop_back();
+  }
 }
 
 void CVariant::erase(unsigned int position)
@@ -497,13 +632,23 @@ void CVariant::erase(unsigned int position)
   }
 
   if (m_type == VariantTypeArray && position < size())
-    m_data.array->erase(m_data.array->begin() + position);
+  {
+    VariantArray &array = *m_data.array;
+    for (size_t i = position; i + 1 < array.size(); i++)
+      array[i].swap(array[i + 1]);
+    array.pop_back();
+  }
+}
+
+bool CVariant::isMember(const string &key) const
+{
+  return isMember(key.c_str(), key.length());
 }
 
-bool CVariant::isMember(string key) const
+bool CVariant::isMember(const char *key, size_t length) const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->find(key) != m_data.map->end();
+    return &member(key, length) != &ConstNullVariant;
 
   return false;
 }
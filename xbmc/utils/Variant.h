@@ -22,8 +22,23 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <string.h>
 #include <stdint.h>
 
+/*!
+ \brief Dynamically typed value as used for JSON data
+
+ Strings of up to 15 characters are stored inline instead of on the heap.
+ Objects keep their members in a vector sorted by name, which is smaller
+ and faster to build and search than a std::map for the handful of members
+ a typical object has.  Iterating an object still visits the members
+ ordered by name.
+
+ Values are moved rather than copied wherever the variant owns both ends,
+ e.g. when an array or object grows, or by push_back()/append() of a
+ temporary.  References to the members of an object are invalidated when a
+ member is added to or removed from it, as they are for arrays.
+ */
 class CVariant
 {
 public:
@@ -73,11 +88,15 @@ public:
   double asDouble(double fallback = 0.0) const;
   float asFloat(float fallback = 0.0f) const;
 
-  CVariant &operator[](std::string key);
-  const CVariant &operator[](std::string key) const;
+  CVariant &operator[](const std::string &key);
+  const CVariant &operator[](const std::string &key) const;
   CVariant &operator[](unsigned int position);
   const CVariant &operator[](unsigned int position) const;
 
+  // string literals and character arrays are looked up without creating a std::string
+  template <size_t N> CVariant &operator[](const char (&key)[N]) { return member(key, strlen(key)); }
+  template <size_t N> const CVariant &operator[](const char (&key)[N]) const { return member(key, strlen(key)); }
+
   CVariant &operator=(const CVariant &rhs);
   bool operator==(const CVariant &rhs) const;
 
@@ -90,7 +109,8 @@ public:
 
 private:
   typedef std::vector<CVariant> VariantArray;
-  typedef std::map<std::string, CVariant> VariantMap;
+  typedef std::pair<std::string, CVariant> VariantMember;
+  typedef std::vector<VariantMember> VariantMap; ///< sorted by member name
 
 public:
   typedef VariantArray::iterator        iterator_array;
@@ -112,12 +132,30 @@ public:
   unsigned int size() const;
   bool empty() const;
   void clear();
-  void erase(std::string key);
+  void erase(const std::string &key);
   void erase(unsigned int position);
+  template <size_t N> void erase(const char (&key)[N]) { erase(key, strlen(key)); }
 
-  bool isMember(std::string key) const;
+  bool isMember(const std::string &key) const;
+  template <size_t N> bool isMember(const char (&key)[N]) const { return isMember(key, strlen(key)); }
 
 private:
+  CVariant &member(const char *key, size_t length);
+  const CVariant &member(const char *key, size_t length) const;
+  bool isMember(const char *key, size_t length) const;
+  void erase(const char *key, size_t length);
+  VariantMap::iterator find(const char *key, size_t length) const;
+
+  void setString(const char *str, size_t length);
+  size_t stringLength() const;
+  void reset();
+
+  static void grow(VariantArray &array);
+  static void grow(VariantMap &map);
+
+  // strings up to this length are stored in the variant itself
+  enum { ShortStringLength = 15, LongString = 0xff };
+
   union VariantUnion
   {
     int64_t integer;
@@ -127,9 +165,11 @@ private:
     std::string *string;
     VariantArray *array;
     VariantMap *map;
+    char shortString[ShortStringLength + 1];
   };
 
   VariantType m_type;
+  unsigned char m_shortLength; ///< length of an inline string, LongString if it's on the heap
   VariantUnion m_data;
 
   static CVariant ConstNullVariant;
@@ -0,0 +1,109 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/HttpRangeUtils.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  HttpRangeUtils::RangeRequest GetRange(const char *range, int64_t &first, int64_t &last, int64_t fileLength = 1000)
+  {
+    first = last = -1;
+    return HttpRangeUtils::GetRequestedRange(range, NULL, fileLength, "", 0, first, last);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestHttpRangeUtilsRange)
+{
+  int64_t first, last;
+
+  BOOST_CHECK(GetRange(NULL, first, last) == HttpRangeUtils::RangeNone);
+  BOOST_CHECK(GetRange("items=0-10", first, last) == HttpRangeUtils::RangeNone);
+  BOOST_CHECK(GetRange("bytes=0-10", first, last, 0) == HttpRangeUtils::RangeNone);
+
+  BOOST_CHECK(GetRange("bytes=0-99", first, last) == HttpRangeUtils::RangeValid);
+  BOOST_CHECK(first == 0 && last == 99);
+
+  // open ended, and past the end of the file
+  BOOST_CHECK(GetRange("bytes=500-", first, last) == HttpRangeUtils::RangeValid);
+  BOOST_CHECK(first == 500 && last == 999);
+  BOOST_CHECK(GetRange("bytes=900-2000", first, last) == HttpRangeUtils::RangeValid);
+  BOOST_CHECK(first == 900 && last == 999);
+
+  // the last n bytes, more than the file has is the whole file
+  BOOST_CHECK(GetRange("bytes=-100", first, last) == HttpRangeUtils::RangeValid);
+  BOOST_CHECK(first == 900 && last == 999);
+  BOOST_CHECK(GetRange("bytes=-5000", first, last) == HttpRangeUtils::RangeValid);
+  BOOST_CHECK(first == 0 && last == 999);
+  BOOST_CHECK(GetRange("bytes=-0", first, last) == HttpRangeUtils::RangeUnsatisfiable);
+
+  BOOST_CHECK(GetRange("bytes=1000-", first, last) == HttpRangeUtils::RangeUnsatisfiable);
+  BOOST_CHECK(GetRange("bytes=1000-1010", first, last) == HttpRangeUtils::RangeUnsatisfiable);
+
+  // malformed or multiple ranges are ignored
+  BOOST_CHECK(GetRange("bytes=10-5", first, last) == HttpRangeUtils::RangeNone);
+  BOOST_CHECK(GetRange("bytes=a-5", first, last) == HttpRangeUtils::RangeNone);
+  BOOST_CHECK(GetRange("bytes=5-a", first, last) == HttpRangeUtils::RangeNone);
+  BOOST_CHECK(GetRange("bytes=-", first, last) == HttpRangeUtils::RangeNone);
+  BOOST_CHECK(GetRange("bytes=0-1,5-6", first, last) == HttpRangeUtils::RangeNone);
+
+  // offsets beyond 4GB
+  BOOST_CHECK(GetRange("bytes=5000000000-", first, last, 6000000000LL) == HttpRangeUtils::RangeValid);
+  BOOST_CHECK(first == 5000000000LL && last == 5999999999LL);
+}
+
+BOOST_AUTO_TEST_CASE(TestHttpRangeUtilsIfRange)
+{
+  int64_t first, last;
+  const CStdString etag = "\"3e8-4e9c2f80\"";
+  const time_t modified = 784111777; // Sun, 06 Nov 1994 08:49:37 GMT
+
+  BOOST_CHECK(HttpRangeUtils::GetRequestedRange("bytes=0-9", "\"3e8-4e9c2f80\"", 1000, etag, modified, first, last) == HttpRangeUtils::RangeValid);
+  BOOST_CHECK(HttpRangeUtils::GetRequestedRange("bytes=0-9", "\"3e8-0\"", 1000, etag, modified, first, last) == HttpRangeUtils::RangeNone);
+  BOOST_CHECK(HttpRangeUtils::GetRequestedRange("bytes=0-9", "\"3e8-4e9c2f80\"", 1000, "", modified, first, last) == HttpRangeUtils::RangeNone);
+
+  BOOST_CHECK(HttpRangeUtils::GetRequestedRange("bytes=0-9", "Sun, 06 Nov 1994 08:49:37 GMT", 1000, etag, modified, first, last) == HttpRangeUtils::RangeValid);
+  BOOST_CHECK(HttpRangeUtils::GetRequestedRange("bytes=0-9", "Sun, 06 Nov 1994 08:49:38 GMT", 1000, etag, modified, first, last) == HttpRangeUtils::RangeNone);
+  BOOST_CHECK(HttpRangeUtils::GetRequestedRange("bytes=0-9", "Sun, 06 Nov 1994 08:49:37 GMT", 1000, etag, 0, first, last) == HttpRangeUtils::RangeNone);
+}
+
+BOOST_AUTO_TEST_CASE(TestHttpRangeUtilsDate)
+{
+  time_t time;
+
+  BOOST_CHECK(HttpRangeUtils::ParseHTTPDate("Sun, 06 Nov 1994 08:49:37 GMT", time));
+  BOOST_CHECK(time == 784111777);
+  BOOST_CHECK(HttpRangeUtils::ParseHTTPDate("Thu, 01 Jan 1970 00:00:00 GMT", time));
+  BOOST_CHECK(time == 0);
+  BOOST_CHECK(HttpRangeUtils::ParseHTTPDate("Tue, 29 Feb 2000 23:59:59 GMT", time));
+  BOOST_CHECK(time == 951868799);
+  BOOST_CHECK(HttpRangeUtils::ParseHTTPDate("Wed, 19 Oct 2011 12:00:00 GMT", time));
+  BOOST_CHECK(time == 1319025600);
+
+  // other formats, invalid dates and junk
+  BOOST_CHECK(!HttpRangeUtils::ParseHTTPDate("Sunday, 06-Nov-94 08:49:37 GMT", time));
+  BOOST_CHECK(!HttpRangeUtils::ParseHTTPDate("Sun Nov  6 08:49:37 1994", time));
+  BOOST_CHECK(!HttpRangeUtils::ParseHTTPDate("Mon, 29 Feb 1900 00:00:00 GMT", time));
+  BOOST_CHECK(!HttpRangeUtils::ParseHTTPDate("Sun, 06 Foo 1994 08:49:37 GMT", time));
+  BOOST_CHECK(!HttpRangeUtils::ParseHTTPDate("Sun, 06 Nov 1994 24:00:00 GMT", time));
+  BOOST_CHECK(!HttpRangeUtils::ParseHTTPDate("", time));
+}
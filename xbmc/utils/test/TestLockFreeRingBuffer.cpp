@@ -0,0 +1,157 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/LockFreeRingBuffer.h"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+namespace
+{
+  const unsigned int totalBytes = 16 * 1024 * 1024;
+
+  // the byte at a given stream position, so the consumer can verify order and content
+  inline char StreamByte(unsigned int pos) { return (char)((pos * 2654435761u) >> 24); }
+
+  class producer
+  {
+    CLockFreeRingBuffer& buffer;
+  public:
+    volatile bool& failed;
+
+    producer(CLockFreeRingBuffer& o, volatile bool& flag) : buffer(o), failed(flag) {}
+
+    void operator()()
+    {
+      std::vector<char> chunk(4096);
+      unsigned int pos = 0;
+      unsigned int size = 1;
+      while (pos < totalBytes && !failed)
+      {
+        // vary the chunk size to hit every wrap around position
+        size = size % 4093 + 7;
+        size = std::min(size, totalBytes - pos);
+        for (unsigned int i = 0; i < size; i++)
+          chunk[i] = StreamByte(pos + i);
+
+        if (!buffer.WaitForWrite(size, 5000) || !buffer.WriteData(&chunk[0], size))
+        {
+          failed = true;
+          return;
+        }
+        pos += size;
+      }
+    }
+  };
+
+  class consumer
+  {
+    CLockFreeRingBuffer& buffer;
+  public:
+    volatile bool& failed;
+    unsigned int received;
+
+    consumer(CLockFreeRingBuffer& o, volatile bool& flag) : buffer(o), failed(flag), received(0) {}
+
+    void operator()()
+    {
+      std::vector<char> chunk(4096);
+      unsigned int size = 1;
+      while (received < totalBytes && !failed)
+      {
+        size = size % 3001 + 13;
+        size = std::min(size, totalBytes - received);
+        if (!buffer.WaitForRead(size, 5000) || !buffer.ReadData(&chunk[0], size))
+        {
+          failed = true;
+          return;
+        }
+        for (unsigned int i = 0; i < size; i++)
+        {
+          if (chunk[i] != StreamByte(received + i))
+          {
+            failed = true;
+            return;
+          }
+        }
+        received += size;
+      }
+    }
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestLockFreeRingBufferFill)
+{
+  CLockFreeRingBuffer buffer;
+  BOOST_REQUIRE(buffer.Create(100));
+  BOOST_CHECK_EQUAL(buffer.getMaxReadSize(), 0u);
+  BOOST_CHECK_EQUAL(buffer.getMaxWriteSize(), 100u);
+
+  char data[100], out[100];
+  for (unsigned int i = 0; i < sizeof(data); i++)
+    data[i] = (char)i;
+
+  // all or nothing, and full means full
+  BOOST_CHECK(!buffer.ReadData(out, 1));
+  BOOST_CHECK(buffer.WriteData(data, 60));
+  BOOST_CHECK(!buffer.WriteData(data, 41));
+  BOOST_CHECK(buffer.WriteData(data + 60, 40));
+  BOOST_CHECK_EQUAL(buffer.getMaxWriteSize(), 0u);
+  BOOST_CHECK_EQUAL(buffer.getMaxReadSize(), 100u);
+  BOOST_CHECK(!buffer.WaitForWrite(1, 10));
+
+  // wrap around
+  BOOST_CHECK(buffer.ReadData(out, 70));
+  BOOST_CHECK(buffer.WriteData(data, 50));
+  BOOST_CHECK(buffer.ReadData(out + 70, 30));
+  for (unsigned int i = 0; i < sizeof(data); i++)
+    BOOST_CHECK_EQUAL(out[i], data[i]);
+  BOOST_CHECK(buffer.ReadData(out, 50));
+  for (unsigned int i = 0; i < 50; i++)
+    BOOST_CHECK_EQUAL(out[i], data[i]);
+  BOOST_CHECK_EQUAL(buffer.getMaxReadSize(), 0u);
+
+  buffer.Clear();
+  BOOST_CHECK_EQUAL(buffer.getMaxWriteSize(), 100u);
+}
+
+BOOST_AUTO_TEST_CASE(TestLockFreeRingBufferStress)
+{
+  CLockFreeRingBuffer buffer;
+  // deliberately small so both sides have to wait frequently
+  BOOST_REQUIRE(buffer.Create(8191));
+
+  volatile bool failed = false;
+  producer p(buffer, failed);
+  consumer c(buffer, failed);
+
+  boost::thread consumerThread(boost::ref(c));
+  boost::thread producerThread(boost::ref(p));
+  producerThread.join();
+  consumerThread.join();
+
+  BOOST_CHECK(!failed);
+  BOOST_CHECK_EQUAL(c.received, totalBytes);
+  BOOST_CHECK_EQUAL(buffer.getMaxReadSize(), 0u);
+}
@@ -0,0 +1,264 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/PCMKernels.h"
+#include "utils/PCMRemap.h"
+#include "utils/MathUtils.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+  // sample values that exercise clamping and the rounding of halves
+  const int16_t edgeSamples[] = { 0, 1, -1, 3, -3, 32767, -32768, 32766, -32767, 16383, -16383 };
+
+  int16_t RandomSample(unsigned int i)
+  {
+    if (i % 7 == 0)
+      return edgeSamples[(i / 7) % (sizeof(edgeSamples) / sizeof(edgeSamples[0]))];
+    return (int16_t)(rand() % 65536 - 32768);
+  }
+
+  void FillSamples(std::vector<int16_t> &samples)
+  {
+    for (unsigned int i = 0; i < samples.size(); i++)
+      samples[i] = RandomSample(i);
+  }
+
+  struct PCMMapList
+  {
+    PCMMapInfo info[PCM_MAX_CH + 1];
+  };
+
+  // a downmix of all inputs into each output with random levels, as the
+  // PCM_INVALID terminated lookup lists CPCMRemap::BuildMap() produces
+  void BuildMapInfo(PCMMapList *lookup, unsigned int outChannels, unsigned int inChannels)
+  {
+    memset(lookup, 0, sizeof(PCMMapList) * outChannels);
+    for (unsigned int ch = 0; ch < outChannels; ch++)
+    {
+      PCMMapInfo *info = lookup[ch].info;
+      if (ch == 3 && outChannels > 3)
+      {
+        info->channel   = PCM_FRONT_LEFT;
+        info->in_offset = (inChannels - 1) * sizeof(int16_t);
+        info->level     = 1.0f;
+        info->copy      = true;
+        info++;
+      }
+      else if (ch != 2) // a silent output channel
+      {
+        for (unsigned int in = 0; in < inChannels; in++, info++)
+        {
+          info->channel   = PCM_FRONT_LEFT;
+          info->in_offset = ((in + ch) % inChannels) * sizeof(int16_t);
+          // halves are common in real maps, and produce .5 results to round
+          info->level     = (in % 3 == 0) ? 0.5f : (float)rand() / RAND_MAX;
+        }
+      }
+      info->channel = PCM_INVALID;
+    }
+  }
+
+  // the remap loop of CPCMRemap::Remap() before it was split into kernels
+  void RemapReference(PCMMapList *lookup, unsigned int outChannels, const int16_t *in, unsigned int inChannels, int16_t *out, unsigned int samples)
+  {
+    const unsigned int inSampleSize = sizeof(int16_t);
+    const unsigned int inStride     = inChannels  * inSampleSize;
+    const unsigned int outStride    = outChannels * inSampleSize;
+    const uint8_t *insample  = (const uint8_t*)in;
+    uint8_t       *outsample = (uint8_t*)out;
+
+    memset(out, 0, samples * (inSampleSize * outChannels));
+
+    while(samples--)
+    {
+      for(unsigned int ch = 0; ch < outChannels; ch++)
+      {
+        struct PCMMapInfo *info = lookup[ch].info;
+        if (info->channel == PCM_INVALID)
+          continue;
+
+        /* if it is a 1-1 map, we just copy the data to avoid rounding errors */
+        if (info->copy)
+        {
+          *(int16_t*)(outsample + ch * inSampleSize) = *(const int16_t*)(insample + info->in_offset);
+          continue;
+        }
+
+        float value = 0;
+        for(; info->channel != PCM_INVALID; ++info)
+          value += (float)(*(const int16_t*)(insample + info->in_offset)) * info->level;
+
+        //convert to signed int and clamp to 16 bit
+        int outvalue = MathUtils::round_int(value);
+        if (outvalue > INT16_MAX)
+          outvalue = INT16_MAX;
+        else if (outvalue < INT16_MIN)
+          outvalue = INT16_MIN;
+
+        *(int16_t*)(outsample + ch * inSampleSize) = outvalue;
+      }
+
+      insample  += inStride;
+      outsample += outStride;
+    }
+  }
+
+  void CheckRemap(PCMRemapInt16Func func, unsigned int inChannels, unsigned int outChannels, unsigned int frames)
+  {
+    std::vector<PCMMapList> lookup(outChannels);
+    BuildMapInfo(&lookup[0], outChannels, inChannels);
+
+    std::vector<PCMMixChannel> mix(outChannels);
+    for (unsigned int ch = 0; ch < outChannels; ch++)
+      CPCMRemap::FlattenMapInfo(lookup[ch].info, sizeof(int16_t), mix[ch]);
+
+    std::vector<int16_t> in(frames * inChannels);
+    FillSamples(in);
+
+    std::vector<int16_t> expected(frames * outChannels + 1, 0x5555);
+    std::vector<int16_t> result  (frames * outChannels + 1, 0x5555);
+    RemapReference(&lookup[0], outChannels, &in[0], inChannels, &expected[0], frames);
+    func(&mix[0], outChannels, &in[0], inChannels, &result[0], frames);
+
+    BOOST_CHECK(expected == result);
+  }
+
+  void CheckRemapLayouts(PCMRemapInt16Func func)
+  {
+    // 7.1 and 5.1 to stereo, 5.1 to 5.1, stereo to stereo, with odd frame counts
+    unsigned int layouts[][2] = { { 8, 2 }, { 6, 2 }, { 6, 6 }, { 8, 6 }, { 2, 2 }, { 1, 2 } };
+    unsigned int frames[] = { 0, 1, 3, 4, 5, 1023 };
+    for (unsigned int l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++)
+      for (unsigned int f = 0; f < sizeof(frames) / sizeof(frames[0]); f++)
+        CheckRemap(func, layouts[l][0], layouts[l][1], frames[f]);
+  }
+
+  // values just below a half, where rounding value + 0.5 in single precision goes wrong
+  void CheckRemapRounding(PCMRemapInt16Func func)
+  {
+    PCMMixChannel mix[1];
+    memset(mix, 0, sizeof(mix));
+    mix[0].taps = 1;
+    mix[0].input[0] = 0;
+
+    const float levels[] = { 0.49999997f, 0.5f, 0.50000006f, 1.49999988f, 1.5f, 0.16666667f };
+    int16_t in[] = { 1, -1, 3, -3, 1, -1, 3, -3, 7, -7, 1, 0 };
+    const unsigned int frames = sizeof(in) / sizeof(in[0]);
+    for (unsigned int l = 0; l < sizeof(levels) / sizeof(levels[0]); l++)
+    {
+      mix[0].level[0] = levels[l];
+      int16_t expected[frames], result[frames];
+      PCMKernels::RemapInt16_C(mix, 1, in, 1, expected, frames);
+      func(mix, 1, in, 1, result, frames);
+      for (unsigned int i = 0; i < frames; i++)
+        BOOST_CHECK_EQUAL(expected[i], result[i]);
+    }
+  }
+
+  void CheckScale(PCMScaleInt16Func func)
+  {
+    double factors[] = { 0.0, 0.001, 0.1, 0.5, 0.70794578438413791, 0.999 };
+    unsigned int counts[] = { 0, 1, 7, 8, 9, 4097 };
+    for (unsigned int f = 0; f < sizeof(factors) / sizeof(factors[0]); f++)
+    {
+      for (unsigned int c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+      {
+        std::vector<int16_t> expected(counts[c] + 1);
+        FillSamples(expected);
+        std::vector<int16_t> result(expected);
+
+        PCMKernels::ScaleInt16_C(&expected[0], counts[c], factors[f]);
+        func(&result[0], counts[c], factors[f]);
+
+        BOOST_CHECK(expected == result);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestPCMRemapC)
+{
+  // a 1-1 map copies, a silent output channel is zeroed
+  PCMMixChannel mix[2];
+  memset(mix, 0, sizeof(mix));
+  mix[0].taps = 1;
+  mix[0].copy = true;
+  mix[0].input[0] = 1;
+
+  int16_t in[]  = { 100, -200, 300, -400 };
+  int16_t out[] = { 1, 1, 1, 1 };
+  PCMKernels::RemapInt16_C(mix, 2, in, 2, out, 2);
+  BOOST_CHECK(out[0] == -200 && out[1] == 0 && out[2] == -400 && out[3] == 0);
+
+  // halves are rounded up, the sum is clamped
+  mix[0].copy  = false;
+  mix[0].taps  = 2;
+  mix[0].input[1] = 0;
+  mix[0].level[0] = 0.5f;
+  mix[0].level[1] = 1.0f;
+  int16_t in2[] = { 32000, 32000, -32000, -32000 };
+  PCMKernels::RemapInt16_C(mix, 2, in2, 2, out, 2);
+  BOOST_CHECK(out[0] == 32767 && out[2] == -32768);
+
+  int16_t in3[] = { 0, 3, 0, -3 };
+  PCMKernels::RemapInt16_C(mix, 2, in3, 2, out, 2);
+  BOOST_CHECK(out[0] == 2 && out[2] == -1);
+
+  // no double rounding just below a half
+  mix[0].taps  = 1;
+  mix[0].input[0] = 0;
+  mix[0].level[0] = 0.49999997f;
+  int16_t in4[] = { 1, 0, -1, 0 };
+  PCMKernels::RemapInt16_C(mix, 2, in4, 2, out, 2);
+  BOOST_CHECK(out[0] == 0 && out[2] == 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestPCMRemapReference)
+{
+  CheckRemapLayouts(PCMKernels::RemapInt16_C);
+}
+
+#if defined(HAS_PCM_KERNELS_SSE2)
+BOOST_AUTO_TEST_CASE(TestPCMRemapSSE2)
+{
+  CheckRemapLayouts(PCMKernels::RemapInt16_SSE2);
+  CheckRemapRounding(PCMKernels::RemapInt16_SSE2);
+}
+
+BOOST_AUTO_TEST_CASE(TestPCMScaleSSE2)
+{
+  CheckScale(PCMKernels::ScaleInt16_SSE2);
+}
+#endif
+
+#if defined(HAS_PCM_KERNELS_NEON)
+BOOST_AUTO_TEST_CASE(TestPCMRemapNEON)
+{
+  CheckRemapLayouts(PCMKernels::RemapInt16_NEON);
+  CheckRemapRounding(PCMKernels::RemapInt16_NEON);
+}
+#endif
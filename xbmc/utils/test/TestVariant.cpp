@@ -0,0 +1,123 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/Variant.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdio.h>
+#include <string>
+
+BOOST_AUTO_TEST_CASE(TestVariantStrings)
+{
+  // the longest string kept inline, the shortest one allocated and one with an embedded NUL
+  std::string shortString(15, 'a'), longString(16, 'b'), binary("ab\0cd", 5);
+  CVariant s(shortString), l(longString), b(binary.c_str(), binary.length());
+
+  BOOST_CHECK(s.asString() == shortString && s.size() == 15);
+  BOOST_CHECK(l.asString() == longString && l.size() == 16);
+  BOOST_CHECK(b.size() == 5 && std::string(b.c_str(), b.size()) == binary);
+  BOOST_CHECK(std::string(CVariant("").c_str()) == "");
+
+  CVariant copy(l);
+  BOOST_CHECK(copy == l && copy.c_str() != l.c_str());
+  copy = s;
+  BOOST_CHECK(copy == s && !(copy == l));
+  BOOST_CHECK(!(CVariant("abc") == CVariant("abd")));
+  BOOST_CHECK(!(CVariant("abc") == CVariant("ab")));
+
+  s.swap(l);
+  BOOST_CHECK(s.asString() == longString && l.asString() == shortString);
+}
+
+BOOST_AUTO_TEST_CASE(TestVariantObject)
+{
+  CVariant object(CVariant::VariantTypeObject);
+  const char *keys[] = { "label", "file", "type", "id", "thumbnail", "fanart", "artist", "album" };
+  const unsigned int count = sizeof(keys) / sizeof(keys[0]);
+  for (unsigned int i = 0; i < count; i++)
+    object[keys[i]] = (int)i;
+
+  BOOST_CHECK(object.size() == count);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    BOOST_CHECK(object.isMember(keys[i]));
+    BOOST_CHECK(object[std::string(keys[i])].asInteger() == i);
+  }
+
+  // members are iterated in key order
+  std::string previous;
+  for (CVariant::const_iterator_map it = object.begin_map(); it != object.end_map(); ++it)
+  {
+    BOOST_CHECK(previous < it->first);
+    previous = it->first;
+  }
+
+  object["id"] = "replaced";
+  BOOST_CHECK(object.size() == count && std::string(object["id"].asString()) == "replaced");
+
+  object.erase("type");
+  BOOST_CHECK(object.size() == count - 1 && !object.isMember("type") && object.isMember("thumbnail"));
+
+  // looking up a missing member of a const object must not insert it
+  const CVariant &constObject = object;
+  BOOST_CHECK(constObject["missing"].isNull());
+  BOOST_CHECK(!object.isMember("missing") && object.size() == count - 1);
+
+  CVariant copy = constObject["missing"];
+  copy = 5;
+  BOOST_CHECK(copy.asInteger() == 5 && constObject["missing"].isNull());
+
+  // a key that is a prefix of another one
+  object["i"] = true;
+  BOOST_CHECK(object["i"].asBoolean() && std::string(object["id"].asString()) == "replaced");
+}
+
+BOOST_AUTO_TEST_CASE(TestVariantGrowth)
+{
+  CVariant array(CVariant::VariantTypeArray);
+  CVariant object(CVariant::VariantTypeObject);
+  for (int i = 0; i < 1000; i++)
+  {
+    char key[32];
+    sprintf(key, "member with a long key %d", 999 - i);
+    CVariant item;
+    item["key"] = key;
+    item["index"] = i;
+    array.push_back(item);
+    object[std::string(key)] = item;
+  }
+
+  BOOST_CHECK(array.size() == 1000 && object.size() == 1000);
+  for (int i = 0; i < 1000; i++)
+  {
+    std::string key = array[i]["key"].asString();
+    BOOST_CHECK(array[i]["index"].asInteger() == i);
+    BOOST_CHECK(object[key]["index"].asInteger() == i);
+  }
+
+  array.erase(0);
+  BOOST_CHECK(array.size() == 999 && array[0]["index"].asInteger() == 1 && array[998]["index"].asInteger() == 999);
+
+  // assigning a member of the variant to the variant itself
+  array = array[0];
+  BOOST_CHECK(array.isObject() && array["index"].asInteger() == 1);
+}
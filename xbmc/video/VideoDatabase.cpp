@@ -5112,6 +5112,19 @@ bool CVideoDatabase::GetMusicVideosNav(const CStdString& strBaseDir, CFileItemLi
   return GetMusicVideosByWhere(strBaseDir, where, items);
 }
 
+bool CVideoDatabase::GetMoviesPage(const CStdString& strBaseDir, CFileItemList& items, unsigned int start, unsigned int count, bool descending)
+{
+  CStdString order = PrepareSQL("order by c%02d %s limit %u,%u", VIDEODB_ID_TITLE, descending ? "desc" : "asc", start, count);
+  return GetMoviesByWhere(strBaseDir, "", order, items);
+}
+
+bool CVideoDatabase::GetMusicVideosPage(const CStdString& strBaseDir, CFileItemList& items, unsigned int start, unsigned int count, bool descending)
+{
+  CStdString order = PrepareSQL("order by c%02d %s limit %u,%u", VIDEODB_ID_MUSICVIDEO_TITLE, descending ? "desc" : "asc", start, count);
+  // an empty page past the last music video isn't an error
+  return GetMusicVideosByWhere(strBaseDir, order, items) || start >= (unsigned int)GetMusicVideoCount("");
+}
+
 bool CVideoDatabase::GetRecentlyAddedMoviesNav(const CStdString& strBaseDir, CFileItemList& items, unsigned int limit)
 {
   CStdString order = PrepareSQL("order by idMovie desc limit %u", limit ? limit : g_advancedSettings.m_iVideoLibraryRecentlyAddedItems);
@@ -5274,6 +5287,31 @@ int CVideoDatabase::GetMusicVideoCount(const CStdString& strWhere)
   return 0;
 }
 
+int CVideoDatabase::GetMovieCount(const CStdString& strWhere)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return 0;
+    if (NULL == m_pDS.get()) return 0;
+
+    CStdString strSQL;
+    strSQL.Format("select count(1) as nummovies from movieview %s",strWhere.c_str());
+    m_pDS->query( strSQL.c_str() );
+
+    int iResult = 0;
+    if (!m_pDS->eof())
+      iResult = m_pDS->fv("nummovies").get_asInt();
+
+    m_pDS->close();
+    return iResult;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return 0;
+}
+
 ScraperPtr CVideoDatabase::GetScraperForPath( const CStdString& strPath )
 {
   SScanSettings settings;
@@ -543,6 +543,14 @@ public:
   bool GetRecentlyAddedEpisodesNav(const CStdString& strBaseDir, CFileItemList& items, unsigned int limit=0);
   bool GetRecentlyAddedMusicVideosNav(const CStdString& strBaseDir, CFileItemList& items, unsigned int limit=0);
 
+  /*! \brief Retrieve a page of all movies or music videos ordered by title
+   Movie sets are not expanded, so this only matches the title listing when they are flattened.
+   \param start index of the first item to retrieve
+   \param count maximum number of items to retrieve
+   */
+  bool GetMoviesPage(const CStdString& strBaseDir, CFileItemList& items, unsigned int start, unsigned int count, bool descending = false);
+  bool GetMusicVideosPage(const CStdString& strBaseDir, CFileItemList& items, unsigned int start, unsigned int count, bool descending = false);
+
   bool HasContent();
   bool HasContent(VIDEODB_CONTENT_TYPE type);
   bool HasSets() const;
@@ -585,6 +593,7 @@ public:
 
   // partymode
   int GetMusicVideoCount(const CStdString& strWhere);
+  int GetMovieCount(const CStdString& strWhere = "");
   unsigned int GetMusicVideoIDs(const CStdString& strWhere, std::vector<std::pair<int,int> > &songIDs);
   bool GetRandomMusicVideo(CFileItem* item, int& idSong, const CStdString& strWhere);
 
@@ -76,6 +76,10 @@ namespace VIDEO
 
       m_database.Open();
 
+      // a forced rescan must not trust indexed directory listings
+      if (g_advancedSettings.m_bFileStateIndex && !m_scanAll)
+        m_fileState.Open();
+
       if (m_pObserver)
         m_pObserver->OnStateChanged(PREPARING);
 
@@ -121,6 +125,7 @@ namespace VIDEO
       }
 
       m_database.Close();
+      m_fileState.Close();
 
       tick = XbmcThreads::SystemClockMillis() - tick;
       CLog::Log(LOGNOTICE, "VideoInfoScanner: Finished scan. Scanning for video info took %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
@@ -230,7 +235,7 @@ namespace VIDEO
       }
       if (!bSkip)
       { // need to fetch the folder
-        CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
+        m_fileState.GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
         items.Stack();
         // compute hash
         GetPathHash(items, hash);
@@ -266,7 +271,7 @@ namespace VIDEO
 
       if (foundDirectly && !settings.parent_name_root)
       {
-        CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
+        m_fileState.GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
         items.SetPath(strDirectory);
         GetPathHash(items, hash);
         bSkip = true;
@@ -628,7 +633,7 @@ namespace VIDEO
 
     if (item->m_bIsFolder)
     {
-      CUtil::GetRecursiveListing(item->GetPath(), items, g_settings.m_videoExtensions, true);
+      m_fileState.GetRecursiveListing(item->GetPath(), items, g_settings.m_videoExtensions, true);
       CStdString hash, dbHash;
       int numFilesInFolder = GetPathHash(items, hash);
 
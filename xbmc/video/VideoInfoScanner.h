@@ -21,6 +21,7 @@
  */
 #include "threads/Thread.h"
 #include "VideoDatabase.h"
+#include "FileStateDatabase.h"
 #include "addons/Scraper.h"
 #include "NfoFile.h"
 #include "VideoInfoDownloader.h"
@@ -250,6 +251,7 @@ namespace VIDEO
     bool m_scanAll;
     CStdString m_strStartDir;
     CVideoDatabase m_database;
+    CFileStateDatabase m_fileState;
     std::set<CStdString> m_pathsToScan;
     std::set<CStdString> m_pathsToCount;
     std::vector<int> m_pathsToClean;